@@ -0,0 +1,63 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   Bench.hpp                                          :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: raveriss <raveriss@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/17 09:12:40 by raveriss          #+#    #+#             */
+/*   Updated: 2026/10/17 09:12:40 by raveriss         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef BENCH_HPP
+#define BENCH_HPP
+
+/* For clock_gettime() */
+#include <ctime>
+
+/* For uint64_t */
+#include <stdint.h>
+
+/* For getrlimit(), setrlimit() */
+#include <sys/resource.h>
+
+/* For size_t */
+#include <cstddef>
+
+/**
+ * Outils partagés par les bancs d'essai de bench/. Chaque banc est un
+ * programme autonome, lié aux objets du serveur sauf main.o, construit et
+ * lancé par `make bench` ; il affiche un tableau par mesure.
+ */
+
+/* Puits des résultats calculés, pour que le travail mesuré ne soit pas éliminé */
+static volatile unsigned long benchSink;
+
+/* Retourne l'horloge monotone en nanosecondes */
+inline uint64_t benchNowNs()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<uint64_t>(now.tv_sec) * 1000000000ULL + static_cast<uint64_t>(now.tv_nsec);
+}
+
+/* Relève la limite de descripteurs vers `wanted`, dans la limite dure ; retourne la limite obtenue */
+inline size_t benchRaiseFdLimit(size_t wanted)
+{
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) != 0)
+        return 0;
+    rlim_t target = static_cast<rlim_t>(wanted);
+    if (limit.rlim_max != RLIM_INFINITY && target > limit.rlim_max)
+        target = limit.rlim_max;
+    if (target > limit.rlim_cur)
+    {
+        limit.rlim_cur = target;
+        if (setrlimit(RLIMIT_NOFILE, &limit) != 0)
+            getrlimit(RLIMIT_NOFILE, &limit);
+    }
+    return static_cast<size_t>(limit.rlim_cur);
+}
+
+#endif /* BENCH_HPP */
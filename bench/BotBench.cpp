@@ -0,0 +1,210 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   BotBench.cpp                                       :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: raveriss <raveriss@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/17 10:31:18 by raveriss          #+#    #+#             */
+/*   Updated: 2026/10/17 10:31:18 by raveriss         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "Bench.hpp"
+
+/* For Bot */
+#include "Bot.hpp"
+
+/* For Server */
+#include "Server.hpp"
+
+/* For ServerConfig */
+#include "ServerConfig.hpp"
+
+/* For Channel */
+#include "Channel.hpp"
+
+/* For Client */
+#include "Client.hpp"
+
+/* For IrcMessage */
+#include "IrcMessage.hpp"
+
+/* For std::string */
+#include <string>
+
+/* For std::set */
+#include <set>
+
+/* For std::vector */
+#include <vector>
+
+/* For std::cout */
+#include <iostream>
+
+/* For std::ofstream */
+#include <fstream>
+
+/* For std::setw */
+#include <iomanip>
+
+/* For isalnum(), tolower() */
+#include <cctype>
+
+/* For mkstemp() */
+#include <cstdlib>
+
+/* For close(), unlink() */
+#include <unistd.h>
+
+/* For strlen() */
+#include <cstring>
+
+/**
+ * Banc d'essai du filtre du bot : 100, 1 000 et 10 000 mots interdits,
+ * des lignes de discussion ordinaires qui n'en contiennent aucun (le cas de
+ * presque toutes les lignes). Chaque ligne passe par Bot::handleMessage(),
+ * puis par l'ancien filtre : un mot en minuscules construit par suite
+ * alphanumérique et cherché dans un std::set.
+ */
+
+/* Passages sur l'ensemble des lignes par mesure */
+#define PASSES 2000
+
+/* Lignes de discussion ordinaires */
+static const char *chatLines[] = {
+    "PRIVMSG #general :salut tout le monde, ca va ?",
+    "PRIVMSG #general :quelqu'un a vu le match hier soir ? quelle fin incroyable",
+    "PRIVMSG #general :je relance le build, la CI etait rouge a cause d'un test flaky",
+    "PRIVMSG #general :Hello! Anyone around to review PR 4821 before lunch?",
+    "PRIVMSG #general :ok merci, je regarde ca dans 10 minutes",
+    "PRIVMSG #general :lol",
+    "PRIVMSG #general :the deploy finished at 14:32, metrics look normal so far",
+    "PRIVMSG #general :qui vient au resto ce midi ? on part vers 12h15",
+    "PRIVMSG #general :+1",
+    "PRIVMSG #general :Est-ce que quelqu'un sait pourquoi le serveur de test redemarre toutes les nuits ?",
+    "PRIVMSG #general :I think it's the cron job from last week, let me check the logs",
+    "PRIVMSG #general :bonne soiree a tous, a demain !"
+};
+
+/* Générateur xorshift, reproductible d'une exécution à l'autre */
+static unsigned long nextRandom(unsigned long &state)
+{
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+/* Génère `count` mots de 5 à 9 lettres, préfixés pour ne croiser aucun mot des lignes */
+static std::vector<std::string> buildWords(size_t count)
+{
+    std::vector<std::string> words;
+    unsigned long state = 88172645463325252UL;
+    for (size_t i = 0; i < count; ++i)
+    {
+        std::string word("zq");
+        size_t length = 3 + nextRandom(state) % 5;
+        for (size_t c = 0; c < length; ++c)
+            word += static_cast<char>('a' + nextRandom(state) % 26);
+        words.push_back(word);
+    }
+    return words;
+}
+
+/* Ancien filtre : true si un paramètre contient un mot de `forbidden` */
+static bool oldMatches(const std::set<std::string> &forbidden, const IrcMessage &message)
+{
+    std::string word;
+    for (size_t p = 1; p < message.paramCount(); ++p)
+    {
+        IrcSlice text = message.param(p);
+        for (size_t i = 0; i <= text.length; ++i)
+        {
+            unsigned char c = i < text.length ? static_cast<unsigned char>(text.data[i]) : 0;
+            if (i < text.length && isalnum(c))
+            {
+                word += static_cast<char>(tolower(c));
+                continue;
+            }
+            if (!word.empty() && forbidden.find(word) != forbidden.end())
+                return true;
+            word.clear();
+        }
+    }
+    return false;
+}
+
+int main()
+{
+    static const size_t sizes[] = { 100, 1000, 10000 };
+    static const size_t lineCount = sizeof(chatLines) / sizeof(chatLines[0]);
+
+    /* Un serveur inerte : le bot l'utilise pour ses sanctions */
+    ServerConfig config;
+    Server server(0, "bench", config);
+    Channel channel("#general");
+    Client client(-1);
+
+    std::vector<IrcMessage> messages(lineCount);
+    size_t bytes = 0;
+    for (size_t i = 0; i < lineCount; ++i)
+    {
+        messages[i].parse(chatLines[i], strlen(chatLines[i]));
+        bytes += strlen(chatLines[i]);
+    }
+
+    std::cout << "== Filtre du bot, " << lineCount << " lignes ordinaires x " << PASSES << " passages" << std::endl;
+    std::cout << std::setw(8) << "mots" << std::setw(14) << "compil. ms"
+              << std::setw(14) << "std::set ns/l" << std::setw(14) << "automate ns/l" << std::setw(16) << "automate Mo/s" << std::endl;
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s)
+    {
+        std::vector<std::string> words = buildWords(sizes[s]);
+
+        char path[] = "/tmp/botbench.XXXXXX";
+        int fd = mkstemp(path);
+        if (fd < 0)
+            return 1;
+        close(fd);
+        std::ofstream file(path);
+        for (size_t i = 0; i < words.size(); ++i)
+            file << words[i] << "\n";
+        file.close();
+
+        Bot bot(server);
+        std::string error;
+        uint64_t start = benchNowNs();
+        bool loaded = bot.loadRules(path, error);
+        uint64_t compileNs = benchNowNs() - start;
+        unlink(path);
+        if (!loaded)
+        {
+            std::cerr << "Règles illisibles : " << error << std::endl;
+            return 1;
+        }
+
+        std::set<std::string> forbidden(words.begin(), words.end());
+        start = benchNowNs();
+        for (int pass = 0; pass < PASSES; ++pass)
+        {
+            for (size_t i = 0; i < lineCount; ++i)
+                benchSink += oldMatches(forbidden, messages[i]);
+        }
+        uint64_t oldNs = benchNowNs() - start;
+
+        start = benchNowNs();
+        for (int pass = 0; pass < PASSES; ++pass)
+        {
+            for (size_t i = 0; i < lineCount; ++i)
+                bot.handleMessage(&client, &channel, messages[i]);
+        }
+        uint64_t newNs = benchNowNs() - start;
+
+        double lines = static_cast<double>(PASSES) * lineCount;
+        std::cout << std::fixed << std::setprecision(1)
+                  << std::setw(8) << sizes[s] << std::setw(14) << compileNs / 1e6
+                  << std::setw(14) << oldNs / lines << std::setw(14) << newNs / lines
+                  << std::setw(16) << (static_cast<double>(bytes) * PASSES) / (newNs / 1e3) << std::endl;
+    }
+    return 0;
+}
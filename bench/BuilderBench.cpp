@@ -0,0 +1,202 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   BuilderBench.cpp                                   :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: raveriss <raveriss@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/18 08:52:33 by raveriss          #+#    #+#             */
+/*   Updated: 2026/10/18 08:52:33 by raveriss         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "Bench.hpp"
+
+/* For OldMessageBuilder */
+#include "OldMessageBuilder.hpp"
+
+/* For IrcMessageBuilder */
+#include "IrcMessageBuilder.hpp"
+
+/* For IrcReply */
+#include "IrcReply.hpp"
+
+/* For std::string */
+#include <string>
+
+/* For std::cout */
+#include <iostream>
+
+/* For std::setw */
+#include <iomanip>
+
+/* For malloc(), free() */
+#include <cstdlib>
+
+/* For std::bad_alloc */
+#include <new>
+
+/**
+ * Banc d'essai des constructeurs de réponses : chaque type de réponse qui
+ * existait avant IrcReply est construit par l'ancien constructeur
+ * (OldMessageBuilder, std::string) puis par IrcMessageBuilder (IrcReply),
+ * avec les mêmes paramètres (les anciens constructeurs ajoutaient eux-mêmes
+ * le ':' du préfixe, ceux de JOIN et PART le composaient). Les allocations sont comptées en remplaçant
+ * l'opérateur new du programme ; une ligne différente entre les deux est
+ * signalée par une étoile.
+ */
+
+/* Constructions mesurées par type et par constructeur */
+#define ROUNDS 20000
+
+/* Allocations faites par l'opérateur new depuis le début du programme */
+static unsigned long allocations;
+
+void *operator new(size_t size) throw(std::bad_alloc)
+{
+    ++allocations;
+    void *block = malloc(size ? size : 1);
+    if (block == NULL)
+        throw std::bad_alloc();
+    return block;
+}
+
+void operator delete(void *block) throw()
+{
+    free(block);
+}
+
+/* Totaux de tous les types */
+static uint64_t totalOldNs;
+static uint64_t totalNewNs;
+static unsigned long totalOldAllocations;
+static unsigned long totalNewAllocations;
+static size_t typeCount;
+
+/**
+ * Affiche la ligne d'un type de réponse et l'ajoute aux totaux
+ */
+static void report(const char *name, uint64_t oldNs, unsigned long oldAllocations, uint64_t newNs, unsigned long newAllocations,
+                   const std::string &oldLine, const IrcReply &newLine)
+{
+    bool same = oldLine == std::string(newLine.data(), newLine.size());
+    std::cout << std::left << std::setw(36) << name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(10) << static_cast<double>(oldNs) / ROUNDS
+              << std::setw(8) << static_cast<double>(oldAllocations) / ROUNDS
+              << std::setw(10) << static_cast<double>(newNs) / ROUNDS
+              << std::setw(8) << static_cast<double>(newAllocations) / ROUNDS
+              << (same ? "" : "  *") << std::endl;
+
+    totalOldNs += oldNs;
+    totalNewNs += newNs;
+    totalOldAllocations += oldAllocations;
+    totalNewAllocations += newAllocations;
+    ++typeCount;
+}
+
+/* Mesure un type de réponse : `args` est la liste d'arguments, parenthèses comprises */
+#define BENCH_REPLY(name, args) BENCH_REPLY_ARGS(name, args, args)
+
+/* Variante pour un constructeur dont les paramètres ont changé avec IrcReply */
+#define BENCH_REPLY_ARGS(name, oldArgs, newArgs) \
+    do \
+    { \
+        unsigned long allocationsBefore = allocations; \
+        uint64_t start = benchNowNs(); \
+        for (int round = 0; round < ROUNDS; ++round) \
+        { \
+            std::string line = OldMessageBuilder::name oldArgs; \
+            benchSink += line.size(); \
+        } \
+        uint64_t oldNs = benchNowNs() - start; \
+        unsigned long oldAllocations = allocations - allocationsBefore; \
+        allocationsBefore = allocations; \
+        start = benchNowNs(); \
+        for (int round = 0; round < ROUNDS; ++round) \
+        { \
+            IrcReply reply = IrcMessageBuilder::name newArgs; \
+            benchSink += reply.size(); \
+        } \
+        uint64_t newNs = benchNowNs() - start; \
+        unsigned long newAllocations = allocations - allocationsBefore; \
+        report(#name, oldNs, oldAllocations, newNs, newAllocations, OldMessageBuilder::name oldArgs, IrcMessageBuilder::name newArgs); \
+    } \
+    while (0)
+
+int main()
+{
+    const std::string server("irc.example.net");
+    const std::string nick("alice");
+    const std::string prefix(":alice!alice@203.0.113.7");
+    const std::string source("alice!alice@203.0.113.7");
+    const std::string channel("#general");
+    const std::string topic("Discussions generales, soyez courtois");
+    const std::string names("@alice bob +carol dave erin frank grace heidi ivan judy mallory oscar peggy trent victor walter");
+
+    std::cout << "== Constructeurs de réponses, " << ROUNDS << " constructions par type" << std::endl;
+    std::cout << std::left << std::setw(36) << "réponse" << std::right
+              << std::setw(10) << "ancien ns" << std::setw(8) << "alloc" << std::setw(10) << "actuel ns" << std::setw(8) << "alloc" << std::endl;
+
+    BENCH_REPLY(buildNeedMoreParamsError, (server, "JOIN"));
+    BENCH_REPLY(buildErrorMessage, (server, "421", "FOO :Unknown command"));
+    BENCH_REPLY(buildWelcomeMessage, (server, nick, "alice", "203.0.113.7"));
+    BENCH_REPLY(buildNoSuchChannelError, (server, channel));
+    BENCH_REPLY(buildChannelOperatorNeededError, (server, nick, channel));
+    BENCH_REPLY(buildUserNotInChannelError, (server, nick, channel));
+    BENCH_REPLY(buildUnknownModeError, (server, nick, 'q'));
+    BENCH_REPLY_ARGS(buildModeChangeMessage, (source, channel, "+o bob"), (prefix, channel, "+o bob"));
+    BENCH_REPLY(buildNotOnChannelError, (server, channel));
+    BENCH_REPLY(buildNoSuchNickError, (server, "bob"));
+    BENCH_REPLY(buildUserOnChannelError, (server, "bob", channel));
+    BENCH_REPLY_ARGS(buildInviteMessage, (source, "bob", channel), (prefix, "bob", channel));
+    BENCH_REPLY(buildInvitingReply, (server, nick, "bob", channel));
+    BENCH_REPLY(buildTopicReply, (server, nick, channel, topic));
+    BENCH_REPLY(buildNoTopicReply, (server, nick, channel));
+    BENCH_REPLY_ARGS(buildTopicMessage, (source, channel, topic), (prefix, channel, topic));
+    BENCH_REPLY_ARGS(buildKickMessage, (source, channel, "bob", "flooding"), (prefix, channel, "bob", "flooding"));
+    BENCH_REPLY(buildCapabilityListMessage, (server, nick, ""));
+    BENCH_REPLY(buildInvalidCapSubcommandError, (server, nick, "FOO"));
+    BENCH_REPLY(buildNotRegisteredError, (server));
+    BENCH_REPLY(buildUnknownCommandError, (server, "JOIN"));
+    BENCH_REPLY(buildAlreadyRegisteredError, (server));
+    BENCH_REPLY(buildPasswordMismatchError, (server));
+    BENCH_REPLY(buildNoNicknameGivenError, (server));
+    BENCH_REPLY(buildErroneousNicknameError, (server, "alice_"));
+    BENCH_REPLY(buildNicknameInUseError, (server, "alice_"));
+    BENCH_REPLY_ARGS(buildNickChangeMessage, (source, "alice_"), (prefix, "alice_"));
+    BENCH_REPLY(buildErroneousUsernameError, (server, "alice"));
+    BENCH_REPLY(buildYourHostMessage, (server, nick, "ircserv-1.0"));
+    BENCH_REPLY(buildServerCreatedMessage, (server, nick, "Sat Oct 17 2026"));
+    BENCH_REPLY(buildMyInfoMessage, (server, nick, "ircserv-1.0", "io", "itkol"));
+    BENCH_REPLY(buildISupportMessage, (server, nick, "CHANTYPES=# CASEMAPPING=rfc1459"));
+    BENCH_REPLY(buildMotdStartMessage, (server, nick));
+    BENCH_REPLY(buildMotdMessage, (server, nick, "Bienvenue sur le serveur, merci de respecter les autres utilisateurs."));
+    BENCH_REPLY(buildMotdEndMessage, (server, nick));
+    BENCH_REPLY(buildNamesReply, (server, nick, channel, names));
+    BENCH_REPLY(buildEndOfNamesMessage, (server, nick, channel));
+    BENCH_REPLY(buildBadChannelMaskError, (server, channel));
+    BENCH_REPLY(buildInviteOnlyChannelError, (server, channel));
+    BENCH_REPLY(buildBadChannelKeyError, (server, channel));
+    BENCH_REPLY(buildChannelIsFullError, (server, channel));
+    BENCH_REPLY_ARGS(buildJoinMessage, (nick, "alice", "203.0.113.7", channel), (prefix, channel));
+    BENCH_REPLY_ARGS(buildPartMessage, (nick, "alice", "203.0.113.7", channel), (prefix, channel));
+    BENCH_REPLY(buildCannotSendToChannelError, (server, nick, channel));
+    BENCH_REPLY(buildChannelModeIsResponse, (server, nick, channel, "+tk", " secret"));
+    BENCH_REPLY(buildStatsDebugReply, (server, nick, "commands 1234"));
+    BENCH_REPLY(buildStatsCommandsReply, (server, nick, "JOIN", 1234UL));
+    BENCH_REPLY(buildEndOfStatsReply, (server, nick, "z"));
+    BENCH_REPLY(buildInputTooLongError, (server, nick));
+    BENCH_REPLY(buildYoureOperReply, (server, nick));
+    BENCH_REPLY(buildRehashingReply, (server, nick, "rules.txt"));
+    BENCH_REPLY(buildNoPrivilegesError, (server, nick));
+    BENCH_REPLY(buildNoOperHostError, (server, nick));
+    BENCH_REPLY(buildPingMessage, (server));
+    BENCH_REPLY(buildClosingLinkMessage, ("203.0.113.7", "Client quit"));
+
+    std::cout << std::left << std::setw(36) << "moyenne" << std::right << std::fixed << std::setprecision(1)
+              << std::setw(10) << static_cast<double>(totalOldNs) / (ROUNDS * typeCount)
+              << std::setw(8) << static_cast<double>(totalOldAllocations) / (ROUNDS * typeCount)
+              << std::setw(10) << static_cast<double>(totalNewNs) / (ROUNDS * typeCount)
+              << std::setw(8) << static_cast<double>(totalNewAllocations) / (ROUNDS * typeCount) << std::endl;
+    return 0;
+}
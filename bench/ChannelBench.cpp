@@ -0,0 +1,292 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   ChannelBench.cpp                                   :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: raveriss <raveriss@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/17 10:05:51 by raveriss          #+#    #+#             */
+/*   Updated: 2026/10/17 10:05:51 by raveriss         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "Bench.hpp"
+
+/* For Server */
+#include "Server.hpp"
+
+/* For Channel */
+#include "Channel.hpp"
+
+/* For Client */
+#include "Client.hpp"
+
+/* For ReactorLoop */
+#include "ReactorLoop.hpp"
+
+/* For ServerConfig */
+#include "ServerConfig.hpp"
+
+/* For std::vector */
+#include <vector>
+
+/* For std::set */
+#include <set>
+
+/* For std::find, std::remove */
+#include <algorithm>
+
+/* For std::cout */
+#include <iostream>
+
+/* For std::setw */
+#include <iomanip>
+
+/**
+ * Banc d'essai de l'adhésion aux canaux, sur des canaux de 1 000 et
+ * 10 000 membres :
+ * - JOIN/PART : un membre tiré au hasard part puis revient, avec la
+ *   vérification d'adhésion faite par les commandes ;
+ * - diffusion : parcours des destinataires, l'auteur excepté ;
+ * - NAMES : statut (@, +) de chaque membre.
+ * L'ancienne structure (vecteur de membres et ensembles d'opérateurs et de
+ * voix) est reproduite telle qu'elle était avant la table d'adhésion.
+ */
+
+/* Paires PART + JOIN mesurées par taille */
+#define CHURN_ROUNDS 20000
+
+/* Diffusions et NAMES mesurés par taille */
+#define BROADCAST_ROUNDS 200
+
+/**
+ * Ancienne structure d'un canal : recherche linéaire des membres,
+ * un arbre par statut
+ */
+class OldChannel
+{
+    public:
+
+        void addClient(Client *client)
+        {
+            if (!hasClient(client))
+                _clients.push_back(client);
+        }
+
+        void removeClient(Client *client)
+        {
+            _clients.erase(std::remove(_clients.begin(), _clients.end(), client), _clients.end());
+            _operators.erase(client);
+        }
+
+        bool hasClient(Client *client) const
+        {
+            return std::find(_clients.begin(), _clients.end(), client) != _clients.end();
+        }
+
+        void addOperator(Client *client)
+        {
+            _operators.insert(client);
+        }
+
+        bool isOperator(Client *client) const
+        {
+            return _operators.find(client) != _operators.end();
+        }
+
+        bool hasVoice(const Client *client) const
+        {
+            return _voicedClients.find(const_cast<Client*>(client)) != _voicedClients.end();
+        }
+
+        const std::vector<Client*> &getClients() const
+        {
+            return _clients;
+        }
+
+    private:
+
+        std::vector<Client*> _clients;
+        std::set<Client*> _operators;
+        std::set<Client*> _voicedClients;
+};
+
+/* Générateur xorshift, reproductible d'une exécution à l'autre */
+static unsigned long nextRandom(unsigned long &state)
+{
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+/* Tire un membre sans statut : retirer un opérateur fait écrire les deux structures sur la sortie */
+static size_t pickMember(unsigned long &state, size_t count)
+{
+    size_t index = nextRandom(state) % count;
+    return index % 50 == 0 && index + 1 < count ? index + 1 : index;
+}
+
+/* Résultats d'une structure pour une taille de canal */
+struct ChannelTimes
+{
+    double churnNs;
+    double broadcastNs;
+    double namesNs;
+};
+
+/**
+ * Mesure l'ancienne structure, en ns par paire PART + JOIN et par membre
+ */
+static ChannelTimes benchOld(const std::vector<Client*> &members)
+{
+    OldChannel channel;
+    for (size_t i = 0; i < members.size(); ++i)
+    {
+        channel.addClient(members[i]);
+        if (i % 50 == 0)
+            channel.addOperator(members[i]);
+    }
+
+    ChannelTimes times;
+    unsigned long state = 88172645463325252UL;
+    uint64_t start = benchNowNs();
+    for (int round = 0; round < CHURN_ROUNDS; ++round)
+    {
+        Client *member = members[pickMember(state, members.size())];
+        if (channel.hasClient(member))
+            channel.removeClient(member);
+        if (!channel.hasClient(member))
+            channel.addClient(member);
+    }
+    times.churnNs = static_cast<double>(benchNowNs() - start) / CHURN_ROUNDS;
+
+    start = benchNowNs();
+    for (int round = 0; round < BROADCAST_ROUNDS; ++round)
+    {
+        Client *author = members[round % members.size()];
+        const std::vector<Client*> &clients = channel.getClients();
+        for (size_t i = 0; i < clients.size(); ++i)
+        {
+            if (clients[i] != author)
+                benchSink += clients[i]->getSocket();
+        }
+    }
+    times.broadcastNs = static_cast<double>(benchNowNs() - start) / (BROADCAST_ROUNDS * members.size());
+
+    start = benchNowNs();
+    for (int round = 0; round < BROADCAST_ROUNDS; ++round)
+    {
+        const std::vector<Client*> &clients = channel.getClients();
+        for (size_t i = 0; i < clients.size(); ++i)
+        {
+            if (channel.isOperator(clients[i]))
+                benchSink += '@';
+            else if (channel.hasVoice(clients[i]))
+                benchSink += '+';
+        }
+    }
+    times.namesNs = static_cast<double>(benchNowNs() - start) / (BROADCAST_ROUNDS * members.size());
+    return times;
+}
+
+/**
+ * Mesure Channel, en ns par paire PART + JOIN et par membre
+ */
+static ChannelTimes benchNew(const std::vector<Client*> &members)
+{
+    Channel channel("#bench");
+    for (size_t i = 0; i < members.size(); ++i)
+    {
+        channel.addClient(members[i]);
+        if (i % 50 == 0)
+            channel.addOperator(members[i]);
+    }
+
+    ChannelTimes times;
+    unsigned long state = 88172645463325252UL;
+    uint64_t start = benchNowNs();
+    for (int round = 0; round < CHURN_ROUNDS; ++round)
+    {
+        Client *member = members[pickMember(state, members.size())];
+        if (channel.hasClient(member))
+            channel.removeClient(member);
+        if (!channel.hasClient(member))
+            channel.addClient(member);
+    }
+    times.churnNs = static_cast<double>(benchNowNs() - start) / CHURN_ROUNDS;
+
+    start = benchNowNs();
+    for (int round = 0; round < BROADCAST_ROUNDS; ++round)
+    {
+        Client *author = members[round % members.size()];
+        int exceptFd = author->getSocket();
+        const std::vector<FanoutTarget> &targets = channel.getFanoutTargets();
+        for (size_t i = 0; i < targets.size(); ++i)
+        {
+            if (targets[i].fd != exceptFd)
+                benchSink += targets[i].fd;
+        }
+    }
+    times.broadcastNs = static_cast<double>(benchNowNs() - start) / (BROADCAST_ROUNDS * members.size());
+
+    start = benchNowNs();
+    for (int round = 0; round < BROADCAST_ROUNDS; ++round)
+    {
+        const std::vector<Client*> &clients = channel.getClients();
+        for (size_t i = 0; i < clients.size(); ++i)
+        {
+            unsigned int flags = channel.getMemberFlags(clients[i]);
+            if (flags & MEMBER_OPERATOR)
+                benchSink += '@';
+            else if (flags & MEMBER_VOICE)
+                benchSink += '+';
+        }
+    }
+    times.namesNs = static_cast<double>(benchNowNs() - start) / (BROADCAST_ROUNDS * members.size());
+
+    /* Members outlive the channel here: detach them before its destructor walks them */
+    for (size_t i = 0; i < members.size(); ++i)
+    {
+        channel.removeOperator(members[i]);
+        channel.removeClient(members[i]);
+    }
+    return times;
+}
+
+int main()
+{
+    static const size_t sizes[] = { 1000, 10000 };
+
+    /* Un serveur inerte, pour donner une boucle propriétaire aux clients */
+    ServerConfig config;
+    Server server(0, "bench", config);
+    ReactorLoop loop(server, 0, IRC_LINE_MAX, 0);
+
+    std::cout << "== Adhésion aux canaux (" << CHURN_ROUNDS << " PART + JOIN, " << BROADCAST_ROUNDS << " diffusions et NAMES)" << std::endl;
+    std::cout << std::setw(8) << "membres" << std::setw(12) << "structure"
+              << std::setw(16) << "PART+JOIN ns" << std::setw(16) << "diffusion ns/m" << std::setw(14) << "NAMES ns/m" << std::endl;
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s)
+    {
+        std::vector<Client*> members;
+        for (size_t i = 0; i < sizes[s]; ++i)
+        {
+            /* Descripteurs fictifs, au-delà de ceux du processus */
+            Client *client = new Client(1000000 + static_cast<int>(i));
+            client->setLoop(&loop);
+            members.push_back(client);
+        }
+
+        ChannelTimes before = benchOld(members);
+        ChannelTimes after = benchNew(members);
+        std::cout << std::fixed << std::setprecision(1)
+                  << std::setw(8) << sizes[s] << std::setw(12) << "ancienne"
+                  << std::setw(16) << before.churnNs << std::setw(16) << before.broadcastNs << std::setw(14) << before.namesNs << std::endl
+                  << std::setw(8) << sizes[s] << std::setw(12) << "Channel"
+                  << std::setw(16) << after.churnNs << std::setw(16) << after.broadcastNs << std::setw(14) << after.namesNs << std::endl;
+
+        for (size_t i = 0; i < members.size(); ++i)
+            delete members[i];
+    }
+    return 0;
+}
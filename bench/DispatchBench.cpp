@@ -0,0 +1,275 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   DispatchBench.cpp                                  :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: raveriss <raveriss@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/17 09:14:02 by raveriss          #+#    #+#             */
+/*   Updated: 2026/10/17 09:14:02 by raveriss         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "Bench.hpp"
+
+/* For Client */
+#include "Client.hpp"
+
+/* For EpollReactor */
+#include "EpollReactor.hpp"
+
+/* For std::vector */
+#include <vector>
+
+/* For std::cout */
+#include <iostream>
+
+/* For std::setw */
+#include <iomanip>
+
+/* For socket(), bind(), sendto(), recv(), getsockname() */
+#include <sys/socket.h>
+
+/* For sockaddr_in, htonl() */
+#include <netinet/in.h>
+
+/* For fcntl() */
+#include <fcntl.h>
+
+/* For close() */
+#include <unistd.h>
+
+/* For memset() */
+#include <cstring>
+
+/**
+ * Banc d'essai de l'aiguillage des sockets prêts vers leur Client.
+ *
+ * 1. Recherche seule, de 100 à 50 000 connexions : pour chaque tour, 64 fd
+ *    prêts tirés au hasard sont résolus par l'ancien parcours de la liste des
+ *    clients et par la table indexée par fd. Les clients portent des numéros
+ *    de fd au-delà de la limite du processus, jamais ouverts.
+ * 2. Chemin complet sur de vrais sockets : wait() d'epoll puis recherche dans
+ *    la table, 64 sockets UDP rendus lisibles par tour, jusqu'à la limite de
+ *    descripteurs du processus.
+ */
+
+/* Sockets rendus prêts par tour */
+#define READY_PER_ROUND 64
+
+/* Tours mesurés par taille */
+#define ROUNDS 200
+
+/* Générateur xorshift, reproductible d'une exécution à l'autre */
+static unsigned long nextRandom(unsigned long &state)
+{
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+/* Ancien aiguillage : parcours de la liste des clients */
+static Client *scanLookup(const std::vector<Client*> &clients, int fd)
+{
+    for (std::vector<Client*>::const_iterator it = clients.begin(); it != clients.end(); ++it)
+    {
+        if ((*it)->getSocket() == fd)
+            return *it;
+    }
+    return NULL;
+}
+
+/* Aiguillage actuel : une lecture dans la table indexée par fd */
+static Client *tableLookup(const std::vector<Client*> &clientsByFd, int fd)
+{
+    if (fd >= 0 && static_cast<size_t>(fd) < clientsByFd.size())
+        return clientsByFd[fd];
+    return NULL;
+}
+
+/**
+ * Mesure la recherche seule pour `count` clients
+ */
+static void benchLookup(size_t count, int firstFd)
+{
+    std::vector<Client*> clients;
+    std::vector<Client*> clientsByFd(firstFd + count, static_cast<Client*>(NULL));
+    for (size_t i = 0; i < count; ++i)
+    {
+        Client *client = new Client(firstFd + static_cast<int>(i));
+        clients.push_back(client);
+        clientsByFd[firstFd + i] = client;
+    }
+
+    /* Same ready fds for both passes; each pass runs alone so neither evicts the other's data */
+    std::vector<int> ready(static_cast<size_t>(ROUNDS) * READY_PER_ROUND);
+    unsigned long state = 88172645463325252UL;
+    for (size_t i = 0; i < ready.size(); ++i)
+        ready[i] = firstFd + static_cast<int>(nextRandom(state) % count);
+
+    uint64_t start = benchNowNs();
+    for (size_t i = 0; i < ready.size(); ++i)
+        benchSink += reinterpret_cast<unsigned long>(scanLookup(clients, ready[i]));
+    uint64_t scanNs = benchNowNs() - start;
+
+    start = benchNowNs();
+    for (size_t i = 0; i < ready.size(); ++i)
+        benchSink += reinterpret_cast<unsigned long>(tableLookup(clientsByFd, ready[i]));
+    uint64_t tableNs = benchNowNs() - start;
+
+    double lookups = static_cast<double>(ROUNDS) * READY_PER_ROUND;
+    std::cout << std::setw(8) << count
+              << std::setw(16) << std::fixed << std::setprecision(1) << scanNs / lookups
+              << std::setw(16) << tableNs / lookups << std::endl;
+
+    for (size_t i = 0; i < clients.size(); ++i)
+        delete clients[i];
+}
+
+/**
+ * Ouvre un socket UDP non bloquant lié à un port éphémère de 127.0.0.1
+ * @return le fd, -1 en cas d'échec ; `address` reçoit l'adresse liée
+ */
+static int openUdpSocket(struct sockaddr_in &address)
+{
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0)
+        return -1;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t length = sizeof(address);
+    if (bind(fd, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) != 0
+        || getsockname(fd, reinterpret_cast<struct sockaddr*>(&address), &length) != 0
+        || fcntl(fd, F_SETFL, O_NONBLOCK) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/**
+ * Mesure wait() puis la recherche dans la table pour `count` sockets surveillés
+ * @return false si les sockets n'ont pas pu être ouverts
+ */
+static bool benchEpoll(size_t count)
+{
+    EpollReactor reactor;
+    std::vector<Client*> clients;
+    std::vector<Client*> clientsByFd;
+    std::vector<struct sockaddr_in> addresses(count);
+    bool opened = true;
+
+    for (size_t i = 0; i < count && opened; ++i)
+    {
+        int fd = openUdpSocket(addresses[i]);
+        if (fd < 0 || !reactor.add(fd, Reactor::EV_READ))
+        {
+            if (fd >= 0)
+                close(fd);
+            opened = false;
+            break;
+        }
+        Client *client = new Client(fd);
+        clients.push_back(client);
+        if (static_cast<size_t>(fd) >= clientsByFd.size())
+            clientsByFd.resize(fd + 1, NULL);
+        clientsByFd[fd] = client;
+    }
+
+    int sender = socket(AF_INET, SOCK_DGRAM, 0);
+    if (sender < 0)
+        opened = false;
+
+    if (opened)
+    {
+        std::vector<ReactorEvent> events;
+        unsigned long state = 88172645463325252UL;
+        uint64_t dispatchNs = 0;
+        unsigned long dispatched = 0;
+        char byte = 'x';
+        char drain[16];
+
+        for (int round = 0; round < ROUNDS; ++round)
+        {
+            /* Distinct sockets: each one is signalled once per round */
+            std::vector<bool> chosen(count, false);
+            std::vector<size_t> picked;
+            while (picked.size() < READY_PER_ROUND && picked.size() < count)
+            {
+                size_t index = nextRandom(state) % count;
+                if (chosen[index])
+                    continue;
+                chosen[index] = true;
+                picked.push_back(index);
+                sendto(sender, &byte, 1, 0, reinterpret_cast<struct sockaddr*>(&addresses[index]), sizeof(addresses[index]));
+            }
+
+            std::vector<Client*> readable;
+            while (readable.size() < picked.size())
+            {
+                uint64_t start = benchNowNs();
+                int ready = reactor.wait(events, 1000);
+                if (ready <= 0)
+                    break;
+                for (int i = 0; i < ready; ++i)
+                {
+                    Client *client = tableLookup(clientsByFd, events[i].fd);
+                    if (client)
+                        readable.push_back(client);
+                }
+                dispatchNs += benchNowNs() - start;
+                dispatched += ready;
+            }
+
+            for (size_t i = 0; i < readable.size(); ++i)
+            {
+                while (recv(readable[i]->getSocket(), drain, sizeof(drain), 0) > 0)
+                    ;
+            }
+        }
+
+        std::cout << std::setw(8) << count
+                  << std::setw(16) << std::fixed << std::setprecision(1)
+                  << (dispatched ? static_cast<double>(dispatchNs) / dispatched : 0.0) << std::endl;
+    }
+
+    if (sender >= 0)
+        close(sender);
+    for (size_t i = 0; i < clients.size(); ++i)
+        delete clients[i];
+    return opened;
+}
+
+int main()
+{
+    static const size_t sizes[] = { 100, 1000, 10000, 20000, 50000 };
+    static const size_t sizeCount = sizeof(sizes) / sizeof(sizes[0]);
+
+    size_t fdLimit = benchRaiseFdLimit(sizes[sizeCount - 1] + 64);
+
+    std::cout << "== Aiguillage fd -> Client, recherche seule (" << READY_PER_ROUND << " fd prêts x " << ROUNDS << " tours)" << std::endl;
+    std::cout << std::setw(8) << "clients" << std::setw(16) << "parcours ns" << std::setw(16) << "table ns" << std::endl;
+    for (size_t i = 0; i < sizeCount; ++i)
+        benchLookup(sizes[i], static_cast<int>(fdLimit));
+
+    std::cout << std::endl << "== wait() epoll + table, sockets UDP réels (limite de descripteurs : " << fdLimit << ")" << std::endl;
+    std::cout << std::setw(8) << "sockets" << std::setw(16) << "ns par fd prêt" << std::endl;
+    for (size_t i = 0; i < sizeCount; ++i)
+    {
+        /* Beyond the descriptor limit, measure the largest set that fits once */
+        size_t count = sizes[i];
+        if (count + 64 > fdLimit)
+        {
+            count = fdLimit - 64;
+            std::cout << std::setw(8) << sizes[i] << "  au-delà de la limite, mesuré avec " << count << " sockets :" << std::endl;
+        }
+        if (!benchEpoll(count))
+            std::cout << std::setw(8) << count << "  non mesuré : sockets indisponibles" << std::endl;
+        if (count != sizes[i])
+            break;
+    }
+    return 0;
+}
@@ -0,0 +1,273 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   FanoutBench.cpp                                    :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: raveriss <raveriss@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/18 09:12:37 by raveriss          #+#    #+#             */
+/*   Updated: 2026/10/18 09:12:37 by raveriss         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "Bench.hpp"
+
+/* For Server */
+#include "Server.hpp"
+
+/* For Channel */
+#include "Channel.hpp"
+
+/* For Client */
+#include "Client.hpp"
+
+/* For FanoutEngine, FanoutPlan, FanoutDrain */
+#include "FanoutEngine.hpp"
+
+/* For ReactorLoop, LoopMessage */
+#include "ReactorLoop.hpp"
+
+/* For ServerConfig */
+#include "ServerConfig.hpp"
+
+/* For std::vector */
+#include <vector>
+
+/* For std::cout */
+#include <iostream>
+
+/* For std::setw */
+#include <iomanip>
+
+/* For sched_yield() */
+#include <sched.h>
+
+/**
+ * Banc d'essai de la diffusion par les travailleurs, sur des canaux de
+ * 1 000 et 10 000 membres répartis sur deux boucles :
+ * - répartition : travail d'une diffusion, tous travailleurs confondus,
+ *   avec l'ancienne remise (copie des destinataires dans un lot alloué,
+ *   parcouru en entier par chaque travailleur) puis avec le plan du canal,
+ *   réutilisé, dont chaque travailleur ne parcourt que sa part ;
+ * - bout en bout : diffusions confiées au moteur, boîtes aux lettres vidées
+ *   comme le feraient les boucles, et latence p50/p99 rapportée par STATS z.
+ */
+
+/* Diffusions mesurées par taille et par nombre de travailleurs */
+#define FANOUT_ROUNDS 200
+
+/* Nombre de boucles propriétaires des membres */
+#define FANOUT_LOOPS 2
+
+/**
+ * Ancienne remise : les destinataires copiés dans un lot alloué par
+ * diffusion, remis à chaque travailleur qui les parcourt tous
+ */
+struct OldBatch
+{
+    std::vector<FanoutTarget> targets;
+    SharedPayload payload;
+};
+
+/**
+ * Mesure l'ancienne remise, en ns par diffusion
+ */
+static double benchOld(const std::vector<FanoutTarget> &targets, size_t workers)
+{
+    std::vector<std::vector<LoopMessage> > outbox(FANOUT_LOOPS);
+    SharedPayload payload(":bench PRIVMSG #bench :hello\r\n");
+
+    uint64_t start = benchNowNs();
+    for (int round = 0; round < FANOUT_ROUNDS; ++round)
+    {
+        OldBatch *batch = new OldBatch;
+        batch->targets = targets;
+        batch->payload = payload;
+        for (size_t w = 0; w < workers; ++w)
+        {
+            for (size_t i = 0; i < batch->targets.size(); ++i)
+            {
+                const FanoutTarget &target = batch->targets[i];
+                if (static_cast<size_t>(target.fd) % workers != w)
+                    continue;
+
+                LoopMessage message;
+                message.fd = target.fd;
+                message.serial = target.serial;
+                message.payload = batch->payload;
+                outbox[target.loop].push_back(message);
+            }
+            for (size_t l = 0; l < outbox.size(); ++l)
+            {
+                benchSink += outbox[l].size();
+                outbox[l].clear();
+            }
+        }
+        delete batch;
+    }
+    return static_cast<double>(benchNowNs() - start) / FANOUT_ROUNDS;
+}
+
+/**
+ * Mesure la remise par plan, en ns par diffusion : le plan est celui du
+ * moteur, réutilisé d'une diffusion à l'autre
+ */
+static double benchPlan(const FanoutPlan &plan, size_t workers)
+{
+    std::vector<LoopMessage> outbox;
+    SharedPayload payload(":bench PRIVMSG #bench :hello\r\n");
+
+    uint64_t start = benchNowNs();
+    for (int round = 0; round < FANOUT_ROUNDS; ++round)
+    {
+        for (size_t w = 0; w < workers; ++w)
+        {
+            size_t end = plan.shares[w + 1];
+            size_t i = plan.shares[w];
+            while (i < end)
+            {
+                size_t loop = plan.targets[i].loop;
+                for (; i < end && plan.targets[i].loop == loop; ++i)
+                {
+                    outbox.push_back(LoopMessage());
+                    LoopMessage &message = outbox.back();
+                    message.fd = plan.targets[i].fd;
+                    message.serial = plan.targets[i].serial;
+                    message.payload = payload;
+                }
+                benchSink += outbox.size();
+                outbox.clear();
+            }
+        }
+    }
+    return static_cast<double>(benchNowNs() - start) / FANOUT_ROUNDS;
+}
+
+/**
+ * Vide les boîtes aux lettres comme deliverMessages(), en rendant les
+ * références de vidage
+ * @return le nombre de blocs retirés
+ */
+static size_t drainLoops(const std::vector<ReactorLoop*> &loops, std::vector<LoopMessage> &inbox)
+{
+    size_t taken = 0;
+    for (size_t l = 0; l < loops.size(); ++l)
+    {
+        loops[l]->takeMessages(inbox);
+        for (size_t i = 0; i < inbox.size(); ++i)
+        {
+            if (inbox[i].drain)
+                inbox[i].drain->release();
+        }
+        taken += inbox.size();
+    }
+    inbox.clear();
+    return taken;
+}
+
+/* Résultat de bout en bout pour une taille et un nombre de travailleurs */
+struct EngineTimes
+{
+    double broadcastNs;
+    unsigned long p50;
+    unsigned long p99;
+    bool drained;
+};
+
+/**
+ * Diffuse FANOUT_ROUNDS blocs par le moteur et attend qu'ils soient tous
+ * retirés des boîtes aux lettres
+ */
+static EngineTimes benchEngine(FanoutEngine &engine, Channel &channel, const std::vector<ReactorLoop*> &loops)
+{
+    std::vector<LoopMessage> inbox;
+    SharedPayload payload(":bench PRIVMSG #bench :hello\r\n");
+    size_t expected = static_cast<size_t>(FANOUT_ROUNDS) * channel.getClients().size();
+    size_t taken = 0;
+
+    channel.enableParallelFanout();
+    uint64_t start = benchNowNs();
+    for (int round = 0; round < FANOUT_ROUNDS; ++round)
+    {
+        engine.submit(channel.getFanoutPlan(engine), channel.getFanoutDrain(), payload, -1, 0);
+        taken += drainLoops(loops, inbox);
+    }
+    while (taken < expected)
+    {
+        sched_yield();
+        taken += drainLoops(loops, inbox);
+    }
+
+    EngineTimes times;
+    times.broadcastNs = static_cast<double>(benchNowNs() - start) / FANOUT_ROUNDS;
+    times.p50 = engine.latencyPercentile(50);
+    times.p99 = engine.latencyPercentile(99);
+    times.drained = channel.disableParallelFanout();
+    return times;
+}
+
+int main()
+{
+    static const size_t sizes[] = { 1000, 10000 };
+    static const size_t workerCounts[] = { 1, 2, 4 };
+
+    /* Un serveur inerte, pour donner des boucles propriétaires aux clients */
+    ServerConfig config;
+    Server server(0, "bench", config);
+    std::vector<ReactorLoop*> loops;
+    for (size_t l = 0; l < FANOUT_LOOPS; ++l)
+        loops.push_back(new ReactorLoop(server, l, IRC_LINE_MAX, 0));
+
+    std::cout << "== Diffusion par les travailleurs (" << FANOUT_ROUNDS << " diffusions, " << FANOUT_LOOPS << " boucles)" << std::endl;
+    std::cout << std::setw(8) << "membres" << std::setw(12) << "threads"
+              << std::setw(16) << "ancienne ns" << std::setw(14) << "plan ns"
+              << std::setw(16) << "moteur ns" << std::setw(10) << "p50 µs" << std::setw(10) << "p99 µs" << std::endl;
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s)
+    {
+        std::vector<Client*> members;
+        Channel channel("#bench");
+        for (size_t i = 0; i < sizes[s]; ++i)
+        {
+            /* Descripteurs fictifs, au-delà de ceux du processus */
+            Client *client = new Client(1000000 + static_cast<int>(i));
+            client->setLoop(loops[i % FANOUT_LOOPS]);
+            members.push_back(client);
+            channel.addClient(client);
+        }
+
+        for (size_t w = 0; w < sizeof(workerCounts) / sizeof(workerCounts[0]); ++w)
+        {
+            /* Jamais détruit : ses threads s'arrêtent avec le processus */
+            FanoutEngine *engine = new FanoutEngine;
+            if (!engine->start(workerCounts[w], loops, std::vector<int>()))
+            {
+                std::cerr << "fanout workers failed to start" << std::endl;
+                return 1;
+            }
+
+            double before = benchOld(channel.getFanoutTargets(), workerCounts[w]);
+            FanoutPlan *plan = engine->makePlan(channel.getFanoutTargets());
+            double after = benchPlan(*plan, workerCounts[w]);
+            plan->release();
+            EngineTimes times = benchEngine(*engine, channel, loops);
+            if (!times.drained)
+            {
+                std::cerr << "fanout drain still holds blocks" << std::endl;
+                return 1;
+            }
+
+            std::cout << std::fixed << std::setprecision(1)
+                      << std::setw(8) << sizes[s] << std::setw(12) << workerCounts[w]
+                      << std::setw(16) << before << std::setw(14) << after
+                      << std::setw(16) << times.broadcastNs << std::setw(11) << times.p50 << std::setw(11) << times.p99 << std::endl;
+        }
+
+        /* Members outlive the channel here: detach them before its destructor walks them */
+        for (size_t i = 0; i < members.size(); ++i)
+        {
+            channel.removeClient(members[i]);
+            delete members[i];
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,148 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   FramerBench.cpp                                    :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: raveriss <raveriss@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/17 09:41:27 by raveriss          #+#    #+#             */
+/*   Updated: 2026/10/17 09:41:27 by raveriss         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "Bench.hpp"
+
+/* For LineFramer, LineSpan */
+#include "LineFramer.hpp"
+
+/* For std::string */
+#include <string>
+
+/* For std::vector */
+#include <vector>
+
+/* For std::cout */
+#include <iostream>
+
+/* For std::setw */
+#include <iomanip>
+
+/* For std::ostringstream */
+#include <sstream>
+
+/**
+ * Banc d'essai du découpage en lignes : 1, 10 et 100 lignes par recv().
+ * Chaque lecture est découpée par l'ancien code (append, find, substr et
+ * erase sur un std::string par client) puis par LineFramer, sur le même
+ * flux. En mode « décalé », les lectures coupent une ligne sur deux
+ * lectures, comme le noyau le fait en pratique.
+ */
+
+/* Lignes découpées par mesure */
+#define LINES_PER_RUN 200000
+
+/* Ancien découpage : retourne le nombre de lignes rendues */
+static size_t splitWithString(std::string &messageBuffer, const char *data, size_t length)
+{
+    size_t lines = 0;
+    messageBuffer.append(data, length);
+    std::string::size_type pos;
+    while ((pos = messageBuffer.find('\n')) != std::string::npos)
+    {
+        std::string message = messageBuffer.substr(0, pos);
+        messageBuffer.erase(0, pos + 1);
+        if (!message.empty() && message[message.size() - 1] == '\r')
+            message.erase(message.size() - 1);
+        benchSink += message.size();
+        ++lines;
+    }
+    return lines;
+}
+
+/* Découpage actuel : retourne le nombre de lignes rendues */
+static size_t splitWithFramer(LineFramer &framer, const char *data, size_t length)
+{
+    size_t lines = 0;
+    LineSpan line;
+    while (framer.nextLine(data, length, line))
+    {
+        benchSink += line.length;
+        ++lines;
+    }
+    return lines;
+}
+
+/**
+ * Construit le flux : `count` lignes PRIVMSG de longueurs variées
+ */
+static std::string buildStream(size_t count)
+{
+    std::ostringstream stream;
+    for (size_t i = 0; i < count; ++i)
+    {
+        stream << "PRIVMSG #general :message " << i << " du client";
+        for (size_t word = 0; word < i % 7; ++word)
+            stream << " encore un mot";
+        stream << "\r\n";
+    }
+    return stream.str();
+}
+
+/**
+ * Découpe le flux en lectures de `linesPerRecv` lignes, décalées de
+ * `shift` octets, et mesure les deux découpages
+ */
+static void benchSplit(const std::string &stream, size_t linesPerRecv, size_t shift)
+{
+    /* Chunk boundaries: after every linesPerRecv lines, moved `shift` bytes forward */
+    std::vector<size_t> bounds;
+    bounds.push_back(0);
+    size_t lines = 0;
+    for (size_t i = 0; i < stream.size(); ++i)
+    {
+        if (stream[i] == '\n' && ++lines % linesPerRecv == 0 && i + 1 + shift < stream.size())
+            bounds.push_back(i + 1 + shift);
+    }
+    bounds.push_back(stream.size());
+
+    std::string messageBuffer;
+    size_t oldLines = 0;
+    uint64_t start = benchNowNs();
+    for (size_t i = 0; i + 1 < bounds.size(); ++i)
+        oldLines += splitWithString(messageBuffer, stream.data() + bounds[i], bounds[i + 1] - bounds[i]);
+    uint64_t oldNs = benchNowNs() - start;
+
+    LineFramer framer;
+    size_t newLines = 0;
+    start = benchNowNs();
+    for (size_t i = 0; i + 1 < bounds.size(); ++i)
+        newLines += splitWithFramer(framer, stream.data() + bounds[i], bounds[i + 1] - bounds[i]);
+    uint64_t newNs = benchNowNs() - start;
+
+    double reads = static_cast<double>(bounds.size() - 1);
+    std::cout << std::setw(10) << linesPerRecv << (shift ? "    décalé" : "    aligné")
+              << std::setw(14) << std::fixed << std::setprecision(1) << oldNs / static_cast<double>(oldLines)
+              << std::setw(14) << newNs / static_cast<double>(newLines)
+              << std::setw(14) << oldNs / reads
+              << std::setw(14) << newNs / reads;
+    if (oldLines != newLines)
+        std::cout << "  lignes différentes : " << oldLines << " / " << newLines;
+    std::cout << std::endl;
+}
+
+int main()
+{
+    static const size_t linesPerRecv[] = { 1, 10, 100 };
+    std::string stream = buildStream(LINES_PER_RUN);
+
+    std::cout << "== Découpage en lignes, " << LINES_PER_RUN << " lignes (" << stream.size() / LINES_PER_RUN << " octets en moyenne)" << std::endl;
+    std::cout << std::setw(10) << "lignes" << std::setw(10) << "lecture"
+              << std::setw(14) << "string ns/l" << std::setw(14) << "anneau ns/l"
+              << std::setw(14) << "string ns/r" << std::setw(14) << "anneau ns/r" << std::endl;
+    for (size_t i = 0; i < sizeof(linesPerRecv) / sizeof(linesPerRecv[0]); ++i)
+    {
+        benchSplit(stream, linesPerRecv[i], 0);
+        benchSplit(stream, linesPerRecv[i], 23);
+    }
+    return 0;
+}
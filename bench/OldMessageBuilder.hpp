@@ -0,0 +1,540 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   OldMessageBuilder.hpp                              :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: raveriss <raveriss@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/18 08:47:10 by raveriss          #+#    #+#             */
+/*   Updated: 2026/10/18 08:47:10 by raveriss         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef OLDMESSAGEBUILDER_HPP
+#define OLDMESSAGEBUILDER_HPP
+
+/* For ERR_*, RPL_* */
+#include "IrcNumericReplies.hpp"
+
+/* For std::string */
+#include <string>
+
+/* For std::ostringstream */
+#include <sstream>
+
+/**
+ * Constructeurs de réponses tels qu'ils étaient avant IrcReply, recopiés
+ * sans changement pour le banc d'essai BuilderBench : un ostringstream,
+ * str(), puis truncateAndAppend() qui tronque et ajoute CRLF.
+ */
+namespace OldMessageBuilder
+{
+    inline std::string truncateAndAppend(const std::string& message) {
+        const size_t maxLength = 510;
+        if (message.length() > maxLength) {
+            return message.substr(0, maxLength) + "\r\n";
+        }
+        return message + "\r\n";
+    }
+
+    inline std::string buildNeedMoreParamsError(const std::string& serverName, const std::string& command)
+    {
+        std::ostringstream oss;
+        oss << ":" << serverName << ERR_NEEDMOREPARAMS << " " << command << " :Not enough parameters";
+        return truncateAndAppend(oss.str());
+    }
+
+    inline std::string buildErrorMessage(const std::string& serverName, const std::string& errorCode, const std::string& details) {
+        std::ostringstream oss;
+        oss << ":" << serverName << " " << errorCode << " " << details;
+        return truncateAndAppend(oss.str());
+    }
+
+    inline std::string buildWelcomeMessage(const std::string& serverName, const std::string& nickname, const std::string& realName, const std::string& host) {
+        std::ostringstream oss;
+        oss << ":" << serverName << RPL_WELCOME << nickname 
+            << " :Welcome to the Internet Relay Network " 
+            << nickname << "!" << realName << "@" << host;
+        return truncateAndAppend(oss.str());
+    }
+
+    /**
+     * ERR_NOSUCHCHANNEL : "403 channelName :No such channel\r\n"
+     */
+    inline std::string buildNoSuchChannelError(const std::string& serverName, const std::string& channelName) {
+        std::ostringstream oss;
+        oss << ":" << serverName << ERR_NOSUCHCHANNEL << channelName << " :No such channel";
+        return truncateAndAppend(oss.str());
+    }
+
+    /**
+     * ERR_CHANOPRIVSNEEDED : "482 channelName :You're not channel operator\r\n"
+     */
+    inline std::string buildChannelOperatorNeededError(const std::string& serverName, const std::string& nickname, const std::string& channelName) {
+        std::ostringstream oss;
+        oss << ":" << serverName << ERR_CHANOPRIVSNEEDED << nickname << " " << channelName << " :You're not channel operator";
+        return truncateAndAppend(oss.str());
+    }
+
+    /**
+     * ERR_USERNOTINCHANNEL : " 441 user channel :They aren't on that channel\r\n"
+     */
+    inline std::string buildUserNotInChannelError(const std::string& serverName, const std::string& nickname, const std::string& channelName) {
+        std::ostringstream oss;
+        oss << ":" << serverName << ERR_USERNOTINCHANNEL << nickname << " " << channelName << " :They aren't on that channel";
+        return truncateAndAppend(oss.str());
+    }
+
+    /**
+     * ERR_UNKNOWNMODE : "472 modeChar :Unknown MODE flag\r\n"
+     */
+    inline std::string buildUnknownModeError(const std::string& serverName, const std::string& nickname, char modeChar) {
+        std::ostringstream oss;
+        oss << ":" << serverName << ERR_UNKNOWNMODE << nickname << " " << modeChar << " :is unknown mode char to me";
+        return truncateAndAppend(oss.str());
+    }
+
+    inline std::string buildModeChangeMessage(const std::string& nickname, const std::string& channelName, const std::string& modeString) {
+        std::ostringstream oss;
+        oss << ":" << nickname << " MODE " << channelName << " " << modeString;
+        return truncateAndAppend(oss.str());
+    }
+
+    /**
+     * ERR_NOTONCHANNEL : "442 channelName :You're not on that channel\r\n"
+     */
+    inline std::string buildNotOnChannelError(const std::string& serverName, const std::string& channelName) {
+        std::ostringstream oss;
+        oss << ":" << serverName << ERR_NOTONCHANNEL << channelName << " :You're not on that channel";
+        return truncateAndAppend(oss.str());
+    }
+
+    /**
+     * ERR_NOSUCHNICK : "401 targetNick :No such nick/channel\r\n"
+     */
+    inline std::string buildNoSuchNickError(const std::string& serverName, const std::string& targetNick) {
+        std::ostringstream oss;
+        oss << ":" << serverName << ERR_NOSUCHNICK << targetNick << " :No such nick/channel";
+        return truncateAndAppend(oss.str());
+    }
+
+    /**
+     * ERR_USERONCHANNEL : "443 targetNick channelName :is already on channel\r\n"
+     */
+    inline std::string buildUserOnChannelError(const std::string& serverName, const std::string& targetNick, const std::string& channelName) {
+        std::ostringstream oss;
+        oss << ":" << serverName << ERR_USERONCHANNEL << targetNick << " " << channelName << " :is already on channel";
+        return truncateAndAppend(oss.str());
+    }
+
+    /**
+     * MSG_INVITE : "nickname INVITE targetNick :channelName\r\n"
+     */
+    inline std::string buildInviteMessage(const std::string& nickname, const std::string& targetNick, const std::string& channelName) {
+        std::ostringstream oss;
+        oss << ":" << nickname << " INVITE " << targetNick << " :" << channelName;
+        return truncateAndAppend(oss.str());
+    }
+
+    /**
+     * RPL_INVITING : "341 nickname targetNick :channelName\r\n"
+     */
+    inline std::string buildInvitingReply(const std::string& serverName, const std::string& nickname, const std::string& targetNick, const std::string& channelName) {
+        std::ostringstream oss;
+        oss << ":" << serverName << RPL_INVITING << nickname << " " << targetNick << " :" << channelName;
+        return truncateAndAppend(oss.str());
+    }
+
+    /**
+     * RPL_TOPIC : "332 channelName :topic\r\n"
+     */
+    inline std::string buildTopicReply(const std::string& serverName, const std::string& nickname, const std::string& channelName, const std::string& topic) {
+        std::ostringstream oss;
+        oss << ":" << serverName << RPL_TOPIC << nickname << " " << channelName << " :" << topic;
+        return truncateAndAppend(oss.str());
+    }
+
+    /**
+     * RPL_NOTOPIC : "331 channelName :No topic is set\r\n"
+     */
+    inline std::string buildNoTopicReply(const std::string& serverName, const std::string& nickname, const std::string& channelName) {
+        std::ostringstream oss;
+        oss << ":" << serverName << RPL_NOTOPIC << nickname << " " << channelName << " :No topic is set";
+        return truncateAndAppend(oss.str());
+    }
+
+    /**
+     * MSG_TOPIC : "nickname TOPIC channelName :topic\r\n"
+     */
+    inline std::string buildTopicMessage(const std::string& nickname, const std::string& channelName, const std::string& topic) {
+        std::ostringstream oss;
+        oss << ":" << nickname << " TOPIC " << channelName << " :" << topic;
+        return truncateAndAppend(oss.str());
+    }
+
+    /**
+     * MSG_KICK : "nickname KICK channelName targetNick :comment\r\n"
+     */
+    inline std::string buildKickMessage(const std::string& nickname, const std::string& channelName, const std::string& targetNick, const std::string& comment) {
+        std::ostringstream oss;
+        oss << ":" << nickname << " KICK " << channelName << " " << targetNick << " :" << comment;
+        return truncateAndAppend(oss.str());
+    }
+
+    /**
+     * MSG CAP : "nickname CAP * LS :capabilities\r\n"
+     */
+    inline std::string buildCapabilityListMessage(const std::string& serverName, const std::string& nick, const std::string& capabilities) {
+        std::ostringstream oss;
+        oss << ":" << serverName << " CAP " << nick << " LS :" << capabilities;
+        return truncateAndAppend(oss.str());
+    }
+
+    /**
+     * ERR_INVALIDCAPCMD : "410 nick subCommand :Invalid CAP subcommand\r\n"
+     */
+    inline std::string buildInvalidCapSubcommandError(const std::string& serverName, const std::string& nick, const std::string& subCommand) {
+        std::ostringstream oss;
+        oss << ":" << serverName << ERR_INVALIDCAPCMD << nick << " " << subCommand << " :Invalid CAP subcommand";
+        return truncateAndAppend(oss.str());
+    }
+
+    /**
+     * ERR_NOTREGISTERED : "451 :You have not registered\r\n"
+     */
+    inline std::string buildNotRegisteredError(const std::string& serverName) {
+        std::ostringstream oss;
+        oss << ":" << serverName << ERR_NOTREGISTERED << ":You have not registered";
+        return truncateAndAppend(oss.str());
+    }
+
+    /**
+     * ERR_UNKNOWNCOMMAND : "421 serverName command :Unknown command\r\n"
+     */
+    inline std::string buildUnknownCommandError(const std::string& serverName, const std::string& command) {
+        std::ostringstream oss;
+        oss << ":" << serverName << ERR_UNKNOWNCOMMAND << command << " :Unknown command";
+        return truncateAndAppend(oss.str());
+    }
+
+    /**
+     * ERR_ALREADYREGISTRED : "You may not reregister\r\n"
+     */
+    inline std::string buildAlreadyRegisteredError(const std::string& serverName) {
+        std::ostringstream oss;
+        oss << ":" << serverName << ERR_ALREADYREGISTRED << ":You may not reregister";
+        return truncateAndAppend(oss.str());
+    }
+
+    /**
+     * ERR_PASSWDMISMATCH : "464 :Password incorrect\r\n"
+     */
+    inline std::string buildPasswordMismatchError(const std::string& serverName) {
+        std::ostringstream oss;
+        oss << ":" << serverName << ERR_PASSWDMISMATCH << ":Password incorrect";
+        return truncateAndAppend(oss.str());
+    }
+
+    /**
+     * ERR_NONICKNAMEGIVEN : "431 :No nickname given\r\n"
+     */
+    inline std::string buildNoNicknameGivenError(const std::string& serverName) {
+        std::ostringstream oss;
+        oss << ":" << serverName << ERR_NONICKNAMEGIVEN << ":No nickname given";
+        return truncateAndAppend(oss.str());
+    }
+
+    /**
+     * ERR_ERRONEUSNICKNAME : "432 nickname :Erroneous nickname\r\n"
+     */
+    inline std::string buildErroneousNicknameError(const std::string& serverName, const std::string& newNickname) {
+        std::ostringstream oss;
+        oss << ":" << serverName << ERR_ERRONEUSNICKNAME << newNickname << " :Erroneous nickname";
+        return truncateAndAppend(oss.str());
+    }
+
+    /**
+     * ERR_NICKNAMEINUSE : "433 nickname :Nickname is already in use\r\n"
+     */
+    inline std::string buildNicknameInUseError(const std::string& serverName, const std::string& newNickname) {
+        std::ostringstream oss;
+        oss << ":" << serverName << ERR_NICKNAMEINUSE << newNickname << " :Nickname is already in use";
+        return truncateAndAppend(oss.str());
+    }
+
+    /**
+     * MSG NICK : "nickname NICK :newNickname\r\n"
+     */
+    inline std::string buildNickChangeMessage(const std::string& currentNickname, const std::string& newNickname) {
+        std::ostringstream oss;
+        oss << ":" << currentNickname << " NICK :" << newNickname << ".\033[0m";
+        return truncateAndAppend(oss.str());
+    }
+
+    /**
+     * ERR_ERRONEUSUSERNAME : "491 username :Erroneous username\r\n"
+     */
+    inline std::string buildErroneousUsernameError(const std::string& serverName, const std::string& username) {
+        std::ostringstream oss;
+        oss << ":" << serverName << ERR_ERRONEUSUSERNAME << username << " :Erroneous username";
+        return truncateAndAppend(oss.str());
+    }
+
+    /**
+     * MSG HOST : "nickname HOST :serverName version\r\n"
+     */
+    inline std::string buildYourHostMessage(const std::string& serverName, const std::string& nick, const std::string& serverVersion) {
+        std::ostringstream oss;
+        oss << ":" << serverName << RPL_YOURHOST << nick 
+            << " :Your host is " << serverName << ", running version " << serverVersion;
+        return truncateAndAppend(oss.str());
+    }
+
+    /**
+     * RPL_CREATED : "003 :This server was created at some point in the past\r\n"
+     */
+    inline std::string buildServerCreatedMessage(const std::string& serverName, const std::string& nick, const std::string& creationDate) {
+        std::ostringstream oss;
+        oss << ":" << serverName << RPL_CREATED << nick 
+            << " :This server was created " << creationDate;
+        return truncateAndAppend(oss.str());
+    }
+
+    /**
+     * RPL_MYINFO : "004 serverName 1.0 o o\r\n"
+     */
+    inline std::string buildMyInfoMessage(const std::string& serverName, const std::string& nick, const std::string& version, const std::string& userModes, const std::string& channelModes) {
+        std::ostringstream oss;
+        oss << ":" << serverName << RPL_MYINFO << nick << " " << serverName << " " << version 
+            << " " << userModes << " " << channelModes;
+        return truncateAndAppend(oss.str());
+    }
+
+    /**
+     * RPL_ISUPPORT : "005 nick tokens :are supported by this server\r\n"
+     */
+    inline std::string buildISupportMessage(const std::string& serverName, const std::string& nick, const std::string& tokens) {
+        std::ostringstream oss;
+        oss << ":" << serverName << RPL_ISUPPORT << nick << " " << tokens << " :are supported by this server";
+        return truncateAndAppend(oss.str());
+    }
+
+    /**
+     * RPL_MOTDSTART : "375 nick :- serverName Message of the Day -\r\n"
+     */
+    inline std::string buildMotdStartMessage(const std::string& serverName, const std::string& nick) {
+        std::ostringstream oss;
+        oss << ":" << serverName << RPL_MOTDSTART << nick << " :- " << serverName << " Message of the Day -";
+        return truncateAndAppend(oss.str());
+    }
+
+    /**
+     * RPL_MOTD : "372 nick :- Welcome to our IRC server!\r\n"
+     */
+    inline std::string buildMotdMessage(const std::string& serverName, const std::string& nick, const std::string& message) {
+        std::ostringstream oss;
+        oss << ":" << serverName << RPL_MOTD << nick << " :- " << message;
+        return truncateAndAppend(oss.str());
+    }
+
+    /**
+     * RPL_ENDOFMOTD : "376 nick :End of /MOTD command.\r\n"
+     */
+    inline std::string buildMotdEndMessage(const std::string& serverName, const std::string& nick) {
+        std::ostringstream oss;
+        oss << ":" << serverName << RPL_ENDOFMOTD << nick << " :End of /MOTD command.";
+        return truncateAndAppend(oss.str());
+    }
+
+    /**
+     * RPL_NAMREPLY : "353 nick = channelName :nickList\r\n"
+     */
+    inline std::string buildNamesReply(const std::string& serverName, const std::string& nick, const std::string& channelName, const std::string& nickList) {
+        std::ostringstream oss;
+        oss << ":" << serverName << RPL_NAMREPLY << nick << " = " << channelName << " :" << nickList;
+        return truncateAndAppend(oss.str());
+    }
+
+    /**
+     * RPL_ENDOFNAMES : "366 nick channelName :End of /NAMES list\r\n"
+     */
+    inline std::string buildEndOfNamesMessage(const std::string& serverName, const std::string& nick, const std::string& channelName) {
+        std::ostringstream oss;
+        oss << ":" << serverName << RPL_ENDOFNAMES << nick << " " << channelName << " :End of /NAMES list.";
+        return truncateAndAppend(oss.str());
+    }
+
+    /**
+     * ERR_BADCHANMASK : "476 channelName :Bad Channel Mask\r\n"
+     */
+    inline std::string buildBadChannelMaskError(const std::string& serverName, const std::string& channelName) {
+        std::ostringstream oss;
+        oss << ":" << serverName << ERR_BADCHANMASK << channelName << " :Bad Channel Mask";
+        return truncateAndAppend(oss.str());
+    }
+
+    /**
+     * ERR_INVITEONLYCHAN : "473 channelName :Cannot join channel (+i)\r\n"
+     */
+    inline std::string buildInviteOnlyChannelError(const std::string& serverName, const std::string& channelName) {
+        std::ostringstream oss;
+        oss << ":" << serverName << ERR_INVITEONLYCHAN << channelName << " :Cannot join channel (+i)";
+        return truncateAndAppend(oss.str());
+    }
+
+    /**
+     * ERR_BADCHANNELKEY : "475 channelName :Cannot join channel (+k)\r\n"
+     */
+    inline std::string buildBadChannelKeyError(const std::string& serverName, const std::string& channelName) {
+        std::ostringstream oss;
+        oss << ":" << serverName << ERR_BADCHANNELKEY << channelName << " :Cannot join channel (+k)";
+        return truncateAndAppend(oss.str());
+    }
+
+    /**
+     * ERR_CHANNELISFULL : "471 channelName :Cannot join channel (+l)\r\n"
+     */
+    inline std::string buildChannelIsFullError(const std::string& serverName, const std::string& channelName) {
+        std::ostringstream oss;
+        oss << ":" << serverName << ERR_CHANNELISFULL << channelName << " :Cannot join channel (+l)";
+        return truncateAndAppend(oss.str());
+    }
+
+    /**
+     * MSG JOIN : "nickname JOIN :channelName\r\n"
+     */
+    inline std::string buildJoinMessage(const std::string& nickname, const std::string& realname, const std::string& serverIp, const std::string& channelName) {
+        std::ostringstream oss;
+        oss << ":" << nickname << "!" << realname << "@" << serverIp << " JOIN :" << channelName;
+        return truncateAndAppend(oss.str());
+    }
+
+    /**
+     * MSG PART : "nickname PART :channelName\r\n"
+     */
+    inline std::string buildPartMessage(const std::string& nickname, const std::string& username, const std::string& serverIp, const std::string& channelName) {
+        std::ostringstream oss;
+        oss << ":" << nickname << "!" << username << "@" << serverIp << " PART " << channelName;
+        return truncateAndAppend(oss.str());
+    }
+
+    /**
+     * ERR_CANNOTSENDTOCHAN : "serverName 404 nickname channelName :Cannot send to channel\r\n"
+     */
+    inline std::string buildCannotSendToChannelError(const std::string& serverName, const std::string& nickname, const std::string& target) {
+        std::ostringstream oss;
+        oss << ":" << serverName << ERR_CANNOTSENDTOCHAN << nickname << " " << target << " :Cannot send to channel";
+        return truncateAndAppend(oss.str());
+    }
+
+    /**
+     * RPL_CHANNELMODEIS : "324 nickname channelName modes [modeParams]\r\n"
+     */
+    inline std::string buildChannelModeIsResponse(
+        const std::string& serverName,
+        const std::string& nickname,
+        const std::string& channelName,
+        const std::string& modes,
+        const std::string& modeParams
+    )
+    {
+        std::ostringstream oss;
+        oss << ":" << serverName << RPL_CHANNELMODEIS << nickname << " " << channelName << " " << modes;
+        if (!modeParams.empty()) {
+            oss << " " << modeParams;
+        }
+        return truncateAndAppend(oss.str());
+    }
+
+    /**
+     * RPL_STATSDEBUG : "249 nickname :text\r\n"
+     */
+    inline std::string buildStatsDebugReply(const std::string& serverName, const std::string& nickname, const std::string& text) {
+        std::ostringstream oss;
+        oss << ":" << serverName << RPL_STATSDEBUG << nickname << " :" << text;
+        return truncateAndAppend(oss.str());
+    }
+
+    /**
+     * RPL_STATSCOMMANDS : "212 nickname command count\r\n"
+     */
+    inline std::string buildStatsCommandsReply(const std::string& serverName, const std::string& nickname, const std::string& command, unsigned long count) {
+        std::ostringstream oss;
+        oss << ":" << serverName << RPL_STATSCOMMANDS << nickname << " " << command << " " << count;
+        return truncateAndAppend(oss.str());
+    }
+
+    /**
+     * RPL_ENDOFSTATS : "219 nickname letter :End of /STATS report\r\n"
+     */
+    inline std::string buildEndOfStatsReply(const std::string& serverName, const std::string& nickname, const std::string& letter) {
+        std::ostringstream oss;
+        oss << ":" << serverName << RPL_ENDOFSTATS << nickname << " " << letter << " :End of /STATS report";
+        return truncateAndAppend(oss.str());
+    }
+
+    /**
+     * ERR_INPUTTOOLONG : "Input line was too long\r\n"
+     */
+    inline std::string buildInputTooLongError(const std::string& serverName, const std::string& nickname) {
+        std::ostringstream oss;
+        oss << ":" << serverName << ERR_INPUTTOOLONG << nickname << " :Input line was too long";
+        return truncateAndAppend(oss.str());
+    }
+
+    /**
+     * RPL_YOUREOPER : "You are now an IRC operator\r\n"
+     */
+    inline std::string buildYoureOperReply(const std::string& serverName, const std::string& nickname) {
+        std::ostringstream oss;
+        oss << ":" << serverName << RPL_YOUREOPER << nickname << " :You are now an IRC operator";
+        return truncateAndAppend(oss.str());
+    }
+
+    /**
+     * RPL_REHASHING : "configFile :Rehashing\r\n"
+     */
+    inline std::string buildRehashingReply(const std::string& serverName, const std::string& nickname, const std::string& configFile) {
+        std::ostringstream oss;
+        oss << ":" << serverName << RPL_REHASHING << nickname << " " << configFile << " :Rehashing";
+        return truncateAndAppend(oss.str());
+    }
+
+    /**
+     * ERR_NOPRIVILEGES : "Permission Denied- You're not an IRC operator\r\n"
+     */
+    inline std::string buildNoPrivilegesError(const std::string& serverName, const std::string& nickname) {
+        std::ostringstream oss;
+        oss << ":" << serverName << ERR_NOPRIVILEGES << nickname << " :Permission Denied- You're not an IRC operator";
+        return truncateAndAppend(oss.str());
+    }
+
+    /**
+     * ERR_NOOPERHOST : "No O-lines for your host\r\n"
+     */
+    inline std::string buildNoOperHostError(const std::string& serverName, const std::string& nickname) {
+        std::ostringstream oss;
+        oss << ":" << serverName << ERR_NOOPERHOST << nickname << " :No O-lines for your host";
+        return truncateAndAppend(oss.str());
+    }
+
+    /**
+     * MSG_PING : "PING :serverName\r\n"
+     */
+    inline std::string buildPingMessage(const std::string& serverName) {
+        std::ostringstream oss;
+        oss << "PING :" << serverName;
+        return truncateAndAppend(oss.str());
+    }
+
+    /**
+     * MSG_ERROR : "ERROR :Closing Link: hostname (reason)\r\n"
+     */
+    inline std::string buildClosingLinkMessage(const std::string& hostname, const std::string& reason) {
+        std::ostringstream oss;
+        oss << "ERROR :Closing Link: " << hostname << " (" << reason << ")";
+        return truncateAndAppend(oss.str());
+    }
+}
+
+#endif /* OLDMESSAGEBUILDER_HPP */
@@ -0,0 +1,370 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   ScalingBench.cpp                                   :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: raveriss <raveriss@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/18 10:12:44 by raveriss          #+#    #+#             */
+/*   Updated: 2026/10/18 10:12:44 by raveriss         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "Bench.hpp"
+
+/* For std::vector */
+#include <vector>
+
+/* For std::string */
+#include <string>
+
+/* For std::cout */
+#include <iostream>
+
+/* For std::setw */
+#include <iomanip>
+
+/* For std::ostringstream */
+#include <sstream>
+
+/* For socket(), connect(), send(), recv() */
+#include <sys/socket.h>
+
+/* For sockaddr_in, htons() */
+#include <netinet/in.h>
+
+/* For inet_addr() */
+#include <arpa/inet.h>
+
+/* For poll() */
+#include <poll.h>
+
+/* For waitpid() */
+#include <sys/wait.h>
+
+/* For kill(), SIGKILL */
+#include <csignal>
+
+/* For fork(), execv(), dup2(), close(), usleep(), sysconf() */
+#include <unistd.h>
+
+/* For open() */
+#include <fcntl.h>
+
+/* For memset(), memchr() */
+#include <cstring>
+
+/* For errno */
+#include <cerrno>
+
+/**
+ * Banc d'essai de la montée en charge : lance ./ircserv avec 1, 2, 4 puis
+ * 8 boucles d'événements, puis avec 1, 2, 4 et 8 shards, et mesure le débit
+ * de PRIVMSG vu par des clients TCP réels. Le générateur tourne dans ce
+ * processus, sur les mêmes processeurs que le serveur.
+ *
+ * 1. Pseudonyme : chaque client écrit au client d'en face (i + N/2), le
+ *    plus souvent servi par une autre boucle ; seul _nickLock est pris.
+ * 2. Canal : les clients sont répartis sur CHANNELS canaux et écrivent à
+ *    leur canal ; chaque ligne est livrée aux autres membres. Avec des
+ *    shards, chaque canal est servi par le sien, sous son propre verrou.
+ *
+ * Le débit est compté en lignes livrées par seconde, tours fermés : chaque
+ * client envoie LINES_PER_ROUND lignes, puis le tour attend toutes les
+ * livraisons attendues.
+ */
+
+/* Connexions ouvertes vers le serveur */
+#define CLIENTS 64
+
+/* Canaux de la seconde mesure */
+#define CHANNELS 8
+
+/* Lignes envoyées par client et par tour */
+#define LINES_PER_ROUND 16
+
+/* Tours mesurés par configuration */
+#define ROUNDS 60
+
+/* Attente maximale d'une réponse, en millisecondes */
+#define REPLY_TIMEOUT_MS 5000
+
+/* Connexion d'un client du générateur */
+struct BenchConnection
+{
+    int fd;
+    std::string pending;
+    unsigned long lines;
+};
+
+/* Lance ./ircserv sur `port` avec `options`, sorties jetées ; retourne son pid */
+static pid_t startServer(int port, const std::vector<std::string> &options)
+{
+    std::ostringstream portText;
+    portText << port;
+
+    std::vector<std::string> args;
+    args.push_back("./ircserv");
+    args.push_back(portText.str());
+    args.push_back("bench");
+    args.insert(args.end(), options.begin(), options.end());
+
+    pid_t pid = fork();
+    if (pid != 0)
+        return pid;
+
+    int null = open("/dev/null", O_WRONLY);
+    dup2(null, STDOUT_FILENO);
+    dup2(null, STDERR_FILENO);
+    std::vector<char *> argv;
+    for (size_t i = 0; i < args.size(); ++i)
+        argv.push_back(const_cast<char *>(args[i].c_str()));
+    argv.push_back(NULL);
+    execv(argv[0], &argv[0]);
+    _exit(127);
+}
+
+/* Ouvre une connexion, en réessayant le temps que le serveur écoute ; -1 en cas d'échec */
+static int connectTo(int port)
+{
+    struct sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = inet_addr("127.0.0.1");
+
+    for (int attempt = 0; attempt < 200; ++attempt)
+    {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0)
+            return -1;
+        if (connect(fd, reinterpret_cast<struct sockaddr *>(&address), sizeof(address)) == 0)
+        {
+            fcntl(fd, F_SETFL, O_NONBLOCK);
+            return fd;
+        }
+        close(fd);
+        usleep(10000);
+    }
+    return -1;
+}
+
+/* Envoie tout `data`, en attendant que le socket accepte la suite */
+static bool sendAll(int fd, const std::string &data)
+{
+    size_t sent = 0;
+    while (sent < data.size())
+    {
+        ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n > 0)
+        {
+            sent += static_cast<size_t>(n);
+            continue;
+        }
+        if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+            return false;
+        struct pollfd writable = { fd, POLLOUT, 0 };
+        poll(&writable, 1, REPLY_TIMEOUT_MS);
+    }
+    return true;
+}
+
+/* Lit ce qui est disponible sur chaque connexion et compte les lignes reçues */
+static void readAvailable(std::vector<BenchConnection> &connections, int timeoutMs)
+{
+    std::vector<struct pollfd> fds(connections.size());
+    for (size_t i = 0; i < connections.size(); ++i)
+    {
+        fds[i].fd = connections[i].fd;
+        fds[i].events = POLLIN;
+        fds[i].revents = 0;
+    }
+    if (poll(&fds[0], fds.size(), timeoutMs) <= 0)
+        return;
+
+    char buffer[65536];
+    for (size_t i = 0; i < connections.size(); ++i)
+    {
+        if (!(fds[i].revents & POLLIN))
+            continue;
+        ssize_t n;
+        while ((n = recv(connections[i].fd, buffer, sizeof(buffer), 0)) > 0)
+        {
+            for (const char *p = buffer; (p = static_cast<const char *>(std::memchr(p, '\n', buffer + n - p))) != NULL; ++p)
+                ++connections[i].lines;
+            connections[i].pending.append(buffer, n);
+            if (connections[i].pending.size() > 4096)
+                connections[i].pending.erase(0, connections[i].pending.size() - 4096);
+        }
+    }
+}
+
+/* Attend que chaque connexion ait reçu une ligne contenant `marker` ; false au-delà du délai */
+static bool waitForMarker(std::vector<BenchConnection> &connections, const char *marker)
+{
+    uint64_t deadline = benchNowNs() + static_cast<uint64_t>(REPLY_TIMEOUT_MS) * 1000000ULL;
+    while (benchNowNs() < deadline)
+    {
+        bool all = true;
+        for (size_t i = 0; i < connections.size() && all; ++i)
+            all = connections[i].pending.find(marker) != std::string::npos;
+        if (all)
+            return true;
+        readAvailable(connections, 10);
+    }
+    return false;
+}
+
+/* Lit jusqu'à ce que le serveur se taise 100 ms, puis remet les compteurs à zéro */
+static void drain(std::vector<BenchConnection> &connections)
+{
+    while (true)
+    {
+        unsigned long before = 0;
+        for (size_t i = 0; i < connections.size(); ++i)
+            before += connections[i].lines;
+        readAvailable(connections, 100);
+        unsigned long after = 0;
+        for (size_t i = 0; i < connections.size(); ++i)
+            after += connections[i].lines;
+        if (after == before)
+            break;
+    }
+    for (size_t i = 0; i < connections.size(); ++i)
+    {
+        connections[i].lines = 0;
+        connections[i].pending.clear();
+    }
+}
+
+/**
+ * Tours fermés : chaque client envoie ses lignes, puis le tour attend que
+ * chaque connexion ait reçu les `expected` livraisons qui lui reviennent.
+ * @return les lignes livrées par seconde, 0 si une livraison manque
+ */
+static double measure(std::vector<BenchConnection> &connections, const std::vector<std::string> &bursts,
+                      unsigned long expected)
+{
+    uint64_t start = benchNowNs();
+    for (int round = 0; round < ROUNDS; ++round)
+    {
+        for (size_t i = 0; i < connections.size(); ++i)
+        {
+            if (!sendAll(connections[i].fd, bursts[i]))
+                return 0;
+        }
+
+        uint64_t deadline = benchNowNs() + static_cast<uint64_t>(REPLY_TIMEOUT_MS) * 1000000ULL;
+        while (true)
+        {
+            bool complete = true;
+            for (size_t i = 0; i < connections.size() && complete; ++i)
+                complete = connections[i].lines >= expected * (round + 1);
+            if (complete)
+                break;
+            if (benchNowNs() > deadline)
+                return 0;
+            readAvailable(connections, 10);
+        }
+    }
+    uint64_t elapsed = benchNowNs() - start;
+
+    unsigned long delivered = 0;
+    for (size_t i = 0; i < connections.size(); ++i)
+        delivered += connections[i].lines;
+    return static_cast<double>(delivered) * 1e9 / static_cast<double>(elapsed);
+}
+
+/* Nom du client `i` */
+static std::string nickOf(size_t i)
+{
+    std::ostringstream nick;
+    nick << "b" << i;
+    return nick.str();
+}
+
+/**
+ * Mesure une configuration du serveur : enregistrement, débit vers des
+ * pseudonymes, puis débit de canal.
+ * @return false si le serveur n'a pas pu être joint
+ */
+static bool runConfiguration(int port, const std::vector<std::string> &options, double &privateRate, double &channelRate)
+{
+    pid_t server = startServer(port, options);
+    std::vector<BenchConnection> connections;
+    bool ok = true;
+
+    for (size_t i = 0; i < CLIENTS && ok; ++i)
+    {
+        BenchConnection connection;
+        connection.fd = connectTo(port);
+        connection.lines = 0;
+        ok = connection.fd >= 0;
+        if (ok)
+        {
+            connections.push_back(connection);
+            ok = sendAll(connection.fd, "PASS bench\r\nNICK " + nickOf(i) + "\r\nUSER " + nickOf(i) + " 0 * :bench\r\n");
+        }
+    }
+    ok = ok && waitForMarker(connections, " 376 ");
+    drain(connections);
+
+    /* Chaque client écrit au client d'en face */
+    std::vector<std::string> bursts(connections.size());
+    for (size_t i = 0; i < connections.size() && ok; ++i)
+    {
+        for (int n = 0; n < LINES_PER_ROUND; ++n)
+            bursts[i] += "PRIVMSG " + nickOf((i + CLIENTS / 2) % CLIENTS) + " :scaling benchmark line\r\n";
+    }
+    privateRate = ok ? measure(connections, bursts, LINES_PER_ROUND) : 0;
+    drain(connections);
+
+    /* Puis à son canal, dont les CLIENTS / CHANNELS - 1 autres membres reçoivent la ligne */
+    for (size_t i = 0; i < connections.size() && ok; ++i)
+    {
+        std::ostringstream channel;
+        channel << "#scale" << i % CHANNELS;
+        ok = sendAll(connections[i].fd, "JOIN " + channel.str() + "\r\n");
+        bursts[i].clear();
+        for (int n = 0; n < LINES_PER_ROUND; ++n)
+            bursts[i] += "PRIVMSG " + channel.str() + " :scaling benchmark line\r\n";
+    }
+    ok = ok && waitForMarker(connections, " 366 ");
+    drain(connections);
+    channelRate = ok ? measure(connections, bursts, LINES_PER_ROUND * (CLIENTS / CHANNELS - 1)) : 0;
+
+    for (size_t i = 0; i < connections.size(); ++i)
+        close(connections[i].fd);
+    kill(server, SIGKILL);
+    waitpid(server, NULL, 0);
+    return ok;
+}
+
+int main()
+{
+    int port = 20000 + static_cast<int>(getpid() % 20000);
+    const int counts[] = { 1, 2, 4, 8 };
+    const char *series[] = { "--reactors=", "--shards=" };
+
+    std::cout << "== Débit de PRIVMSG, " << CLIENTS << " clients, " << LINES_PER_ROUND << " lignes x "
+              << ROUNDS << " tours (processeurs en ligne : " << sysconf(_SC_NPROCESSORS_ONLN) << ")" << std::endl;
+    std::cout << std::setw(16) << "options" << std::setw(20) << "pseudonyme l/s" << std::setw(20) << "canal l/s" << std::endl;
+
+    for (size_t s = 0; s < sizeof(series) / sizeof(series[0]); ++s)
+    {
+        for (size_t i = 0; i < sizeof(counts) / sizeof(counts[0]); ++i)
+        {
+            std::ostringstream option;
+            option << series[s] << counts[i];
+            std::vector<std::string> options(1, option.str());
+
+            double privateRate = 0;
+            double channelRate = 0;
+            bool ok = runConfiguration(port++, options, privateRate, channelRate);
+            std::cout << std::setw(16) << option.str() << std::fixed << std::setprecision(0)
+                      << std::setw(20) << privateRate << std::setw(20) << channelRate
+                      << (ok ? "" : "  échec : serveur injoignable ou livraison manquante") << std::endl;
+        }
+    }
+    return 0;
+}
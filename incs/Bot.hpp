@@ -22,15 +22,17 @@
 /* For std::map */
 #include <map>
 
-/* For std::set */
-#include <set>
+/* For IrcMessage */
+#include "IrcMessage.hpp"
 
-/* For std::istringstream */
-#include <sstream>
+/* For RuleSet */
+#include "RuleSet.hpp"
 
+/* For pthread_rwlock_t */
+#include <pthread.h>
 
-/* For send() */
-#include <sys/socket.h>
+/* Déclaration anticipée de Server */
+class Server;
 
 /* Déclaration anticipée de Client */
 class Client;
@@ -45,8 +47,8 @@ class Bot
 {
     public:
 
-        /* Constructeur */
-        Bot();
+        /* Constructeur, le serveur sert à envoyer les sanctions */
+        Bot(Server &server);
 
         /* Destructeur */
         ~Bot();
@@ -55,8 +57,8 @@ class Bot
         /*                                   MESSAGES                                */
         /*   -'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-',-'   */
 
-        /* Traite un message */
-        void handleMessage(Client *client, Channel *channel, const std::string &message);
+        /* Traite un message déjà analysé, dont le premier paramètre est le canal */
+        void handleMessage(Client *client, Channel *channel, const IrcMessage &message);
 
 
         /*   -'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-',-'   */
@@ -69,17 +71,55 @@ class Bot
         /* Exclut un client */
         void kickClient(Client *client, Channel *channel);
 
+
+        /*   -'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-',-'   */
+        /*                                  RÈGLES                                   */
+        /*   -'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-',-'   */
+
+        /* Charge le fichier de règles au démarrage, retourne false avec `error` renseigné */
+        bool loadRules(const std::string &path, std::string &error);
+
+        /* Lance la compilation du fichier de règles dans un thread, false si elle est déjà en cours */
+        bool requestReload();
+
+        /* Installe les règles compilées par le thread, appelé par la boucle d'événements */
+        void applyPendingRules();
+
+        /* Retourne le chemin du fichier de règles, vide pour les règles par défaut */
+        const std::string &getRulesPath() const;
+
     private:
     
         /*   -'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-',-'   */
         /*                              DONNÉES INTERNES                             */
         /*   -'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-',-'   */
 
-        /* Mots interdits */
-        std::set<std::string> _forbiddenWords;
+        /* Serveur propriétaire, qui achemine les messages du bot */
+        Server &_server;
+
+        /* Règles en vigueur, lues par les boucles et les shards sous _rulesLock */
+        RuleSet *_rules;
+
+        /* Lecteurs : les messages de canal ; écrivain : l'installation d'un nouveau jeu */
+        pthread_rwlock_t _rulesLock;
+
+        /* Règles compilées par le thread de rechargement, en attente d'installation */
+        RuleSet *volatile _pendingRules;
+
+        /* 1 tant qu'un rechargement est en cours */
+        volatile int _reloading;
+
+        /* Fichier de règles, vide pour les règles par défaut */
+        std::string _rulesPath;
+
+        /* Corps du thread de rechargement : compile le fichier et publie le résultat */
+        static void *compileRules(void *bot);
+
+        /* Avertissements, par numéro de série du client : une adresse réutilisée n'en hérite pas */
+        std::map<unsigned long, int> _warnings;
 
-        /* Avertissements */
-        std::map<Client*, int> _warnings;
+        /* Protège _warnings, mis à jour par les shards de canaux différents */
+        pthread_mutex_t _warningsLock;
 };
 
 #endif /* BOT_HPP */
\ No newline at end of file
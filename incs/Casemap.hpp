@@ -0,0 +1,49 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   Casemap.hpp                                        :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: raveriss <raveriss@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/11/22 14:15:09 by raveriss          #+#    #+#             */
+/*   Updated: 2024/11/22 14:15:09 by raveriss         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef CASEMAP_HPP
+#define CASEMAP_HPP
+
+/* For std::string */
+#include <string>
+
+/* Correspondance de casse annoncée dans RPL_ISUPPORT */
+#define CASEMAPPING_NAME "rfc1459"
+
+/**
+ * class Casemap
+ *
+ * Repli de casse rfc1459 : A-Z deviennent a-z et, les caractères
+ * scandinaves de l'ASCII d'origine étant ambigus, []\~ sont les
+ * majuscules de {}|^. Le repli passe par une table de 256 octets,
+ * sans branche par caractère.
+ */
+class Casemap
+{
+    public:
+
+        /* Retourne la forme repliée d'un nom */
+        static std::string fold(const std::string &name);
+
+        /* Retourne true si deux noms sont égaux une fois repliés */
+        static bool equals(const std::string &a, const std::string &b);
+
+        /* Empreinte FNV-1a d'un nom replié, calculée sans copie */
+        static unsigned int hash(const char *data, size_t length);
+
+    private:
+
+        /* Table de repli, indexée par octet */
+        static const unsigned char _table[256];
+};
+
+#endif /* CASEMAP_HPP */
@@ -31,6 +31,22 @@
 /* For td::cout */
 #include <iostream>
 
+/* For HashMap */
+#include "HashMap.hpp"
+
+/* For FanoutTarget */
+#include "FanoutEngine.hpp"
+
+/* Statut d'un membre, combinable */
+#define MEMBER_OPERATOR 0x1
+#define MEMBER_VOICE 0x2
+
+/* Modes de canal, un bit par mode */
+#define CHANNEL_MODE_INVITE 0x1
+#define CHANNEL_MODE_TOPIC 0x2
+#define CHANNEL_MODE_KEY 0x4
+#define CHANNEL_MODE_LIMIT 0x8
+
 /* Déclaration anticipée de Client */
 class Client;
 
@@ -50,6 +66,9 @@ class Channel
         /* Retourne le nom du canal */
         const std::string &getName() const;
 
+        /* Retourne le nom replié selon rfc1459, clé de l'index des canaux */
+        const std::string &getFoldedName() const;
+
 
         /*   -'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-',-'   */
         /*                                   CLIENT                                  */
@@ -64,9 +83,30 @@ class Channel
         /* Retourne true si le client est dans le canal, false sinon */
         bool hasClient(Client *client) const;
 
-        /* Retourne la liste des clients du canal */
+        /* Retourne la liste dense des clients du canal, parcourue par les diffusions */
         const std::vector<Client*> &getClients() const;
 
+        /* Retourne les destinataires des membres, dans l'ordre de getClients() */
+        const std::vector<FanoutTarget> &getFanoutTargets() const;
+
+        /* Retourne le plan de diffusion des membres, réparti par travailleur puis par boucle, construit au besoin */
+        FanoutPlan *getFanoutPlan(const FanoutEngine &engine);
+
+        /* Retourne le compteur des blocs que les boucles n'ont pas encore traités */
+        FanoutDrain *getFanoutDrain() const;
+
+        /* Retourne true si les diffusions du canal passent par les travailleurs */
+        bool usesParallelFanout() const;
+
+        /* Fait passer les diffusions du canal par les travailleurs */
+        void enableParallelFanout();
+
+        /* Revient à l'envoi direct si tous les blocs des travailleurs ont été traités, retourne true si c'est le cas */
+        bool disableParallelFanout();
+
+        /* Retourne le statut du client (MEMBER_OPERATOR, MEMBER_VOICE), 0 s'il n'est pas membre */
+        unsigned int getMemberFlags(Client *client) const;
+
 
         /*   -'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-',-'   */
         /*                                    MODE                                   */
@@ -81,6 +121,12 @@ class Channel
         /* Retourne true si le canal a le mode, false sinon */
         bool hasMode(char mode) const;
 
+        /* Retourne les modes actifs sous la forme "+itkl" */
+        const std::string &getModeString() const;
+
+        /* Retourne les paramètres des modes actifs sous la forme " clé limite" */
+        const std::string &getModeParams() const;
+
 
         /*   -'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-',-'   */
         /*                                    KEY                                    */
@@ -169,11 +215,43 @@ class Channel
         /* Nom du canal */
         std::string _name;
 
-        /* Liste des clients du canal */
+        /* Nom replié, calculé à la création du canal */
+        std::string _foldedName;
+
+        /**
+         * Adhésion d'un client : son statut et sa position dans _clients,
+         * pour retirer un membre en temps constant.
+         */
+        struct Membership
+        {
+            unsigned int flags;
+            size_t index;
+        };
+
+        /* Membres du canal et leur statut, une seule recherche par client */
+        HashMap<Client*, Membership, PointerHash> _members;
+
+        /* Clients du canal, contigus pour les boucles de diffusion */
         std::vector<Client*> _clients;
 
-        /* Modes du canal */
-        std::set<char> _modes;
+        /* Fd, numéro de série et boucle de chaque membre, copiés d'un bloc pour les travailleurs */
+        std::vector<FanoutTarget> _fanoutTargets;
+
+        /* Plan réutilisé par les diffusions tant que les membres ne changent pas, NULL à reconstruire */
+        FanoutPlan *_fanoutPlan;
+
+        /* Blocs en vol vers les boucles, créé au passage aux travailleurs */
+        FanoutDrain *_fanoutDrain;
+
+        /* true une fois le seuil de diffusion parallèle franchi, jusqu'au retour à l'envoi direct */
+        bool _parallelFanout;
+
+        /* Modes du canal (CHANNEL_MODE_*) */
+        unsigned int _modes;
+
+        /* Modes et paramètres mis en forme, régénérés à chaque changement de mode */
+        std::string _modeString;
+        std::string _modeParams;
 
         /* Clé du canal (mode 'k') */
         std::string _key;
@@ -181,11 +259,11 @@ class Channel
         /* Limite d'utilisateurs (mode 'l') */
         int _userLimit;
 
-        /* Liste des opérateurs */
-        std::set<Client*> _operators;
-
-        /* Liste des clients invités */
-        std::set<Client*> _invitedClients;
+        /**
+         * Clients invités, par numéro de série : l'adresse d'un client détruit
+         * est réutilisée par les slabs, son numéro de série jamais.
+         */
+        std::set<unsigned long> _invitedClients;
 
         /* Sujet du canal */
         std::string _topic;
@@ -193,8 +271,14 @@ class Channel
         /* true si un sujet est défini, false sinon */
         bool _hasTopic;
 
-        /* Ensemble des clients avec le statut de voix */
-        std::set<Client*> _voicedClients;
+        /* Retourne le bit du mode, 0 si le mode n'est pas géré */
+        static unsigned int modeBit(char mode);
+
+        /* Régénère _modeString et _modeParams */
+        void updateModeString();
+
+        /* Oublie le plan de diffusion, à reconstruire à la prochaine diffusion */
+        void dropFanoutPlan();
 
 };
 
@@ -0,0 +1,125 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   ChannelShard.hpp                                   :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: raveriss <raveriss@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/11/26 14:52:13 by raveriss          #+#    #+#             */
+/*   Updated: 2024/11/26 14:52:13 by raveriss         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef CHANNELSHARD_HPP
+#define CHANNELSHARD_HPP
+
+/* For std::string */
+#include <string>
+
+/* For std::vector */
+#include <vector>
+
+/* For pthread_t */
+#include <pthread.h>
+
+/* For Client */
+#include "Client.hpp"
+
+/* For MpscQueue */
+#include "MpscQueue.hpp"
+
+/* For ReactorLoop */
+#include "ReactorLoop.hpp"
+
+/* For ReplyOutbox */
+#include "ReplyOutbox.hpp"
+
+/* Cases de la file d'entrée d'un shard */
+#define CHANNELSHARD_QUEUE_SIZE 4096
+
+/* Commandes exécutées au plus par prise du verrou du shard */
+#define CHANNELSHARD_BATCH 64
+
+/* Déclaration anticipée de Server */
+class Server;
+
+/**
+ * Commande confiée à un shard : la ligne reçue, copiée, et le client qui
+ * l'a envoyée. Le client n'est pas détruit tant que ses commandes confiées
+ * n'ont pas été exécutées, même s'il a été retiré entre-temps.
+ */
+struct ShardTask
+{
+    ShardTask();
+
+    Client *client;
+    std::string line;
+};
+
+/**
+ * class ChannelShard
+ *
+ * Thread propriétaire d'une partie des canaux. Les boucles d'événements lui
+ * confient les commandes de ses canaux par une file sans verrou ; il les
+ * exécute dans l'ordre d'arrivée, ce qui préserve l'ordre des messages de
+ * chaque canal. Ses canaux sont protégés par son propre verrou, que les
+ * autres shards ne prennent jamais. Les réponses produites sont regroupées
+ * par boucle destinataire et déposées une fois ce verrou rendu.
+ */
+class ChannelShard
+{
+    public:
+
+        /* Constructeur, sans thread ni tube */
+        ChannelShard(Server &server, size_t index, size_t loopCount);
+
+        /* Ferme le tube de réveil */
+        ~ChannelShard();
+
+        /* Crée le tube de réveil */
+        bool openWakePipe();
+
+        /* Confie une commande au shard, depuis n'importe quel thread ; attend si la file est pleine */
+        void push(const ShardTask &task);
+
+        /* Retire la commande de tête, false si la file est vide */
+        bool pop(ShardTask &task);
+
+        /* Bloque jusqu'à ce qu'une commande soit disponible */
+        void waitForTasks();
+
+        /* Serveur propriétaire */
+        Server &server;
+
+        /* Rang du shard */
+        size_t index;
+
+        /* Thread du shard */
+        pthread_t thread;
+
+        /* Processeur sur lequel le shard s'épingle, -1 pour aucun */
+        int cpu;
+
+        /* Verrou des canaux du shard : pris par lui pour chaque lot, et par une boucle qui touche ses canaux */
+        pthread_mutex_t lock;
+
+        /* Réponses produites par le shard, déposées une fois son verrou rendu */
+        ReplyOutbox outbox;
+
+    private:
+
+        /* Non copiable */
+        ChannelShard(const ChannelShard &);
+        ChannelShard &operator=(const ChannelShard &);
+
+        /* Commandes confiées par les boucles */
+        MpscQueue<ShardTask> _queue;
+
+        /* Tube de réveil : [0] lu par le shard endormi, [1] écrit par les boucles */
+        int _wakePipe[2];
+
+        /* 1 quand le shard dort sur le tube et attend un octet */
+        volatile int _sleeping;
+};
+
+#endif /* CHANNELSHARD_HPP */
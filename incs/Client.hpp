@@ -25,9 +25,36 @@
 /* For time_t */
 #include <ctime>
 
+/* For std::deque */
+#include <deque>
+
+/* For struct iovec */
+#include <sys/uio.h>
+
+/* For std::vector, std::pair */
+#include <vector>
+
+/* For pthread_mutex_t */
+#include <pthread.h>
+
+/* For LineFramer */
+#include "LineFramer.hpp"
+
+/* For SharedPayload */
+#include "SharedPayload.hpp"
+
+/* For TimerNode */
+#include "TimerWheel.hpp"
+
+/* Taille des blocs de la file d'envoi dans lesquels les réponses sont regroupées */
+#define OUTPUT_BLOCK_SIZE 4096
+
 /* Déclaration anticipée de Channel */
 class Channel;
 
+/* Déclaration anticipée de ReactorLoop */
+class ReactorLoop;
+
 /**
  * class Client
  */
@@ -44,6 +71,15 @@ class Client
         /* Retourne le socket du client */
         int getSocket() const;
 
+        /* Retourne le numéro de série du client, unique pour toute la vie du serveur */
+        unsigned long getSerial() const;
+
+        /* Retourne la boucle d'événements qui possède le client */
+        ReactorLoop *getLoop() const;
+
+        /* Définit la boucle d'événements qui possède le client */
+        void setLoop(ReactorLoop *loop);
+
 
         /*   -'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-',-'   */
         /*                              ENREGISTREMENT                               */
@@ -90,8 +126,62 @@ class Client
         /* Définit l'état opérateur du client */
         void setOperator(bool status);
 
-        /* Méthode pour mettre à jour l'heure de dernière activité */
-        void updateLastActivity();
+        /* Met à jour l'heure de dernière activité, `now` venant de l'horloge monotone du serveur */
+        void updateLastActivity(time_t now);
+
+        /* Retourne l'heure de dernière activité (horloge monotone, en secondes) */
+        time_t getLastActivityTime() const;
+
+        /* Retourne true si le client a été retiré et attend sa suppression */
+        bool isClosing() const;
+
+        /* Marque le client comme retiré du serveur */
+        void setClosing(bool status);
+
+        /* Retourne true si le fil d'état a demandé sa fermeture à la boucle propriétaire */
+        bool isCloseRequested() const;
+
+        /* Marque la fermeture du client comme demandée à sa boucle */
+        void setCloseRequested(bool status);
+
+        /* Compte une commande confiée à un shard ou au fil d'état, depuis la boucle propriétaire */
+        void addQueuedCommand();
+
+        /* Décompte une commande exécutée, depuis son thread ; retourne true s'il doit reprendre le client suspendu */
+        bool finishQueuedCommand();
+
+        /* Retourne le nombre de commandes confiées à d'autres threads et pas encore exécutées */
+        int queuedCommands();
+
+        /* Demande la reprise par le dernier décompte ; false si les commandes confiées sont déjà exécutées */
+        bool awaitQueuedCommands();
+
+        /* Suspend la lecture sur `line`, avec la suite du bloc reçu et les lignes trop longues qui la suivent */
+        void park(const std::string &line, const char *rest, size_t restLength, size_t overflow);
+
+        /* Retourne true si une ligne attend que les shards aient exécuté les commandes qui la précèdent */
+        bool isParked() const;
+
+        /* Rend la ligne suspendue, la suite du bloc reçu et les lignes trop longues, et lève la suspension */
+        void unpark(std::string &line, std::string &rest, size_t &overflow);
+
+        /* Retourne true si des réponses des shards ont pu être déposées sans être encore livrées */
+        bool isShardRouted() const;
+
+        /* Marque le client comme ayant confié des commandes aux shards depuis la dernière attente */
+        void setShardRouted(bool status);
+
+        /* Retourne true si des données restent à lire après épuisement du budget de lecture */
+        bool isReadPending() const;
+
+        /* Définit si le client attend un nouveau tour de lecture */
+        void setReadPending(bool status);
+
+        /* Retourne true si la connexion a été fermée en lecture, sa fermeture publiée au fil d'état */
+        bool isInputClosed() const;
+
+        /* Marque la connexion comme fermée en lecture : la boucle ne la lit plus */
+        void setInputClosed(bool status);
 
 
         /*   -'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-',-'   */
@@ -104,6 +194,9 @@ class Client
         /* Définit le pseudonyme du client */
         void setNickname(const std::string &nickname);
 
+        /* Retourne le pseudonyme replié selon rfc1459, clé de l'index des pseudonymes */
+        const std::string &getFoldedNickname() const;
+
         /* Retourne le nom d'utilisateur du client */
         const std::string &getUsername() const;
 
@@ -116,6 +209,9 @@ class Client
         /* Définit le nom d'hôte du client */
         void setHostname(const std::string &hostname);
 
+        /* Retourne le préfixe ":nick!user@host" des messages émis par le client */
+        const std::string &getPrefix() const;
+
         /* Retourne le nom du serveur du client */
         const std::string &getServername() const;
 
@@ -136,14 +232,17 @@ class Client
         /* Ajoute un canal à la liste */
         void joinChannel(Channel *channel);
 
-        /* Retire un canal de la liste des canaux du client */
-        void leaveChannel(Channel *channel);
+        /* Retire un canal de la liste des canaux du client, retourne false s'il n'y était plus */
+        bool leaveChannel(Channel *channel);
 
         /* Retourne true si le client est dans le canal, false sinon */
         bool isInChannel(const std::string &channelName) const;
 
-        /* Retourne la liste des canaux du client */
-        const std::set<Channel*> &getChannels() const;
+        /* Retourne une copie de la liste des canaux du client */
+        std::set<Channel*> getChannels() const;
+
+        /* Copie les canaux du client avec leur nom replié, qui désigne le verrou de chacun */
+        void copyChannels(std::vector<std::pair<Channel*, std::string> > &channels) const;
 
 
         /*   -'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-',-'   */
@@ -156,18 +255,84 @@ class Client
         /* Retourne le temps du dernier pong */
         time_t getLastPongTime() const;
 
-        /* Getter pour le tampon de messages partiels */
-        std::string & getMessageBuffer();
+        /* Getter pour le découpage en lignes des données reçues */
+        LineFramer & getFramer();
 
         /* Indique si le client a reçu un PING */
         bool isPingReceived() const;
 
 
+        /*   -'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-',-'   */
+        /*                                 KEEPALIVE                                 */
+        /*   -'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-',-'   */
+
+        /* Echéance surveillée par le minuteur du client */
+        enum KeepaliveState
+        {
+            KEEPALIVE_REGISTRATION,
+            KEEPALIVE_IDLE,
+            KEEPALIVE_AWAITING_PONG
+        };
+
+        /* Retourne l'échéance en cours */
+        KeepaliveState getKeepaliveState() const;
+
+        /* Définit l'échéance en cours */
+        void setKeepaliveState(KeepaliveState state);
+
+        /* Retourne le minuteur du client, armé dans la roue du serveur */
+        TimerNode &getKeepaliveTimer();
+
+
+        /*   -'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-',-'   */
+        /*                               FILE D'ENVOI                                */
+        /*   -'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-',-'   */
+
+        /* Ajoute un message partagé à la file d'envoi du client, sans le copier */
+        void queueOutput(const SharedPayload &payload);
+
+        /* Copie une réponse en fin de file, dans le dernier bloc s'il a la place */
+        void queueOutput(const char *data, size_t length);
+
+        /* Retourne true s'il reste des données à envoyer */
+        bool hasPendingOutput() const;
+
+        /* Retourne le nombre d'octets en attente d'envoi */
+        size_t getPendingOutputSize() const;
+
+        /* Décrit les blocs en attente dans un tableau d'iovec pour writev(), retourne leur nombre */
+        size_t fillOutputVector(struct iovec *iov, size_t maxIov) const;
+
+        /* Retire de la file les octets effectivement envoyés */
+        void consumeOutput(size_t bytes);
+
+        /* Vide la file d'envoi */
+        void clearOutput();
+
+        /* Retourne true si le socket est surveillé en écriture */
+        bool isWriteArmed() const;
+
+        /* Définit si le socket est surveillé en écriture */
+        void setWriteArmed(bool status);
+
+        /* Retourne true si le client attend l'envoi groupé de fin d'itération */
+        bool isFlushScheduled() const;
+
+        /* Définit si le client attend l'envoi groupé de fin d'itération */
+        void setFlushScheduled(bool status);
+
+
     private:
 
         /* Socket du client */
         int _socket;
 
+        /* Numéro de série, distingue deux clients ayant eu le même fd */
+        unsigned long _serial;
+
+        /* Boucle propriétaire : seule elle lit le socket et écrit la file d'envoi */
+        ReactorLoop *_loop;
+
 
         /*   -'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-',-'   */
         /*                           CLIENT IDENTIFICATION                           */
@@ -176,20 +341,26 @@ class Client
         /* Pseudonyme */
         std::string _nickname;
 
+        /* Pseudonyme replié, calculé une fois par changement de pseudonyme */
+        std::string _foldedNickname;
+
         /* Username */
         std::string _username;
 
         /* Hostname */
         std::string _hostname;
 
+        /* Préfixe ":nick!user@host", reconstruit quand l'une de ses parties change */
+        std::string _prefix;
+
         /* Server name */
         std::string _servername;
 
         /* Real name */
         std::string _realname;
 
-        /* Tampon pour stocker les messages partiels */
-        std::string _messageBuffer;
+        /* Anneau de réception, découpe les messages partiels en lignes */
+        LineFramer _framer;
 
 
         /*   -'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-',-'   */
@@ -214,6 +385,36 @@ class Client
         /* Indique si le client est opérateur */
         bool _isOperator;
 
+        /* Indique si le client a été retiré et attend sa suppression différée ; lu par les autres threads */
+        volatile bool _closing;
+
+        /* Indique si la fermeture a été demandée à la boucle propriétaire, pas encore exécutée */
+        volatile bool _closeRequested;
+
+        /* Commandes confiées aux shards ou au fil d'état, pas encore exécutées : le client n'est pas détruit avant */
+        volatile int _queuedCommands;
+
+        /* Commandes confiées aux shards depuis la dernière attente de la boucle ; lu par elle seule */
+        bool _shardRouted;
+
+        /* Indique si la lecture est suspendue derrière les commandes confiées aux shards */
+        bool _parked;
+
+        /* Ligne suspendue, exécutée sur place à la reprise */
+        std::string _parkedLine;
+
+        /* Suite du bloc reçu après la ligne suspendue, pas encore découpée */
+        std::string _parkedInput;
+
+        /* Lignes trop longues reçues après la ligne suspendue, signalées à la reprise */
+        size_t _parkedOverflow;
+
+        /* Indique si le client a épuisé son budget de lecture avant EAGAIN */
+        bool _readPending;
+
+        /* Indique si la fin de flux a été lue, la fermeture attendant les commandes publiées avant */
+        bool _inputClosed;
+
 
         /*   -'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-',-'   */
         /*                              CLIENT CHANNELS                              */
@@ -222,6 +423,9 @@ class Client
         /* Liste des canaux du client */
         std::set<Channel*> _channels;
 
+        /* Protège _channels, modifiée par le propriétaire de chaque canal */
+        mutable pthread_mutex_t _channelsLock;
+
 
         /*   -'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-',-'   */
         /*                             CLIENT PING STATUS                            */
@@ -236,7 +440,34 @@ class Client
         /* Indique si le client a reçu un PING */
         bool pingReceived;
 
+        /* Echéance surveillée par _keepaliveTimer */
+        KeepaliveState _keepaliveState;
+
+        /* Minuteur d'enregistrement, de PING et de PONG */
+        TimerNode _keepaliveTimer;
+
+
+        /*   -'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-',-'   */
+        /*                               FILE D'ENVOI                                */
+        /*   -'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-',-'   */
+
+        /* Messages en attente, dans l'ordre d'émission, partagés avec les autres destinataires */
+        std::deque<SharedPayload> _outQueue;
+
+        /* Octets du premier bloc déjà envoyés */
+        size_t _outOffset;
+
+        /* Nombre total d'octets en attente */
+        size_t _outPending;
+
+        /* Indique si le socket est surveillé en écriture par la boucle d'événements */
+        bool _writeArmed;
+
+        /* Indique si le client est déjà dans la liste des envois de fin d'itération */
+        bool _flushScheduled;
 
+        /* Reconstruit _prefix à partir du pseudonyme, du username et de l'hôte */
+        void updatePrefix();
 };
 
 #endif /* CLIENT_HPP */
@@ -0,0 +1,130 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   CommandPipeline.hpp                                :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: raveriss <raveriss@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/11/27 11:38:02 by raveriss          #+#    #+#             */
+/*   Updated: 2024/11/27 11:38:02 by raveriss         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef COMMANDPIPELINE_HPP
+#define COMMANDPIPELINE_HPP
+
+/* For pthread_t */
+#include <pthread.h>
+
+/* For CommandEntry */
+#include "CommandTable.hpp"
+
+/* For DisruptorRing */
+#include "DisruptorRing.hpp"
+
+/* For IrcMessage */
+#include "IrcMessage.hpp"
+
+/* For IRC_LINE_MAX */
+#include "LineFramer.hpp"
+
+/* For Client */
+#include "Client.hpp"
+
+/* For ReplyOutbox */
+#include "ReplyOutbox.hpp"
+
+/* Cases de l'anneau de commandes */
+#define COMMANDPIPELINE_RING_SIZE 4096
+
+/* Commandes exécutées au plus avant de rendre les cases et de déposer les réponses */
+#define COMMANDPIPELINE_BATCH 256
+
+/**
+ * Commande analysée par une boucle d'événements, en place dans sa case :
+ * la ligne, la vue analysée qui pointe dans cette ligne et l'entrée de la
+ * table des commandes, résolue sans toucher à l'état partagé. Une case peut
+ * aussi signaler une ligne trop longue ou la fin de flux du client, traitées
+ * par le fil d'état à leur rang.
+ */
+struct CommandRecord
+{
+    enum Kind
+    {
+        COMMAND,
+        LINE_TOO_LONG,
+        END_OF_STREAM
+    };
+
+    CommandRecord();
+
+    Kind kind;
+    Client *client;
+    CommandEntry *entry;
+    bool valid;
+    char line[IRC_LINE_MAX];
+    IrcMessage message;
+};
+
+/**
+ * class CommandPipeline
+ *
+ * Mode pipeline : les boucles d'événements lisent, découpent et analysent
+ * les lignes, puis publient des CommandRecord dans un anneau disruptor ;
+ * un unique fil d'état les exécute dans l'ordre des séquences. Ses réponses
+ * repartent vers les boucles, seules à écrire sur les sockets.
+ */
+class CommandPipeline
+{
+    public:
+
+        /* Constructeur, sans thread ni tube */
+        explicit CommandPipeline(size_t loopCount);
+
+        /* Ferme le tube de réveil */
+        ~CommandPipeline();
+
+        /* Crée le tube de réveil */
+        bool openWakePipe();
+
+        /* Réserve une case ; boucles d'événements, sans verrou tenu */
+        CommandRecord &claim(size_t &sequence);
+
+        /* Publie une case remplie et réveille le fil d'état s'il dort */
+        void publish(size_t sequence);
+
+        /* Retourne la prochaine commande publiée, NULL s'il n'y en a pas ; fil d'état */
+        CommandRecord *next();
+
+        /* Rend aux boucles les cases lues ; fil d'état */
+        void release();
+
+        /* Bloque jusqu'à ce qu'une commande soit publiée ; fil d'état */
+        void waitForRecords();
+
+        /* Thread du fil d'état */
+        pthread_t thread;
+
+        /* Processeur sur lequel le fil d'état s'épingle, -1 pour aucun */
+        int cpu;
+
+        /* Réponses produites par le fil d'état, déposées une fois le lot exécuté */
+        ReplyOutbox outbox;
+
+    private:
+
+        /* Non copiable */
+        CommandPipeline(const CommandPipeline &);
+        CommandPipeline &operator=(const CommandPipeline &);
+
+        /* Commandes publiées par les boucles */
+        DisruptorRing<CommandRecord> _ring;
+
+        /* Tube de réveil : [0] lu par le fil d'état endormi, [1] écrit par les boucles */
+        int _wakePipe[2];
+
+        /* 1 quand le fil d'état dort sur le tube et attend un octet */
+        volatile int _sleeping;
+};
+
+#endif /* COMMANDPIPELINE_HPP */
@@ -0,0 +1,107 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   CommandTable.hpp                                   :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: raveriss <raveriss@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/11/21 18:06:44 by raveriss          #+#    #+#             */
+/*   Updated: 2024/11/21 18:06:44 by raveriss         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef COMMANDTABLE_HPP
+#define COMMANDTABLE_HPP
+
+/* For size_t */
+#include <cstddef>
+
+/* For IrcSlice */
+#include "IrcMessage.hpp"
+
+/* Nombre d'emplacements de la table, puissance de deux */
+#define COMMAND_TABLE_SIZE 64
+
+/* Déclaration anticipée de Server */
+class Server;
+
+/* Déclaration anticipée de Client */
+class Client;
+
+/* Gestionnaire d'une commande IRC */
+typedef void (Server::*CommandHandler)(Client *client, const IrcMessage &message);
+
+/**
+ * Entrée de la table de commandes
+ */
+struct CommandEntry
+{
+    /* Nom de la commande, en majuscules ; NULL pour un emplacement libre */
+    const char *name;
+
+    /* Empreinte du nom, calculée à l'enregistrement */
+    unsigned int hash;
+
+    /* Indique si la commande est réservée aux clients enregistrés */
+    bool needsRegistration;
+
+    /* Méthode du serveur qui traite la commande */
+    CommandHandler handler;
+
+    /* Indique si la commande vise un canal et s'exécute sur le shard de ce canal */
+    bool channelScoped;
+
+    /* Indique si une liste de canaux (#a,#b) se découpe en une commande par canal */
+    bool splitTargets;
+
+    /* Index du paramètre qui nomme le canal : 0, ou 1 pour INVITE <pseudo> <canal> */
+    size_t channelParam;
+
+    /* Nombre d'appels reçus, rapporté par STATS m ; incrémenté par toutes les boucles */
+    volatile unsigned long hits;
+};
+
+/**
+ * class CommandTable
+ *
+ * Table d'adressage ouvert indexée par l'empreinte FNV-1a du nom de la
+ * commande en majuscules. L'empreinte d'une commande reçue est calculée
+ * en une passe, sans copie ni conversion de la ligne ; une seule
+ * comparaison confirme ensuite l'entrée trouvée.
+ */
+class CommandTable
+{
+    public:
+
+        /* Constructeur */
+        CommandTable();
+
+        /* Enregistre une commande ; le nom doit être en majuscules */
+        void add(const char *name, bool needsRegistration, CommandHandler handler,
+                 bool channelScoped = false, bool splitTargets = false, size_t channelParam = 0);
+
+        /* Retourne l'entrée de la commande, NULL si elle est inconnue */
+        CommandEntry *find(const IrcSlice &command);
+
+        /* Retourne le nombre de commandes enregistrées */
+        size_t count() const;
+
+        /* Retourne une entrée, dans l'ordre d'enregistrement */
+        const CommandEntry &entry(size_t index) const;
+
+        /* Empreinte FNV-1a d'un nom, sans tenir compte de la casse */
+        static unsigned int hash(const char *data, size_t length);
+
+    private:
+
+        /* Emplacements de la table */
+        CommandEntry _entries[COMMAND_TABLE_SIZE];
+
+        /* Emplacements occupés, dans l'ordre d'enregistrement */
+        size_t _order[COMMAND_TABLE_SIZE];
+
+        /* Nombre de commandes enregistrées */
+        size_t _count;
+};
+
+#endif /* COMMANDTABLE_HPP */
@@ -0,0 +1,82 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   CpuTopology.hpp                                    :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: raveriss <raveriss@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/11/28 09:41:17 by raveriss          #+#    #+#             */
+/*   Updated: 2024/11/28 09:41:17 by raveriss         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef CPUTOPOLOGY_HPP
+#define CPUTOPOLOGY_HPP
+
+/* For std::string */
+#include <string>
+
+/* For std::vector */
+#include <vector>
+
+/**
+ * class CpuTopology
+ *
+ * Processeurs en ligne, processeurs permis au processus et nœud NUMA de
+ * chacun, lus au démarrage dans /sys. Sans /sys, toute la machine forme
+ * un seul nœud. Fournit aussi l'analyse des listes --*-cpus et l'épinglage
+ * du thread appelant.
+ */
+class CpuTopology
+{
+    public:
+
+        /* Constructeur, lit la topologie de la machine */
+        CpuTopology();
+
+        /* Analyse une liste de processeurs de la forme 0-3,6 */
+        static bool parseList(const std::string &text, std::vector<int> &cpus);
+
+        /* Écrit une liste de processeurs sous la forme 0-3,6 */
+        static std::string formatList(const std::vector<int> &cpus);
+
+        /* Processeur du thread de rang `index` : la liste est parcourue en boucle, -1 si elle est vide */
+        static int pick(const std::vector<int> &cpus, size_t index);
+
+        /* Épingle le thread appelant sur `cpu` */
+        static bool pinCurrentThread(int cpu);
+
+        /* Rend au thread appelant le masque d'affinité du processus au démarrage */
+        static bool unpinCurrentThread();
+
+        /* Retourne le nombre de processeurs en ligne */
+        size_t onlineCpus() const;
+
+        /* Retourne le nombre de nœuds NUMA */
+        size_t nodeCount() const;
+
+        /* Retourne le nœud NUMA de `cpu`, 0 s'il est inconnu */
+        int nodeOf(int cpu) const;
+
+        /* Retourne true si le processus peut tourner sur `cpu` */
+        bool isAllowed(int cpu) const;
+
+        /* Retourne les nœuds NUMA couverts par une liste de processeurs */
+        std::vector<int> nodesOf(const std::vector<int> &cpus) const;
+
+    private:
+
+        /* Processeurs en ligne */
+        size_t _online;
+
+        /* Nombre de nœuds NUMA, au moins 1 */
+        size_t _nodes;
+
+        /* Nœud de chaque processeur, indexé par numéro de processeur */
+        std::vector<int> _nodeOf;
+
+        /* Processeurs permis par le masque d'affinité du processus */
+        std::vector<bool> _allowed;
+};
+
+#endif /* CPUTOPOLOGY_HPP */
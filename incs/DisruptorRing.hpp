@@ -0,0 +1,130 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   DisruptorRing.hpp                                  :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: raveriss <raveriss@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/11/27 11:04:37 by raveriss          #+#    #+#             */
+/*   Updated: 2024/11/27 11:04:37 by raveriss         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef DISRUPTORRING_HPP
+#define DISRUPTORRING_HPP
+
+/* For std::vector */
+#include <vector>
+
+/* For size_t */
+#include <cstddef>
+
+/* For sched_yield() */
+#include <sched.h>
+
+/**
+ * class DisruptorRing
+ *
+ * Anneau préalloué à plusieurs producteurs et un seul consommateur, à la
+ * manière d'un disruptor : un producteur réserve un numéro de séquence par
+ * incrément atomique, remplit la case en place puis la publie ; le
+ * consommateur lit les cases publiées dans l'ordre des séquences, sans
+ * copie, et ne les rend aux producteurs qu'après tout un lot.
+ */
+template <typename T>
+class DisruptorRing
+{
+    public:
+
+        /* Constructeur, `capacity` arrondie à la puissance de deux supérieure */
+        explicit DisruptorRing(size_t capacity)
+        : _mask(0), _readCursor(0), _released(0), _claimed(0)
+        {
+            size_t size = 1;
+            while (size < capacity)
+                size <<= 1;
+            _slots.resize(size);
+            _published.resize(size, 0);
+            _mask = size - 1;
+        }
+
+        /* Réserve la prochaine séquence, en attendant que sa case soit rendue ; producteurs */
+        size_t claim()
+        {
+            size_t sequence = __sync_fetch_and_add(&_claimed, 1);
+            while (sequence - _released > _mask)
+                sched_yield();
+            __sync_synchronize();
+            return sequence;
+        }
+
+        /* Retourne la case d'une séquence réservée ou lue */
+        T &slot(size_t sequence)
+        {
+            return _slots[sequence & _mask];
+        }
+
+        /* Publie une case remplie ; producteurs */
+        void publish(size_t sequence)
+        {
+            __sync_synchronize();
+            stamp(sequence) = sequence + 1;
+        }
+
+        /* Retourne la prochaine case publiée, NULL si elle ne l'est pas encore ; consommateur */
+        T *next()
+        {
+            if (stamp(_readCursor) != _readCursor + 1)
+                return NULL;
+            __sync_synchronize();
+            return &_slots[_readCursor++ & _mask];
+        }
+
+        /* Retourne true si la prochaine case est publiée ; consommateur */
+        bool ready()
+        {
+            return stamp(_readCursor) == _readCursor + 1;
+        }
+
+        /* Rend aux producteurs toutes les cases lues ; consommateur */
+        void release()
+        {
+            __sync_synchronize();
+            _released = _readCursor;
+        }
+
+    private:
+
+        /* Non copiable */
+        DisruptorRing(const DisruptorRing &);
+        DisruptorRing &operator=(const DisruptorRing &);
+
+        /* Séquence publiée dans la case d'une séquence, lue et écrite sans cache de registre */
+        volatile size_t &stamp(size_t sequence)
+        {
+            return *static_cast<volatile size_t *>(&_published[sequence & _mask]);
+        }
+
+        /* Cases, remplies et lues en place */
+        std::vector<T> _slots;
+
+        /* Séquence publiée dans chaque case, plus un ; 0 pour une case jamais publiée */
+        std::vector<size_t> _published;
+
+        /* Nombre de cases moins un */
+        size_t _mask;
+
+        /* Prochaine séquence lue, propre au consommateur */
+        size_t _readCursor;
+
+        /* Séquences rendues aux producteurs */
+        volatile size_t _released;
+
+        /* Octets de séparation : le compteur des producteurs a sa propre ligne de cache */
+        char _padding[64];
+
+        /* Prochaine séquence réservée */
+        volatile size_t _claimed;
+};
+
+#endif /* DISRUPTORRING_HPP */
@@ -0,0 +1,62 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   EpollReactor.hpp                                   :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: raveriss <raveriss@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/11/20 14:11:02 by raveriss          #+#    #+#             */
+/*   Updated: 2024/11/20 14:11:02 by raveriss         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef EPOLLREACTOR_HPP
+#define EPOLLREACTOR_HPP
+
+#include "Reactor.hpp"
+
+#ifdef __linux__
+
+/* For epoll_create1(), epoll_ctl(), epoll_wait() */
+#include <sys/epoll.h>
+
+/* Nombre d'événements récupérés par epoll_wait() au démarrage */
+#define EPOLL_INITIAL_EVENTS 1024
+
+/**
+ * class EpollReactor
+ *
+ * Backend epoll en mode edge-triggered : un fd n'est signalé qu'au moment
+ * où il devient prêt. Le serveur doit donc vider chaque socket jusqu'à EAGAIN.
+ */
+class EpollReactor : public Reactor
+{
+    public:
+
+        /* Constructeur, lance une exception si epoll_create1() échoue */
+        EpollReactor();
+
+        /* Destructeur */
+        virtual ~EpollReactor();
+
+        virtual bool add(int fd, int events);
+        virtual bool modify(int fd, int events);
+        virtual void remove(int fd);
+        virtual int wait(std::vector<ReactorEvent> &events, int timeoutMs);
+        virtual const char *name() const;
+
+    private:
+
+        /* Descripteur de l'instance epoll */
+        int _epollFd;
+
+        /* Tampon passé à epoll_wait(), agrandi quand il est rempli */
+        std::vector<struct epoll_event> _ready;
+
+        /* Convertit un masque EV_* en masque EPOLL* */
+        static unsigned int toEpoll(int events);
+};
+
+#endif /* __linux__ */
+
+#endif /* EPOLLREACTOR_HPP */
@@ -0,0 +1,210 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   FanoutEngine.hpp                                   :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: raveriss <raveriss@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/11/26 17:08:26 by raveriss          #+#    #+#             */
+/*   Updated: 2024/11/26 17:08:26 by raveriss         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef FANOUTENGINE_HPP
+#define FANOUTENGINE_HPP
+
+/* For std::vector */
+#include <vector>
+
+/* For pthread_t */
+#include <pthread.h>
+
+/* For uint64_t */
+#include <stdint.h>
+
+/* For MpscQueue */
+#include "MpscQueue.hpp"
+
+/* For ReactorLoop, LoopMessage */
+#include "ReactorLoop.hpp"
+
+/* For SharedPayload */
+#include "SharedPayload.hpp"
+
+/* Diffusions en attente au plus par travailleur */
+#define FANOUTENGINE_QUEUE_SIZE 1024
+
+/* Tranches de l'histogramme de latence : moins d'1 µs, puis une puissance de deux de µs par tranche */
+#define FANOUTENGINE_LATENCY_BUCKETS 32
+
+/**
+ * Destinataire d'une diffusion, copiable sans verrou : le fd, le numéro de
+ * série et la boucle propriétaire d'un membre de canal.
+ */
+struct FanoutTarget
+{
+    int fd;
+    unsigned long serial;
+    size_t loop;
+};
+
+/**
+ * Destinataires d'un canal répartis une fois entre les travailleurs, puis
+ * regroupés par boucle propriétaire dans la part de chacun. Le canal le
+ * garde jusqu'au prochain changement de membres ; les diffusions en cours
+ * le partagent sans le copier. Libéré par le dernier qui le rend.
+ */
+struct FanoutPlan
+{
+    FanoutPlan();
+
+    /* Prend une référence */
+    void acquire();
+
+    /* Rend une référence, libère le plan à la dernière */
+    void release();
+
+    /* Destinataires, part du travailleur 0 d'abord ; dans chaque part, ceux d'une même boucle se suivent */
+    std::vector<FanoutTarget> targets;
+
+    /* Début de la part de chaque travailleur dans targets, suivi de la fin */
+    std::vector<size_t> shares;
+
+    /* Groupes (travailleur, boucle) non vides : autant de dépôts par diffusion */
+    int groups;
+
+    volatile int refs;
+};
+
+/**
+ * Diffusions d'un canal pas encore placées dans les files d'envoi. Le canal
+ * garde une référence ; chaque groupe (travailleur, boucle) d'une diffusion
+ * en garde une, rendue par la boucle après son dernier bloc. Quand seule
+ * celle du canal reste, plus aucun bloc des travailleurs ne peut être
+ * dépassé par un envoi en ligne.
+ */
+struct FanoutDrain
+{
+    FanoutDrain();
+
+    /* Prend `count` références */
+    void acquire(int count);
+
+    /* Rend une référence, libère le compteur à la dernière */
+    void release();
+
+    /* Retourne true si seule la référence du canal reste */
+    bool drained();
+
+    volatile int refs;
+};
+
+/**
+ * Diffusion confiée à un travailleur, copiée par valeur dans sa file :
+ * aucune allocation par message.
+ */
+struct FanoutJob
+{
+    FanoutJob();
+
+    FanoutPlan *plan;
+    FanoutDrain *drain;
+    SharedPayload payload;
+    int exceptFd;
+    unsigned long exceptSerial;
+    uint64_t submittedNs;
+};
+
+/**
+ * class FanoutEngine
+ *
+ * Travailleurs de diffusion des grands canaux. Le travailleur w sert les
+ * destinataires dont le fd vaut w modulo leur nombre, de sorte qu'un
+ * destinataire passe toujours par la même file et reçoit ses messages dans
+ * l'ordre. La répartition est faite une fois par plan : une diffusion n'est
+ * remise qu'aux travailleurs qui ont une part, et chacun ne parcourt que la
+ * sienne, déjà regroupée par boucle, déposée d'un bloc dans chaque boîte
+ * aux lettres.
+ */
+class FanoutEngine
+{
+    public:
+
+        /* Constructeur, sans travailleur */
+        FanoutEngine();
+
+        /* Ferme les tubes ; les threads s'arrêtent avec le processus */
+        ~FanoutEngine();
+
+        /**
+         * Démarre `workers` threads qui déposent dans les boîtes aux lettres de `loops`,
+         * le travailleur i épinglé sur le i-ème processeur de `cpus` s'il y en a
+         */
+        bool start(size_t workers, const std::vector<ReactorLoop*> &loops, const std::vector<int> &cpus);
+
+        /* Retourne le nombre de travailleurs, 0 si le moteur n'est pas démarré */
+        size_t workerCount() const;
+
+        /* Répartit des destinataires entre les travailleurs ; le plan rendu porte une référence */
+        FanoutPlan *makePlan(const std::vector<FanoutTarget> &targets) const;
+
+        /* Confie une diffusion aux travailleurs ; `exceptFd` et `exceptSerial` désignent le client exclu */
+        void submit(FanoutPlan *plan, FanoutDrain *drain, const SharedPayload &payload,
+                    int exceptFd, unsigned long exceptSerial);
+
+        /* Retourne le nombre de diffusions confiées */
+        unsigned long batches() const;
+
+        /* Retourne le nombre de blocs déposés par les travailleurs */
+        unsigned long deliveries() const;
+
+        /* Retourne la borne, en µs, sous laquelle `percent` % des diffusions ont été déposées ; 0 sans diffusion */
+        unsigned long latencyPercentile(unsigned int percent) const;
+
+    private:
+
+        /* Non copiable */
+        FanoutEngine(const FanoutEngine &);
+        FanoutEngine &operator=(const FanoutEngine &);
+
+        /**
+         * Travailleur : sa file, son tube de réveil, les blocs d'un groupe en
+         * attente de dépôt et l'histogramme de latence de ses diffusions,
+         * du dépôt par l'émetteur au dernier bloc déposé.
+         */
+        struct Worker
+        {
+            Worker(FanoutEngine &engine, size_t index, int cpu);
+
+            FanoutEngine &engine;
+            size_t index;
+            pthread_t thread;
+            int cpu;
+            MpscQueue<FanoutJob> queue;
+            int wakePipe[2];
+            volatile int sleeping;
+            std::vector<LoopMessage> outbox;
+            volatile unsigned long latency[FANOUTENGINE_LATENCY_BUCKETS];
+        };
+
+        /* Point d'entrée des threads */
+        static void *workerThread(void *arg);
+
+        /* Boucle d'un travailleur */
+        void runWorker(Worker &worker);
+
+        /* Sert la part d'une diffusion revenant au travailleur */
+        void deliver(Worker &worker, const FanoutJob &job);
+
+        /* Travailleurs */
+        std::vector<Worker*> _workers;
+
+        /* Boucles destinataires */
+        const std::vector<ReactorLoop*> *_loops;
+
+        /* Compteurs rapportés par STATS z */
+        volatile unsigned long _batches;
+        volatile unsigned long _deliveries;
+};
+
+#endif /* FANOUTENGINE_HPP */
@@ -0,0 +1,234 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   HashMap.hpp                                        :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: raveriss <raveriss@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/11/22 09:48:26 by raveriss          #+#    #+#             */
+/*   Updated: 2024/11/22 09:48:26 by raveriss         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef HASHMAP_HPP
+#define HASHMAP_HPP
+
+/* For std::string */
+#include <string>
+
+/* For std::vector */
+#include <vector>
+
+/* Capacité initiale d'une table, puissance de deux */
+#define HASHMAP_INITIAL_CAPACITY 16
+
+/**
+ * Empreinte FNV-1a d'une chaîne
+ */
+struct StringHash
+{
+    size_t operator()(const std::string &key) const
+    {
+        size_t h = 2166136261u;
+        for (size_t i = 0; i < key.size(); ++i)
+        {
+            h ^= static_cast<unsigned char>(key[i]);
+            h *= 16777619u;
+        }
+        return h;
+    }
+};
+
+/**
+ * Empreinte d'un pointeur, les bits d'alignement sont écartés
+ */
+struct PointerHash
+{
+    size_t operator()(const void *key) const
+    {
+        size_t h = reinterpret_cast<size_t>(key);
+        return (h >> 4) ^ (h >> 16);
+    }
+};
+
+/**
+ * class HashMap
+ *
+ * Table de hachage à adressage ouvert et sondage linéaire. La suppression
+ * décale les entrées suivantes au lieu de laisser des marqueurs, si bien
+ * qu'une recherche s'arrête toujours au premier emplacement libre.
+ * La capacité double dès que la table est remplie aux trois quarts.
+ */
+template <typename K, typename V, typename H>
+class HashMap
+{
+    public:
+
+        /* Constructeur */
+        HashMap()
+        : _slots(HASHMAP_INITIAL_CAPACITY), _size(0)
+        {}
+
+        /* Retourne la valeur associée à la clé, NULL si elle est absente */
+        V *find(const K &key)
+        {
+            size_t slot;
+            return lookup(key, _hash(key), slot) ? &_slots[slot].value : NULL;
+        }
+
+        /* Retourne la valeur associée à la clé, NULL si elle est absente */
+        const V *find(const K &key) const
+        {
+            size_t slot;
+            return lookup(key, _hash(key), slot) ? &_slots[slot].value : NULL;
+        }
+
+        /* Associe une valeur à la clé, en remplaçant la précédente */
+        void set(const K &key, const V &value)
+        {
+            size_t h = _hash(key);
+            size_t slot;
+            if (lookup(key, h, slot))
+            {
+                _slots[slot].value = value;
+                return;
+            }
+            if ((_size + 1) * 4 > _slots.size() * 3)
+            {
+                grow();
+                lookup(key, h, slot);
+            }
+            _slots[slot].key = key;
+            _slots[slot].value = value;
+            _slots[slot].hash = h;
+            _slots[slot].used = true;
+            ++_size;
+        }
+
+        /* Retire la clé, retourne false si elle était absente */
+        bool erase(const K &key)
+        {
+            size_t hole;
+            if (!lookup(key, _hash(key), hole))
+                return false;
+
+            /* Recule les entrées suivantes qui ne seraient plus atteignables */
+            size_t mask = _slots.size() - 1;
+            size_t next = (hole + 1) & mask;
+            while (_slots[next].used)
+            {
+                size_t home = _slots[next].hash & mask;
+                if (((next - home) & mask) >= ((next - hole) & mask))
+                {
+                    _slots[hole] = _slots[next];
+                    hole = next;
+                }
+                next = (next + 1) & mask;
+            }
+            _slots[hole] = Slot();
+            --_size;
+            return true;
+        }
+
+        /* Retourne le nombre d'entrées */
+        size_t size() const
+        {
+            return _size;
+        }
+
+        /* Retourne true si la table est vide */
+        bool empty() const
+        {
+            return _size == 0;
+        }
+
+        /* Vide la table */
+        void clear()
+        {
+            std::vector<Slot>(HASHMAP_INITIAL_CAPACITY).swap(_slots);
+            _size = 0;
+        }
+
+        /**
+         * Parcours : les emplacements vont de 0 à capacity() - 1,
+         * seuls ceux pour lesquels occupied() est vrai portent une entrée.
+         */
+        size_t capacity() const
+        {
+            return _slots.size();
+        }
+
+        bool occupied(size_t slot) const
+        {
+            return _slots[slot].used;
+        }
+
+        const K &keyAt(size_t slot) const
+        {
+            return _slots[slot].key;
+        }
+
+        V &valueAt(size_t slot)
+        {
+            return _slots[slot].value;
+        }
+
+    private:
+
+        /* Emplacement de la table */
+        struct Slot
+        {
+            Slot() : key(), value(), hash(0), used(false) {}
+
+            K key;
+            V value;
+            size_t hash;
+            bool used;
+        };
+
+        /**
+         * Cherche la clé ; `slot` reçoit son emplacement si elle est présente,
+         * sinon le premier emplacement libre où l'insérer.
+         */
+        bool lookup(const K &key, size_t h, size_t &slot) const
+        {
+            size_t mask = _slots.size() - 1;
+            slot = h & mask;
+            while (_slots[slot].used)
+            {
+                if (_slots[slot].hash == h && _slots[slot].key == key)
+                    return true;
+                slot = (slot + 1) & mask;
+            }
+            return false;
+        }
+
+        /* Double la capacité et replace toutes les entrées */
+        void grow()
+        {
+            std::vector<Slot> old(_slots.size() * 2);
+            old.swap(_slots);
+
+            size_t mask = _slots.size() - 1;
+            for (size_t i = 0; i < old.size(); ++i)
+            {
+                if (!old[i].used)
+                    continue;
+                size_t slot = old[i].hash & mask;
+                while (_slots[slot].used)
+                    slot = (slot + 1) & mask;
+                _slots[slot] = old[i];
+            }
+        }
+
+        /* Emplacements, en nombre puissance de deux */
+        std::vector<Slot> _slots;
+
+        /* Nombre d'entrées */
+        size_t _size;
+
+        /* Fonction d'empreinte */
+        H _hash;
+};
+
+#endif /* HASHMAP_HPP */
@@ -0,0 +1,125 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   IrcMessage.hpp                                     :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: raveriss <raveriss@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/11/21 14:02:18 by raveriss          #+#    #+#             */
+/*   Updated: 2024/11/21 14:02:18 by raveriss         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef IRCMESSAGE_HPP
+#define IRCMESSAGE_HPP
+
+/* For std::string */
+#include <string>
+
+/* Nombre maximal de paramètres d'un message (RFC 1459, section 2.3.1) */
+#define IRC_MAX_PARAMS 15
+
+/**
+ * Portion d'une ligne reçue, sans copie.
+ * Valide tant que la ligne analysée l'est.
+ */
+struct IrcSlice
+{
+    /* Constructeurs */
+    IrcSlice();
+    IrcSlice(const char *data, size_t length);
+
+    /* Retourne true si la portion est vide */
+    bool empty() const;
+
+    /* Copie la portion dans une chaîne */
+    std::string str() const;
+
+    /* Compare la portion à une chaîne, casse comprise */
+    bool equals(const std::string &other) const;
+
+    /* Compare la portion à un mot en majuscules, sans tenir compte de la casse */
+    bool iequals(const char *upper) const;
+
+    /* Retourne le caractère à l'index donné, '\0' au-delà de la fin */
+    char operator[](size_t index) const;
+
+    const char *data;
+    size_t length;
+};
+
+/**
+ * class IrcMessage
+ *
+ * Vue d'un message IRC obtenue en une seule passe sur la ligne reçue :
+ *     [':' préfixe SPACE] commande { SPACE paramètre } [SPACE ':' trailing]
+ * Le préfixe, la commande et jusqu'à IRC_MAX_PARAMS paramètres sont
+ * mémorisés comme positions dans la ligne, sans allocation. Le paramètre
+ * trailing est le dernier et conserve ses espaces tels quels.
+ */
+class IrcMessage
+{
+    public:
+
+        /* Constructeur */
+        IrcMessage();
+
+        /* Analyse une ligne sans CRLF, retourne false si elle ne contient pas de commande */
+        bool parse(const char *line, size_t length);
+
+        /* Retourne true si le message commence par un préfixe */
+        bool hasPrefix() const;
+
+        /* Retourne le préfixe, sans le ':' initial */
+        IrcSlice prefix() const;
+
+        /* Retourne la commande, telle qu'envoyée */
+        IrcSlice command() const;
+
+        /* Retourne le nombre de paramètres, trailing compris */
+        size_t paramCount() const;
+
+        /* Retourne un paramètre, ou une portion vide au-delà du dernier */
+        IrcSlice param(size_t index) const;
+
+        /* Retourne true si le dernier paramètre a été introduit par ':' */
+        bool hasTrailing() const;
+
+        /* Retourne la ligne analysée */
+        IrcSlice line() const;
+
+    private:
+
+        /* Position d'un élément dans la ligne */
+        struct Range
+        {
+            size_t offset;
+            size_t length;
+        };
+
+        /* Construit la portion correspondant à une position */
+        IrcSlice slice(const Range &range) const;
+
+        /* Ligne analysée, non copiée */
+        const char *_line;
+
+        /* Longueur de la ligne */
+        size_t _length;
+
+        /* Préfixe, vide s'il est absent */
+        Range _prefix;
+
+        /* Commande */
+        Range _command;
+
+        /* Paramètres, dans l'ordre */
+        Range _params[IRC_MAX_PARAMS];
+
+        /* Nombre de paramètres */
+        size_t _paramCount;
+
+        /* Indique si le dernier paramètre est un trailing */
+        bool _hasTrailing;
+};
+
+#endif /* IRCMESSAGE_HPP */
@@ -31,6 +31,12 @@ const std::string RPL_CREATED_MSG = " :This server was created at some point in
 const std::string RPL_MYINFO = " 004 ";
 const std::string RPL_MYINFO_MSG = " serverName 1.0 o o\r\n";
 
+/**
+ * RPL_ISUPPORT : "005 nick <tokens> :are supported by this server\r\n"
+ */
+const std::string RPL_ISUPPORT = " 005 ";
+const std::string RPL_ISUPPORT_MSG = " <tokens> :are supported by this server\r\n";
+
 /* ERR_NOSUCHNICK
     * 401 <nickname> :No such nick/channel\r\n
     */
@@ -579,5 +585,29 @@ const std::string RPL_ENDOFUSERS_MSG = " :End of users\r\n";
 const std::string RPL_NOUSERS = " 395 ";
 const std::string RPL_NOUSERS_MSG = " :Nobody logged in\r\n";
 
+/* RPL_STATSCOMMANDS
+    * 212 <command> <count>\r\n
+    */
+const std::string RPL_STATSCOMMANDS = " 212 ";
+const std::string RPL_STATSCOMMANDS_MSG = " <command> <count>\r\n";
+
+/* RPL_ENDOFSTATS
+    * 219 <stats letter> :End of /STATS report\r\n
+    */
+const std::string RPL_ENDOFSTATS = " 219 ";
+const std::string RPL_ENDOFSTATS_MSG = " <stats letter> :End of /STATS report\r\n";
+
+/* RPL_STATSDEBUG
+    * 249 :<debug text>\r\n
+    */
+const std::string RPL_STATSDEBUG = " 249 ";
+const std::string RPL_STATSDEBUG_MSG = " :<debug text>\r\n";
+
+/* ERR_INPUTTOOLONG
+    * 417 :Input line was too long\r\n
+    */
+const std::string ERR_INPUTTOOLONG = " 417 ";
+const std::string ERR_INPUTTOOLONG_MSG = " :Input line was too long\r\n";
+
 
 #endif // IRC_CODES_HPP
\ No newline at end of file
@@ -0,0 +1,76 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   IrcReply.hpp                                       :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: raveriss <raveriss@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/11/25 09:37:44 by raveriss          #+#    #+#             */
+/*   Updated: 2024/11/25 09:37:44 by raveriss         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef IRCREPLY_HPP
+#define IRCREPLY_HPP
+
+/* For std::string */
+#include <string>
+
+/* For std::ostream */
+#include <ostream>
+
+/* For IRC_LINE_MAX */
+#include "LineFramer.hpp"
+
+/**
+ * Ligne de réponse composée en place dans un tampon fixe de IRC_LINE_MAX
+ * octets : aucune allocation, la limite de 512 octets est appliquée à
+ * l'écriture. Les octets au-delà de 510 sont ignorés, finish() termine la
+ * ligne par CRLF.
+ */
+class IrcReply
+{
+    public:
+
+        /* Ligne vide */
+        IrcReply();
+
+        /* Ajoute du texte, tronqué à la limite de la ligne */
+        IrcReply &operator<<(const std::string &text);
+        IrcReply &operator<<(const char *text);
+        IrcReply &operator<<(char c);
+
+        /* Ajoute un entier en décimal */
+        IrcReply &operator<<(unsigned long value);
+
+        /* Ajoute des octets, tronqués à la limite de la ligne */
+        IrcReply &append(const char *data, size_t length);
+
+        /* Termine la ligne par CRLF */
+        IrcReply &finish();
+
+        /* Retourne les octets de la ligne */
+        const char *data() const;
+
+        /* Retourne la longueur de la ligne */
+        size_t size() const;
+
+        /* Retourne une copie de la ligne, pour les messages diffusés ou journalisés */
+        std::string str() const;
+
+    private:
+
+        /* Ligne en cours, CRLF compris une fois terminée */
+        char _data[IRC_LINE_MAX];
+
+        /* Octets écrits */
+        size_t _length;
+
+        /* true une fois le CRLF écrit : la ligne n'accepte plus d'octets */
+        bool _finished;
+};
+
+/* Ecrit la ligne dans un flux, pour la journalisation */
+std::ostream &operator<<(std::ostream &out, const IrcReply &reply);
+
+#endif /* IRCREPLY_HPP */
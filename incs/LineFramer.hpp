@@ -0,0 +1,107 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   LineFramer.hpp                                     :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: raveriss <raveriss@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/11/21 10:12:37 by raveriss          #+#    #+#             */
+/*   Updated: 2024/11/21 10:12:37 by raveriss         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef LINEFRAMER_HPP
+#define LINEFRAMER_HPP
+
+/* For size_t */
+#include <cstddef>
+
+/* Longueur maximale d'un message IRC, CRLF compris (RFC 1459, section 2.3) */
+#define IRC_LINE_MAX 512
+
+/* Capacité de l'anneau, puissance de deux supérieure à IRC_LINE_MAX */
+#define LINE_FRAMER_CAPACITY 1024
+
+/**
+ * Ligne complète extraite par LineFramer, sans CR ni LF.
+ * Valide jusqu'au prochain appel à append() ou nextLine().
+ */
+struct LineSpan
+{
+    const char *data;
+    size_t length;
+};
+
+/**
+ * class LineFramer
+ *
+ * Tampon circulaire de taille fixe qui découpe le flux d'un client en
+ * lignes IRC. Les lignes sont rendues sous forme de LineSpan pointant
+ * dans l'anneau : aucune copie ni allocation, sauf pour une ligne à
+ * cheval sur la fin de l'anneau, recopiée dans un tampon de IRC_LINE_MAX.
+ * Une ligne qui dépasse IRC_LINE_MAX est jetée dès que la limite est
+ * franchie, sans attendre sa fin.
+ */
+class LineFramer
+{
+    public:
+
+        /* Constructeur */
+        LineFramer();
+
+        /**
+         * Copie autant d'octets que l'anneau peut en recevoir.
+         * Retourne le nombre d'octets consommés, qui peut être inférieur
+         * à `length` tant que les lignes complètes n'ont pas été extraites.
+         */
+        size_t append(const char *data, size_t length);
+
+        /* Extrait la prochaine ligne complète, retourne false s'il n'y en a pas */
+        bool nextLine(LineSpan &line);
+
+        /**
+         * Extrait la prochaine ligne en lisant directement dans un tampon externe.
+         * Les lignes complètes de `data` sont rendues sans copie ; seule la ligne
+         * partielle déjà présente dans l'anneau, ou celle restant en fin de
+         * `data`, y est copiée. `data` et `length` avancent sur ce qui a été
+         * consommé ; la ligne rendue reste valide tant que `data` l'est.
+         */
+        bool nextLine(const char *&data, size_t &length, LineSpan &line);
+
+        /* Retourne et remet à zéro le nombre de lignes jetées car trop longues */
+        size_t takeOverflowCount();
+
+        /* Retourne le nombre d'octets en attente dans l'anneau */
+        size_t size() const;
+
+        /* Vide l'anneau */
+        void clear();
+
+    private:
+
+        /* Recherche '\n' entre deux positions absolues, retourne `end` s'il est absent */
+        size_t findNewline(size_t begin, size_t end) const;
+
+        /* Données reçues, indexées par position absolue modulo LINE_FRAMER_CAPACITY */
+        char _ring[LINE_FRAMER_CAPACITY];
+
+        /* Copie d'une ligne à cheval sur la fin de l'anneau */
+        char _line[IRC_LINE_MAX];
+
+        /* Position absolue du début de la ligne en cours */
+        size_t _start;
+
+        /* Position absolue jusqu'où '\n' a déjà été cherché */
+        size_t _scan;
+
+        /* Position absolue de fin des données reçues */
+        size_t _end;
+
+        /* Vrai tant que la fin d'une ligne trop longue n'a pas été reçue */
+        bool _discarding;
+
+        /* Lignes jetées car trop longues */
+        size_t _overflowCount;
+};
+
+#endif /* LINEFRAMER_HPP */
@@ -0,0 +1,131 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   MpscQueue.hpp                                      :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: raveriss <raveriss@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/11/26 14:37:48 by raveriss          #+#    #+#             */
+/*   Updated: 2024/11/26 14:37:48 by raveriss         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef MPSCQUEUE_HPP
+#define MPSCQUEUE_HPP
+
+/* For std::vector */
+#include <vector>
+
+/* For size_t */
+#include <cstddef>
+
+/**
+ * class MpscQueue
+ *
+ * File bornée sans verrou, à plusieurs producteurs et un seul consommateur.
+ * Chaque case porte un numéro de séquence : un producteur réserve une case
+ * par compare-and-swap sur la queue, y copie sa valeur puis publie la
+ * séquence ; le consommateur lit la case de tête quand sa séquence le
+ * permet et la rend aux producteurs un tour plus loin. Les valeurs restent
+ * dans leurs cases, leur mémoire est réutilisée d'un tour à l'autre.
+ */
+template <typename T>
+class MpscQueue
+{
+    public:
+
+        /* Constructeur, `capacity` arrondie à la puissance de deux supérieure */
+        explicit MpscQueue(size_t capacity)
+        : _mask(0), _head(0), _tail(0)
+        {
+            size_t size = 1;
+            while (size < capacity)
+                size <<= 1;
+            _cells.resize(size);
+            for (size_t i = 0; i < size; ++i)
+                _cells[i].sequence = i;
+            _mask = size - 1;
+        }
+
+        /* Ajoute une valeur, depuis n'importe quel thread ; false si la file est pleine */
+        bool tryPush(const T &value)
+        {
+            size_t position = _tail;
+            Cell *cell;
+            while (true)
+            {
+                cell = &_cells[position & _mask];
+                size_t sequence = cell->sequence;
+                __sync_synchronize();
+                long difference = static_cast<long>(sequence - position);
+                if (difference == 0)
+                {
+                    if (__sync_bool_compare_and_swap(&_tail, position, position + 1))
+                        break;
+                }
+                else if (difference < 0)
+                    return false;
+                position = _tail;
+            }
+            cell->value = value;
+            __sync_synchronize();
+            cell->sequence = position + 1;
+            return true;
+        }
+
+        /* Retire la valeur de tête ; consommateur seulement, false si la file est vide */
+        bool tryPop(T &value)
+        {
+            Cell &cell = _cells[_head & _mask];
+            if (cell.sequence != _head + 1)
+                return false;
+            __sync_synchronize();
+            value = cell.value;
+            __sync_synchronize();
+            cell.sequence = _head + _mask + 1;
+            ++_head;
+            return true;
+        }
+
+        /* Retourne true si aucune valeur n'est publiée ; consommateur seulement */
+        bool empty() const
+        {
+            return _cells[_head & _mask].sequence != _head + 1;
+        }
+
+        /* Retourne le nombre de cases */
+        size_t capacity() const
+        {
+            return _mask + 1;
+        }
+
+    private:
+
+        /* Case de la file : la valeur et sa séquence de publication */
+        struct Cell
+        {
+            volatile size_t sequence;
+            T value;
+        };
+
+        /* Non copiable */
+        MpscQueue(const MpscQueue &);
+        MpscQueue &operator=(const MpscQueue &);
+
+        /* Cases, en nombre puissance de deux */
+        std::vector<Cell> _cells;
+
+        /* Nombre de cases moins un */
+        size_t _mask;
+
+        /* Prochaine case lue, propre au consommateur */
+        size_t _head;
+
+        /* Octets de séparation : tête et queue ne partagent pas de ligne de cache */
+        char _padding[64];
+
+        /* Prochaine case réservée par un producteur */
+        volatile size_t _tail;
+};
+
+#endif /* MPSCQUEUE_HPP */
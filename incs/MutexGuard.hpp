@@ -0,0 +1,51 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   MutexGuard.hpp                                     :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: raveriss <raveriss@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/11/26 09:12:05 by raveriss          #+#    #+#             */
+/*   Updated: 2024/11/26 09:12:05 by raveriss         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef MUTEXGUARD_HPP
+#define MUTEXGUARD_HPP
+
+/* For pthread_mutex_t */
+#include <pthread.h>
+
+/**
+ * class MutexGuard
+ *
+ * Verrouille un mutex pour la durée d'une portée.
+ */
+class MutexGuard
+{
+    public:
+
+        /* Verrouille `mutex` */
+        explicit MutexGuard(pthread_mutex_t &mutex)
+        : _mutex(mutex)
+        {
+            pthread_mutex_lock(&_mutex);
+        }
+
+        /* Déverrouille le mutex */
+        ~MutexGuard()
+        {
+            pthread_mutex_unlock(&_mutex);
+        }
+
+    private:
+
+        /* Non copiable */
+        MutexGuard(const MutexGuard &);
+        MutexGuard &operator=(const MutexGuard &);
+
+        /* Mutex verrouillé */
+        pthread_mutex_t &_mutex;
+};
+
+#endif /* MUTEXGUARD_HPP */
@@ -0,0 +1,195 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   ObjectPool.hpp                                     :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: raveriss <raveriss@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/11/25 16:02:37 by raveriss          #+#    #+#             */
+/*   Updated: 2024/11/25 16:02:37 by raveriss         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef OBJECTPOOL_HPP
+#define OBJECTPOOL_HPP
+
+/* For std::vector */
+#include <vector>
+
+/* For operator new (std::nothrow), placement new */
+#include <new>
+
+/* Objets par slab, alloués d'un bloc quand la liste libre est vide */
+#define OBJECTPOOL_SLAB_OBJECTS 64
+
+/**
+ * class ObjectPool
+ *
+ * Réserve d'objets de taille fixe découpée en slabs. Les emplacements
+ * libérés sont chaînés dans une liste libre et réutilisés avant toute
+ * nouvelle allocation ; les slabs ne sont rendus qu'à la destruction.
+ * Une limite optionnelle borne le nombre d'objets vivants.
+ */
+template <typename T>
+class ObjectPool
+{
+    public:
+
+        /* Constructeur, réserve vide et sans limite */
+        ObjectPool()
+        : _free(NULL), _limit(0), _capacity(0), _inUse(0), _highWater(0)
+        {}
+
+        /* Rend les slabs ; les objets doivent avoir été détruits */
+        ~ObjectPool()
+        {
+            for (size_t i = 0; i < _slabs.size(); ++i)
+                ::operator delete(_slabs[i]);
+        }
+
+        /* Borne le nombre d'objets vivants, 0 pour aucune limite */
+        void setLimit(size_t limit)
+        {
+            _limit = limit;
+        }
+
+        /* Préalloue des slabs jusqu'à pouvoir loger `count` objets, retourne false si la mémoire manque */
+        bool reserve(size_t count)
+        {
+            while (_capacity < count)
+            {
+                if (!grow())
+                    return false;
+            }
+            return true;
+        }
+
+        /* Construit un objet dans un emplacement libre, NULL si la limite est atteinte ou la mémoire épuisée */
+        template <typename A>
+        T *create(const A &argument)
+        {
+            Slot *slot = acquire();
+            if (slot == NULL)
+                return NULL;
+            try
+            {
+                return new (slot->storage) T(argument);
+            }
+            catch (...)
+            {
+                release(slot);
+                throw;
+            }
+        }
+
+        /* Détruit l'objet et rend son emplacement à la liste libre */
+        void destroy(T *object)
+        {
+            if (object == NULL)
+                return;
+            object->~T();
+            release(reinterpret_cast<Slot *>(object));
+        }
+
+        /* Retourne le nombre d'objets vivants */
+        size_t inUse() const
+        {
+            return _inUse;
+        }
+
+        /* Retourne le plus grand nombre d'objets vivants observé */
+        size_t highWater() const
+        {
+            return _highWater;
+        }
+
+        /* Retourne le nombre d'emplacements alloués, libres ou non */
+        size_t capacity() const
+        {
+            return _capacity;
+        }
+
+        /* Retourne la limite, 0 si aucune */
+        size_t limit() const
+        {
+            return _limit;
+        }
+
+    private:
+
+        /* Emplacement : un objet, ou le maillon suivant de la liste libre */
+        union Slot
+        {
+            Slot *next;
+            char storage[sizeof(T)];
+
+            /* Alignement de l'objet, au moins celui des types de base */
+            double alignDouble;
+            long alignLong;
+            void *alignPointer;
+        };
+
+        /* Prend un emplacement libre, en allouant un slab si besoin */
+        Slot *acquire()
+        {
+            if (_limit != 0 && _inUse >= _limit)
+                return NULL;
+            if (_free == NULL && !grow())
+                return NULL;
+
+            Slot *slot = _free;
+            _free = slot->next;
+            if (++_inUse > _highWater)
+                _highWater = _inUse;
+            return slot;
+        }
+
+        /* Remet un emplacement en tête de la liste libre */
+        void release(Slot *slot)
+        {
+            slot->next = _free;
+            _free = slot;
+            --_inUse;
+        }
+
+        /* Alloue un slab et chaîne ses emplacements dans la liste libre */
+        bool grow()
+        {
+            Slot *slab = static_cast<Slot *>(::operator new(sizeof(Slot) * OBJECTPOOL_SLAB_OBJECTS, std::nothrow));
+            if (slab == NULL)
+                return false;
+            _slabs.push_back(slab);
+
+            for (size_t i = OBJECTPOOL_SLAB_OBJECTS; i > 0; --i)
+            {
+                slab[i - 1].next = _free;
+                _free = &slab[i - 1];
+            }
+            _capacity += OBJECTPOOL_SLAB_OBJECTS;
+            return true;
+        }
+
+        /* Non copiable : les objets vivants pointent dans les slabs */
+        ObjectPool(const ObjectPool &);
+        ObjectPool &operator=(const ObjectPool &);
+
+        /* Slabs alloués */
+        std::vector<Slot *> _slabs;
+
+        /* Tête de la liste libre */
+        Slot *_free;
+
+        /* Nombre maximal d'objets vivants, 0 pour aucune limite */
+        size_t _limit;
+
+        /* Nombre d'emplacements alloués */
+        size_t _capacity;
+
+        /* Nombre d'objets vivants */
+        size_t _inUse;
+
+        /* Plus grand nombre d'objets vivants observé */
+        size_t _highWater;
+};
+
+#endif /* OBJECTPOOL_HPP */
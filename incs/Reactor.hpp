@@ -0,0 +1,72 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   Reactor.hpp                                        :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: raveriss <raveriss@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/11/20 14:02:11 by raveriss          #+#    #+#             */
+/*   Updated: 2024/11/20 14:02:11 by raveriss         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef REACTOR_HPP
+#define REACTOR_HPP
+
+/* For std::string */
+#include <string>
+
+/* For std::vector */
+#include <vector>
+
+/**
+ * Evénement signalé par un backend : descripteur prêt et masque EV_*.
+ */
+struct ReactorEvent
+{
+    int fd;
+    int events;
+};
+
+/**
+ * class Reactor
+ *
+ * Interface minimale de boucle d'événements. Le serveur n'y voit que des
+ * descripteurs prêts : le coût d'un réveil est proportionnel au nombre de
+ * sockets actifs, pas au plus grand fd surveillé.
+ */
+class Reactor
+{
+    public:
+
+        /* Masques d'intérêt et d'événements */
+        static const int EV_READ = 1;
+        static const int EV_WRITE = 2;
+        static const int EV_ERROR = 4;
+
+        /* Destructeur */
+        virtual ~Reactor();
+
+        /* Surveille un nouveau descripteur, retourne false si impossible */
+        virtual bool add(int fd, int events) = 0;
+
+        /* Change l'intérêt d'un descripteur déjà surveillé */
+        virtual bool modify(int fd, int events) = 0;
+
+        /* Arrête de surveiller un descripteur */
+        virtual void remove(int fd) = 0;
+
+        /**
+         * Attend au plus timeoutMs millisecondes et remplit `events`
+         * avec les descripteurs prêts. Retourne leur nombre, -1 en cas d'erreur.
+         */
+        virtual int wait(std::vector<ReactorEvent> &events, int timeoutMs) = 0;
+
+        /* Nom du backend, affiché au démarrage */
+        virtual const char *name() const = 0;
+
+        /* Instancie le backend demandé ("epoll" ou "select"), NULL si inconnu */
+        static Reactor *create(const std::string &backend);
+};
+
+#endif /* REACTOR_HPP */
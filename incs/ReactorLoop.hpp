@@ -0,0 +1,240 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   ReactorLoop.hpp                                    :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: raveriss <raveriss@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/11/26 09:12:05 by raveriss          #+#    #+#             */
+/*   Updated: 2024/11/26 09:12:05 by raveriss         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef REACTORLOOP_HPP
+#define REACTORLOOP_HPP
+
+/* For std::vector */
+#include <vector>
+
+/* For pthread_t, pthread_mutex_t */
+#include <pthread.h>
+
+/* For uint64_t */
+#include <stdint.h>
+
+/* For Client */
+#include "Client.hpp"
+
+/* For ObjectPool */
+#include "ObjectPool.hpp"
+
+/* For Reactor, ReactorEvent */
+#include "Reactor.hpp"
+
+/* For SharedPayload */
+#include "SharedPayload.hpp"
+
+/* For TimerWheel, TimerNode */
+#include "TimerWheel.hpp"
+
+/* Déclaration anticipée de Server */
+class Server;
+
+/* Déclaration anticipée de FanoutDrain */
+struct FanoutDrain;
+
+/**
+ * Compteurs d'appels système d'une boucle d'événements,
+ * rapportés au nombre de commandes traitées par STATS z.
+ * STATS z les lit depuis la boucle de son auteur : ils ne sont lus
+ * et écrits que par count(), load() et store(), atomiques.
+ */
+struct IoStats
+{
+    IoStats();
+
+    /* Incrémente un compteur */
+    static void count(volatile unsigned long &counter);
+
+    /* Lit un compteur, depuis n'importe quel thread */
+    static unsigned long load(volatile unsigned long &counter);
+
+    /* Remplace la valeur d'un compteur */
+    static void store(volatile unsigned long &counter, unsigned long value);
+
+    /* Commandes traitées */
+    volatile unsigned long commands;
+
+    /* Appels à wait() du backend */
+    volatile unsigned long waits;
+
+    /* Appels à accept() */
+    volatile unsigned long accepts;
+
+    /* Appels à recv() */
+    volatile unsigned long reads;
+
+    /* Appels à writev() */
+    volatile unsigned long writes;
+
+    /* Clients vivants, plus haut niveau et emplacements de la réserve, recopiés à chaque tour */
+    volatile unsigned long clients;
+    volatile unsigned long clientsHigh;
+    volatile unsigned long clientSlots;
+};
+
+/**
+ * Message adressé à un client d'une autre boucle : un bloc à placer dans sa
+ * file d'envoi, une demande de fermeture, ou la reprise de sa lecture
+ * suspendue derrière ses commandes confiées aux shards. Le client est désigné par son
+ * fd et son numéro de série, car il peut avoir été détruit, et son fd
+ * réattribué, avant la livraison. Le dernier bloc d'un groupe de diffusion
+ * porte la référence de vidage de son canal, rendue une fois le bloc traité.
+ */
+struct LoopMessage
+{
+    LoopMessage();
+
+    int fd;
+    unsigned long serial;
+    SharedPayload payload;
+    bool close;
+    bool resume;
+    FanoutDrain *drain;
+};
+
+/**
+ * class ReactorLoop
+ *
+ * Boucle d'événements et tout ce qu'elle possède : socket d'écoute, backend,
+ * table des clients, minuteurs et files d'envoi en attente. Chaque boucle
+ * tourne sur son propre thread ; seul ce thread touche à ses membres.
+ * Les autres boucles lui écrivent par sa boîte aux lettres, réveillée par
+ * un tube surveillé comme n'importe quel socket.
+ */
+class ReactorLoop
+{
+    public:
+
+        /* Constructeur, sans socket ni backend */
+        ReactorLoop(Server &server, size_t index, size_t recvBufferSize, uint64_t nowMs);
+
+        /* Ferme le socket d'écoute, la boîte aux lettres et le backend */
+        ~ReactorLoop();
+
+        /* Recopie l'état de la réserve de clients dans ioStats, pour STATS z */
+        void publishPoolStats();
+
+        /* Alloue le tampon de réception et préalloue les clients, depuis le thread de la boucle */
+        bool allocateBuffers();
+
+        /* Crée le tube de la boîte aux lettres et l'inscrit dans le backend */
+        bool openMailbox();
+
+        /* Retourne le descripteur à surveiller pour la boîte aux lettres */
+        int mailboxFd() const;
+
+        /* Dépose un bloc pour `client`, depuis n'importe quel thread */
+        void post(Client *client, const SharedPayload &payload);
+
+        /* Dépose un message déjà adressé, depuis n'importe quel thread */
+        void post(const LoopMessage &message);
+
+        /* Dépose une suite de messages en une seule prise du verrou */
+        void postAll(const std::vector<LoopMessage> &messages);
+
+        /* Vide le tube et récupère les messages déposés depuis le dernier appel */
+        void takeMessages(std::vector<LoopMessage> &messages);
+
+        /* Retourne le client vivant de ce fd et de ce numéro de série, NULL sinon */
+        Client *clientAt(int fd, unsigned long serial) const;
+
+        /* Désigne cette boucle comme celle du thread appelant */
+        void makeCurrent();
+
+        /* Retourne la boucle du thread appelant, NULL hors d'une boucle */
+        static ReactorLoop *current();
+
+        /* Serveur propriétaire */
+        Server &server;
+
+        /* Rang de la boucle, 0 pour celle du thread principal */
+        size_t index;
+
+        /* Thread de la boucle, sauf pour la boucle 0 */
+        pthread_t thread;
+
+        /* Processeur sur lequel la boucle s'épingle, -1 pour aucun */
+        int cpu;
+
+        /* Socket d'écoute propre à la boucle (SO_REUSEPORT au-delà d'une boucle) */
+        int listenSocket;
+
+        /* Backend de la boucle */
+        Reactor *reactor;
+
+        /* Evénements renvoyés par le dernier wait(), réutilisé d'une itération à l'autre */
+        std::vector<ReactorEvent> events;
+
+        /* Clients de la boucle */
+        std::vector<Client*> clients;
+
+        /* Clients indexés par descripteur, NULL si le fd n'appartient à aucun client de la boucle */
+        std::vector<Client*> clientsByFd;
+
+        /* Clients retirés pendant l'itération, détruits à sa fin */
+        std::vector<Client*> clientsToRemove;
+
+        /* Clients ayant reçu des réponses pendant l'itération en cours */
+        std::vector<Client*> pendingFlush;
+
+        /* Tampon de réception partagé par les clients de la boucle */
+        std::vector<char> recvBuffer;
+
+        /* Clients ayant épuisé leur budget de lecture avant EAGAIN */
+        std::vector<Client*> readBacklog;
+
+        /* Compteurs d'appels système */
+        IoStats ioStats;
+
+        /* Horloge monotone en millisecondes, lue une fois par itération */
+        uint64_t nowMs;
+
+        /* Minuteurs d'enregistrement, de PING et de PONG des clients */
+        TimerWheel timers;
+
+        /* Minuteurs échus au dernier tick */
+        std::vector<TimerNode*> expiredTimers;
+
+        /* Slabs des objets Client de la boucle */
+        ObjectPool<Client> clientPool;
+
+        /* Messages livrés par takeMessages(), réutilisé d'une itération à l'autre */
+        std::vector<LoopMessage> inbox;
+
+        /* Clients dont la reprise est arrivée, repris une fois la boîte aux lettres livrée */
+        std::vector<Client*> resumed;
+
+    private:
+
+        /* Non copiable */
+        ReactorLoop(const ReactorLoop &);
+        ReactorLoop &operator=(const ReactorLoop &);
+
+        /* Taille du tampon de réception, alloué par allocateBuffers() */
+        size_t _recvBufferSize;
+
+        /* Tube de réveil : [0] surveillé par la boucle, [1] écrit par les autres */
+        int _wakePipe[2];
+
+        /* Protège _mailbox et _signalled */
+        pthread_mutex_t _mailboxLock;
+
+        /* Messages déposés, pas encore récupérés */
+        std::vector<LoopMessage> _mailbox;
+
+        /* Un octet attend déjà dans le tube : inutile d'en écrire un autre */
+        bool _signalled;
+};
+
+#endif /* REACTORLOOP_HPP */
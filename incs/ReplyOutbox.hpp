@@ -0,0 +1,65 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   ReplyOutbox.hpp                                    :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: raveriss <raveriss@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/11/27 10:21:54 by raveriss          #+#    #+#             */
+/*   Updated: 2024/11/27 10:21:54 by raveriss         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef REPLYOUTBOX_HPP
+#define REPLYOUTBOX_HPP
+
+/* For std::vector */
+#include <vector>
+
+/* For Client */
+#include "Client.hpp"
+
+/* For ReactorLoop, LoopMessage */
+#include "ReactorLoop.hpp"
+
+/* For SharedPayload */
+#include "SharedPayload.hpp"
+
+/**
+ * class ReplyOutbox
+ *
+ * Réponses produites par un thread qui n'est pas une boucle d'événements
+ * (shard, fil d'état du pipeline), mises de côté par boucle destinataire
+ * pendant l'exécution d'un lot de commandes, puis déposées dans les boîtes
+ * aux lettres en une prise de verrou par boucle. Une demande de fermeture
+ * suit le même chemin, derrière les réponses qui la précèdent.
+ */
+class ReplyOutbox
+{
+    public:
+
+        /* Constructeur, un vecteur par boucle */
+        explicit ReplyOutbox(size_t loopCount);
+
+        /* Met de côté un bloc pour `client` */
+        void defer(Client *client, const SharedPayload &payload);
+
+        /* Met de côté la fermeture de `client`, exécutée par sa boucle */
+        void deferClose(Client *client);
+
+        /* Dépose les messages mis de côté dans les boîtes aux lettres des boucles */
+        void flush(const std::vector<ReactorLoop*> &loops);
+
+        /* Désigne cette boîte comme celle du thread appelant */
+        void makeCurrent();
+
+        /* Retourne la boîte du thread appelant, NULL sur une boucle d'événements */
+        static ReplyOutbox *current();
+
+    private:
+
+        /* Messages mis de côté, un vecteur par boucle destinataire */
+        std::vector<std::vector<LoopMessage> > _messages;
+};
+
+#endif /* REPLYOUTBOX_HPP */
@@ -0,0 +1,80 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   RuleSet.hpp                                        :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: raveriss <raveriss@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/11/24 16:52:13 by raveriss          #+#    #+#             */
+/*   Updated: 2024/11/24 16:52:13 by raveriss         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef RULESET_HPP
+#define RULESET_HPP
+
+/* For std::string */
+#include <string>
+
+/* For WordMatcher */
+#include "WordMatcher.hpp"
+
+/* For HashMap */
+#include "HashMap.hpp"
+
+/**
+ * Règles de modération du bot : des mots interdits partout, et d'autres
+ * propres à certains canaux. Un jeu de règles est compilé en entier puis
+ * n'est plus modifié : il est remplacé d'un bloc lors d'un rechargement.
+ *
+ * Format d'un fichier de règles, une entrée par ligne :
+ *   # commentaire
+ *   mot               interdit sur tous les canaux
+ *   [#canal]          les mots suivants ne valent que pour #canal
+ *   [*]               les mots suivants valent de nouveau partout
+ */
+class RuleSet
+{
+    public:
+
+        /* Jeu de règles vide */
+        RuleSet();
+
+        /* Libère les automates des canaux */
+        ~RuleSet();
+
+        /* Ajoute les mots interdits par défaut, sans fichier de règles */
+        void loadDefaults();
+
+        /* Lit et compile le fichier de règles, retourne false avec error() renseigné */
+        bool loadFile(const std::string &path);
+
+        /* Retourne la raison du dernier échec de chargement */
+        const std::string &error() const;
+
+        /* Retourne true si le texte contient un mot interdit partout ou sur le canal (nom replié) */
+        bool matches(const std::string &foldedChannel, const char *data, size_t length) const;
+
+        /* Retourne le nombre de mots interdits partout */
+        size_t globalCount() const;
+
+        /* Retourne le nombre de canaux ayant leurs propres règles */
+        size_t channelCount() const;
+
+    private:
+
+        /* Mots interdits sur tous les canaux */
+        WordMatcher _global;
+
+        /* Mots propres à un canal, indexés par nom replié (rfc1459) */
+        HashMap<std::string, WordMatcher*, StringHash> _channels;
+
+        /* Raison du dernier échec de chargement */
+        std::string _error;
+
+        /* Les automates des canaux appartiennent au jeu de règles : copie interdite */
+        RuleSet(const RuleSet &other);
+        RuleSet &operator=(const RuleSet &other);
+};
+
+#endif /* RULESET_HPP */
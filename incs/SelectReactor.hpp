@@ -0,0 +1,58 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   SelectReactor.hpp                                  :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: raveriss <raveriss@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/11/20 14:05:37 by raveriss          #+#    #+#             */
+/*   Updated: 2024/11/20 14:05:37 by raveriss         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef SELECTREACTOR_HPP
+#define SELECTREACTOR_HPP
+
+#include "Reactor.hpp"
+
+/* For fd_set, select() */
+#include <sys/select.h>
+
+/**
+ * class SelectReactor
+ *
+ * Backend historique basé sur select(). Limité à FD_SETSIZE descripteurs,
+ * chaque réveil parcourt tous les fd jusqu'à _fdMax.
+ */
+class SelectReactor : public Reactor
+{
+    public:
+
+        /* Constructeur */
+        SelectReactor();
+
+        /* Destructeur */
+        virtual ~SelectReactor();
+
+        virtual bool add(int fd, int events);
+        virtual bool modify(int fd, int events);
+        virtual void remove(int fd);
+        virtual int wait(std::vector<ReactorEvent> &events, int timeoutMs);
+        virtual const char *name() const;
+
+    private:
+
+        /* Ensemble des fd surveillés en lecture */
+        fd_set _readSet;
+
+        /* Ensemble des fd surveillés en écriture */
+        fd_set _writeSet;
+
+        /* Valeur maximale de fd */
+        int _fdMax;
+
+        /* Recalcule _fdMax après un retrait */
+        void shrinkFdMax();
+};
+
+#endif /* SELECTREACTOR_HPP */
@@ -16,8 +16,24 @@
 /* Inclusions pour clients, canaux et bot */
 #include "Bot.hpp"
 #include "Client.hpp"
+#include "Channel.hpp"
 #include "IrcNumericReplies.hpp"
 #include "IrcMessageBuilder.hpp"
+#include "IrcMessage.hpp"
+#include "CommandTable.hpp"
+#include "ChannelShard.hpp"
+#include "CommandPipeline.hpp"
+#include "CpuTopology.hpp"
+#include "FanoutEngine.hpp"
+#include "HashMap.hpp"
+#include "ObjectPool.hpp"
+#include "ReactorLoop.hpp"
+#include "Casemap.hpp"
+#include "Reactor.hpp"
+#include "ServerConfig.hpp"
+#include "SharedPayload.hpp"
+#include "TimerWheel.hpp"
+#include "WelcomeCache.hpp"
 
 /* For std::vector */
 #include <vector>
@@ -100,10 +116,14 @@
 /* Code de retour pour une opération échouée */
 #define FAILURE -1
 
-/* Nombre de paramètres requis pour la commande */
-#define TWO_ARGMNTS 2
+/* Nombre d'arguments requis sur la ligne de commande */
 #define THREE_ARGMNTS 3
-#define FIVE_ARGMNTS 5
+
+/* Nombre de paramètres requis après la commande IRC */
+#define ONE_PARAM 1
+#define TWO_PARAMS 2
+#define THREE_PARAMS 3
+#define FOUR_PARAMS 4
 
 /* Signal d'interruption déclenché par Ctrl + C */
 #define CTRL_C SIGINT
@@ -133,8 +153,21 @@
 /* Mode "limite d'utilisateurs" */
 #define USER_LIMIT 'l'
 
-/*  Taille du tampon IRC */
-#define IRC_BUFFER_SIZE 1024
+/* Délai d'attente maximal de la boucle d'événements, en millisecondes */
+#define REACTOR_TIMEOUT_MS 1000
+
+/* Taille maximale de la file d'envoi d'un client avant déconnexion */
+#define MAX_SENDQ_BYTES (1024 * 1024)
+
+/* Nombre maximal de blocs regroupés dans un seul appel à writev() */
+#define WRITEV_MAX_IOV 64
+
+/* Evite SIGPIPE lors d'un envoi vers un client déconnecté */
+#ifdef MSG_NOSIGNAL
+# define SEND_FLAGS MSG_NOSIGNAL
+#else
+# define SEND_FLAGS 0
+#endif
 
 /* Adresse de loopback (localhost) */
 #define LOCALHOST "127.0.0.1"
@@ -156,7 +189,7 @@ class Server
         static Server* instance;
 
         /* Constructeur */
-        Server(unsigned short port, const std::string &password);
+        Server(unsigned short port, const std::string &password, const ServerConfig &config = ServerConfig());
 
         /* Destructeur */
         ~Server();
@@ -169,18 +202,9 @@ class Server
         /* Méthode pour lancer le serveur */
         void run();
 
-        /* Retourne la valeur maximale de fd */
-        int getFdMax() const;
-
-        /* Retourne l'ensemble maître des fd */
-        fd_set& getMasterSet();
-    
         /* Retourne le nom du serveur */
         const std::string& getServerName() const;
 
-        /* Définit la valeur maximale de fd */
-        void setFdMax(int fd);
-
         std::string & getServerIp();
 
 
@@ -192,7 +216,49 @@ class Server
         void init();
 
          /* Méthodes pour gérer les commandes */
-        void processCommand(Client *client, const std::string &message);
+        void processCommand(Client *client, const IrcMessage &message, CommandEntry *entry);
+
+        /* Exécute une commande puis la passe au bot, sous les verrous de l'état qu'elle touche */
+        void executeMessage(Client *client, const IrcMessage &message, CommandEntry *entry);
+
+        /* Indique si une commande lit ou modifie un canal, et s'exécute donc sous le verrou de ses canaux */
+        bool touchesChannels(const IrcMessage &message, const CommandEntry *entry) const;
+
+        /* Verrouille tous les canaux : tous les shards dans l'ordre de leur rang, ou _channelLock */
+        void lockChannels();
+
+        /* Rend les verrous pris par lockChannels() */
+        void unlockChannels();
+
+        /* Retourne le verrou qui protège le canal de ce nom replié */
+        pthread_mutex_t &channelLockFor(const std::string &foldedName);
+
+        /* Analyse une ligne dans une case de l'anneau du pipeline et la publie au fil d'état */
+        void submitToPipeline(Client *client, const LineSpan &line);
+
+        /* Publie au fil d'état une ligne trop longue ou la fin de flux d'un client */
+        void submitEventToPipeline(Client *client, CommandRecord::Kind kind);
+
+        /* Confie une commande de canal à son shard, false si elle s'exécute sur place */
+        bool routeToShard(Client *client, const IrcMessage &message, const LineSpan &line);
+
+        /* Confie une ligne au shard du canal `target` */
+        void pushShardTask(Client *client, const IrcSlice &target, const std::string &line);
+
+        /* Suspend la lecture derrière les commandes confiées aux shards, false si elles sont déjà exécutées */
+        bool parkBehindShards(Client *client, const LineSpan &line, const char *rest, size_t restLength, size_t overflow);
+
+        /* Exécute la ligne suspendue d'un client une fois ses commandes confiées exécutées, puis reprend sa lecture */
+        void resumeClient(Client *client);
+
+        /* Exécute les lignes complètes d'un bloc reçu, false si la lecture est suspendue */
+        bool processInput(Client *client, const char *data, size_t length);
+
+        /* Signale les lignes jetées car plus longues que IRC_LINE_MAX */
+        void reportOverflow(Client *client, size_t dropped);
+
+        /* Remplit la table de dispatch des commandes */
+        void registerCommands();
 
         /* Méthodes utilitaires */
         void removeClient(Client *client);
@@ -203,14 +269,35 @@ class Server
         /* Envoie le MOTD au client */
         void sendMotd(Client *client);
 
+        /* Rend les réponses d'accueil et le MOTD dans _welcome */
+        bool renderWelcome(std::string &error);
+
+        /* Recharge les règles du bot et le MOTD (SIGHUP, REHASH) */
+        void rehash();
+
         /* Divise une chaîne en fonction d'un délimiteur */
         std::vector<std::string> split(const std::string &str, const std::string &delim);
 
-        /* Retourne un client par son pseudonyme */
+        /* Retourne un client par son pseudonyme ; l'appelant tient _nickLock tant qu'il l'utilise */
         Client* getClientByNickname(const std::string &nickname);
 
-        /* Retourne un canal à partir d'un message */
-        Channel* getChannelFromMessage(const std::string &message);
+        /* Retire le pseudonyme d'un client de l'index */
+        void unindexNickname(Client *client);
+
+        /* Retourne le canal portant ce nom, sans tenir compte de la casse rfc1459 */
+        Channel* findChannel(const std::string &name);
+
+        /* Crée un canal et l'inscrit dans l'index, NULL si la mémoire manque */
+        Channel* createChannel(const std::string &name);
+
+        /* Retire un canal vide de l'index et le détruit */
+        void destroyChannel(Channel *channel);
+
+        /* Retire un client retiré de ses canaux, sous le verrou de chacun, et détruit ceux qu'il vide */
+        void detachFromChannels(Client *client);
+
+        /* Retourne le canal visé par le premier paramètre d'un message */
+        Channel* getChannelFromMessage(const IrcMessage &message);
 
         /* Vérifie la validité d'un pseudonyme */
         bool isValidNickname(const std::string &nickname);
@@ -224,24 +311,35 @@ class Server
         /*   -'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-',-'   */
         
         /* Gère une nouvelle connexion */
-        void handleNewConnection();
+        void handleNewConnection(ReactorLoop &loop);
+
+        /* Inscrit un client fraîchement accepté */
+        void addClient(ReactorLoop &loop, int fdNewClient);
 
         /* Gère les messages des clients */
         void handleClientMessage(Client *client);
 
         /* Commandes IRC standard */
-        void handlePassCommand(Client *client, const std::vector<std::string> &params);
-        void handleNickCommand(Client *client, const std::vector<std::string> &params);
-        void handleUserCommand(Client *client, const std::vector<std::string> &params);
-        void handleJoinCommand(Client *client, const std::vector<std::string> &params);
-        void handlePartCommand(Client *client, const std::vector<std::string> &params);
-        void handlePrivmsgCommand(Client *client, const std::vector<std::string> &params);
-        void handleModeCommand(Client *client, const std::vector<std::string> &params);
-        void handleInviteCommand(Client *client, const std::vector<std::string> &params);
-        void handleTopicCommand(Client *client, const std::vector<std::string> &params);
-        void handleKickCommand(Client *client, const std::vector<std::string> &params);
-        void handleCapCommand(Client *client, const std::vector<std::string> &params);
-        bool handlePingPongCommand(Client *client, const std::string &args);
+        void handlePassCommand(Client *client, const IrcMessage &message);
+        void handleNickCommand(Client *client, const IrcMessage &message);
+        void handleUserCommand(Client *client, const IrcMessage &message);
+        void handleJoinCommand(Client *client, const IrcMessage &message);
+        void handlePartCommand(Client *client, const IrcMessage &message);
+        void handlePrivmsgCommand(Client *client, const IrcMessage &message);
+        void handleModeCommand(Client *client, const IrcMessage &message);
+        void handleInviteCommand(Client *client, const IrcMessage &message);
+        void handleTopicCommand(Client *client, const IrcMessage &message);
+        void handleKickCommand(Client *client, const IrcMessage &message);
+        void handleCapCommand(Client *client, const IrcMessage &message);
+        void handlePingPongCommand(Client *client, const IrcMessage &message);
+        void handleQuitCommand(Client *client, const IrcMessage &message);
+        void handleStatsCommand(Client *client, const IrcMessage &message);
+
+        /* Gère la commande OPER */
+        void handleOperCommand(Client *client, const IrcMessage &message);
+
+        /* Gère la commande REHASH, réservée aux opérateurs IRC */
+        void handleRehashCommand(Client *client, const IrcMessage &message);
 
 
         /*   -'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-',-'   */
@@ -254,6 +352,9 @@ class Server
         /* Gestion des signaux */
         static void handleSignal(int signal);
 
+        /* SIGHUP : demande le rechargement des règles du bot */
+        static void handleReloadSignal(int signal);
+
         /* Ferme tous les clients et le socket d'écoute */
         void shutdown();
 
@@ -266,8 +367,24 @@ class Server
         static const int PING_INTERVAL = 60;
         static const int PING_RESPONSE_DELAY = 15;
 
+        /* Délai accordé à une connexion pour s'enregistrer, en secondes */
+        static const int REGISTRATION_TIMEOUT = 30;
+
         /* Envoie un message PING à tous les clients */
-        bool send_message(const std::string &message, int sender_fd);
+        bool send_message(const std::string &message, Client *client);
+
+        /* Place un message dans la file d'envoi du client et tente de l'envoyer */
+        void sendToClient(Client *client, const std::string &message);
+
+        /* Place un message partagé dans la file d'envoi du client, sans le copier */
+        void sendToClient(Client *client, const SharedPayload &payload);
+
+        /* Copie une réponse composée en place dans la file d'envoi du client */
+        void sendToClient(Client *client, const IrcReply &reply);
+
+        /* Diffuse un message à tous les membres du canal, sauf `except`, avec une seule copie */
+        void broadcastToChannel(Channel *channel, const std::string &message, Client *except = NULL);
+        void broadcastToChannel(Channel *channel, const IrcReply &reply, Client *except = NULL);
 
         std::string getBackgroundColorCode(int socket);
 
@@ -288,20 +405,53 @@ class Server
         /* Nom du serveur */
         std::string _serverName;
 
-        /* Socket d'écoute */
-        int _listenSocket;
+        /* Options de démarrage */
+        ServerConfig _config;
+
+        /**
+         * Boucles d'événements, une par thread (--reactors). Chacune possède
+         * son socket d'écoute et ses clients ; la boucle 0 tourne sur le thread principal.
+         */
+        std::vector<ReactorLoop*> _loops;
+
+        /**
+         * Shards d'exécution des commandes de canal (--shards), vide pour
+         * exécuter ces commandes sur la boucle qui les a lues.
+         */
+        std::vector<ChannelShard*> _shards;
+
+        /* Travailleurs de diffusion des canaux au-delà de --fanout-threshold membres */
+        FanoutEngine _fanout;
+
+        /* Anneau et fil d'état du mode pipeline, NULL si --pipeline=off */
+        CommandPipeline *_pipeline;
+
+        /**
+         * Verrou des canaux sans shards : membres et modes, bot compris.
+         * Pris pour toute la commande qui touche un canal, et pour retirer
+         * un client détruit de ses canaux. Avec --shards, chaque shard a le
+         * sien. Toujours pris avant _nickLock.
+         */
+        pthread_mutex_t _channelLock;
+
+        /**
+         * Verrou des pseudonymes : l'index, et le pseudonyme d'un client lu
+         * par une autre boucle. Un client trouvé dans l'index n'est utilisé
+         * que sous ce verrou. Récursif : removeClient() le prend sous NICK.
+         */
+        pthread_mutex_t _nickLock;
 
-        /* Ensemble maître des fd */
-        fd_set _masterSet;
+        /* Verrou du cache d'accueil, remplacé par REHASH pendant qu'une autre boucle l'envoie */
+        pthread_mutex_t _welcomeLock;
 
-        /* Valeur maximale de fd */
-        int _fdMax;
+        /* Verrou de l'index et des slabs des canaux, partagés par les shards ; pris en dernier */
+        pthread_mutex_t _channelIndexLock;
 
-        /* Liste des canaux du serveur */
-        std::map<std::string, Channel*> _channels;
+        /* Canaux du serveur, indexés par nom replié (rfc1459), sous _channelIndexLock */
+        HashMap<std::string, Channel*, StringHash> _channels;
 
-        /* Liste des clients connectés */
-        std::vector<Client*> _clients;
+        /* Slabs des objets Channel, sous _channelIndexLock */
+        ObjectPool<Channel> _channelPool;
 
         /* Bot associé au serveur */
         Bot _bot;
@@ -309,13 +459,91 @@ class Server
         /* Adresse IP du serveur */
         std::string _serverIp;
 
-        /* Liste des clients à supprimer */
-        std::vector<Client*> _clientsToRemove;
+        /* Table de dispatch des commandes, avec leurs compteurs d'appels */
+        CommandTable _commands;
+
+        /* Index des pseudonymes repliés (rfc1459), sous _nickLock, pour résoudre un pseudonyme sans parcourir _clients */
+        HashMap<std::string, Client*, StringHash> _nicknames;
+
+        /* Réponses 002 à 005 et MOTD, rendues sans pseudonyme, sous _welcomeLock */
+        WelcomeCache _welcome;
+
+        /* Positionné par SIGHUP, traité par la boucle d'événements */
+        static volatile sig_atomic_t _reloadRequested;
 
         std::string formatPingPongMessage(const std::string& client_id, const std::string& command, const std::string& param);
 
+        /* Ecrit la file d'envoi du client jusqu'à EAGAIN */
+        void flushClient(Client *client);
+
+        /* Ecrit la file d'envoi par writev(), retourne false si la connexion est rompue */
+        bool writeOutput(Client *client);
+
+        /* Envoie en un seul writev() les réponses accumulées pendant l'itération */
+        void flushPendingClients(ReactorLoop &loop);
+
+        /* Reprend la lecture des clients interrompus par leur budget de lecture */
+        void serviceReadBacklog(ReactorLoop &loop);
+
+        /* Crée le socket d'écoute de la boucle */
+        void openListener(ReactorLoop &loop);
+
+        /* Vérifie qu'une liste de processeurs est permise au processus */
+        void checkCpus(const CpuTopology &topology, const std::vector<int> &cpus, const std::string &option);
 
+        /* Boucle d'événements d'un thread, jusqu'à l'arrêt du processus */
+        void runLoop(ReactorLoop &loop);
 
+        /* Point d'entrée des threads des boucles 1 à N - 1 */
+        static void *loopThread(void *arg);
+
+        /* Place dans les files d'envoi les messages déposés par les autres boucles */
+        void deliverMessages(ReactorLoop &loop);
+
+        /* Diffuse un bloc aux membres d'un canal, en ligne ou par les travailleurs */
+        void broadcastPayload(Channel *channel, const SharedPayload &payload, Client *except);
+
+        /* Exécute les commandes confiées à un shard, jusqu'à l'arrêt du processus */
+        void runShard(ChannelShard &shard);
+
+        /* Point d'entrée des threads des shards */
+        static void *shardThread(void *arg);
+
+        /* Exécute les commandes publiées dans l'anneau du pipeline, jusqu'à l'arrêt du processus */
+        void runPipeline();
+
+        /* Point d'entrée du fil d'état */
+        static void *pipelineThread(void *arg);
+
+        /* Après un ajout à la file d'envoi : limite de la file, puis envoi de fin d'itération */
+        void scheduleFlush(Client *client);
+
+        /* Retourne l'horloge monotone en secondes, telle que lue par la boucle courante en début d'itération */
+        time_t now() const;
+
+        /* Arme le minuteur du client `seconds` secondes après l'instant courant */
+        void armKeepalive(Client *client, time_t seconds);
+
+        /* Avance la roue des minuteurs et traite les échéances */
+        void runTimers(ReactorLoop &loop);
+
+        /* Echéance du client : fin du délai d'enregistrement, PING à envoyer ou PONG manquant */
+        void handleKeepaliveTimer(Client *client);
+
+        /* Envoie ERROR au client et le retire du serveur */
+        void closeLink(Client *client, const std::string &reason);
+
+        /* Surveille le socket en écriture tant que la file d'envoi n'est pas vide */
+        void updateWriteInterest(Client *client);
+
+        /* Surveille le socket en lecture sauf s'il est fermé en lecture ou suspendu */
+        void updateReadInterest(Client *client);
+
+        /* Supprime les clients retirés pendant l'itération */
+        void purgeRemovedClients(ReactorLoop &loop);
 };
 
+/* Découpe une liste séparée par `delimiter`, sans les éléments vides */
+std::vector<std::string> splitArg(const std::string &s, char delimiter);
+
 #endif /* SERVER_HPP */
@@ -0,0 +1,99 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   ServerConfig.hpp                                   :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: raveriss <raveriss@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/11/20 15:04:29 by raveriss          #+#    #+#             */
+/*   Updated: 2024/11/20 15:04:29 by raveriss         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef SERVERCONFIG_HPP
+#define SERVERCONFIG_HPP
+
+/* For std::string */
+#include <string>
+
+/* For std::vector */
+#include <vector>
+
+/* Taille par défaut du tampon de réception partagé */
+#define DEFAULT_RECV_BUFFER_SIZE (16 * 1024)
+
+/* Octets lus au plus par client et par tour de boucle */
+#define DEFAULT_READ_BUDGET (64 * 1024)
+
+/* Travailleurs de diffusion des grands canaux */
+#define DEFAULT_FANOUT_WORKERS 4
+
+/**
+ * class ServerConfig
+ *
+ * Options de démarrage passées après <port> <password>,
+ * sous la forme --nom=valeur.
+ */
+class ServerConfig
+{
+    public:
+
+        /* Constructeur, valeurs par défaut */
+        ServerConfig();
+
+        /**
+         * Interprète une option de la ligne de commande.
+         * Retourne false si l'option est inconnue ou sa valeur invalide.
+         */
+        bool parseArgument(const std::string &arg);
+
+        /* Rappel des options reconnues, pour le message d'usage */
+        static const char *usage();
+
+        /* Backend de la boucle d'événements : "epoll" ou "select" */
+        std::string reactorBackend;
+
+        /* Taille du tampon de réception partagé par tous les clients */
+        size_t recvBufferSize;
+
+        /* Octets lus au plus par client avant de passer au suivant */
+        size_t readBudget;
+
+        /* Fichier de règles du bot, vide pour les règles par défaut */
+        std::string rulesFile;
+
+        /* Mot de passe de la commande OPER, vide pour la désactiver */
+        std::string operPassword;
+
+        /* Fichier du MOTD, vide pour le message par défaut */
+        std::string motdFile;
+
+        /* Nombre maximal de clients, préalloués au démarrage ; 0 pour aucune limite */
+        size_t maxClients;
+
+        /* Nombre de boucles d'événements, chacune sur son thread et son socket d'écoute */
+        size_t reactors;
+
+        /* Nombre de shards des commandes de canal ; 0 pour les exécuter sur la boucle du client */
+        size_t shards;
+
+        /* Membres à partir desquels un canal diffuse par les travailleurs ; 0 pour toujours diffuser en ligne */
+        size_t fanoutThreshold;
+
+        /* Nombre de travailleurs de diffusion */
+        size_t fanoutWorkers;
+
+        /* Toutes les commandes exécutées par un fil d'état unique, analysées par les boucles */
+        bool pipeline;
+
+        /* Processeurs des boucles d'événements, attribués dans l'ordre ; vide pour ne pas épingler */
+        std::vector<int> reactorCpus;
+
+        /* Processeurs des shards ou du fil d'état du pipeline */
+        std::vector<int> shardCpus;
+
+        /* Processeurs des travailleurs de diffusion */
+        std::vector<int> workerCpus;
+};
+
+#endif /* SERVERCONFIG_HPP */
@@ -0,0 +1,91 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   SharedPayload.hpp                                  :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: raveriss <raveriss@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/11/23 10:14:52 by raveriss          #+#    #+#             */
+/*   Updated: 2024/11/23 10:14:52 by raveriss         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef SHAREDPAYLOAD_HPP
+#define SHAREDPAYLOAD_HPP
+
+/* For std::string */
+#include <string>
+
+/* For size_t */
+#include <cstddef>
+
+/**
+ * Message immuable partagé entre les files d'envoi de ses destinataires.
+ * Une diffusion sur un canal alloue une seule copie du message : chaque
+ * file ne retient qu'un pointeur, et le dernier détenteur libère le bloc.
+ * Le compteur est atomique : les destinataires peuvent vivre sur plusieurs boucles.
+ */
+class SharedPayload
+{
+    public:
+
+        /* Message vide, sans allocation */
+        SharedPayload();
+
+        /* Copie `data` dans un nouveau bloc partagé */
+        explicit SharedPayload(const std::string &data);
+
+        /* Copie `length` octets dans un nouveau bloc partagé */
+        SharedPayload(const char *data, size_t length);
+
+        /* Bloc vide pouvant recevoir `capacity` octets par append() */
+        static SharedPayload withCapacity(size_t capacity);
+
+        /* Partage le bloc de `other` */
+        SharedPayload(const SharedPayload &other);
+
+        /* Partage le bloc de `other` et libère l'ancien */
+        SharedPayload &operator=(const SharedPayload &other);
+
+        /* Libère le bloc si c'est la dernière référence */
+        ~SharedPayload();
+
+        /* Retourne les octets du message */
+        const char *data() const;
+
+        /* Retourne la taille du message */
+        size_t size() const;
+
+        /* Retourne true si le message est vide */
+        bool empty() const;
+
+        /* Retourne le nombre de détenteurs du bloc */
+        size_t useCount() const;
+
+        /**
+         * Ajoute des octets en fin de bloc, si celui-ci n'est pas partagé et a
+         * la place nécessaire. Retourne false sinon, sans rien modifier.
+         */
+        bool append(const char *data, size_t length);
+
+    private:
+
+        /* En-tête du bloc, suivi des octets du message dans la même allocation */
+        struct Block
+        {
+            size_t refs;
+            size_t size;
+            size_t capacity;
+        };
+
+        /* Bloc partagé, NULL pour un message vide */
+        Block *_block;
+
+        /* Abandonne la référence sur le bloc courant */
+        void release();
+
+        /* Alloue un bloc de `capacity` octets, détenu une fois et vide */
+        static Block *allocate(size_t capacity);
+};
+
+#endif /* SHAREDPAYLOAD_HPP */
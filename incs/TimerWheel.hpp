@@ -0,0 +1,112 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   TimerWheel.hpp                                     :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: raveriss <raveriss@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/11/23 15:41:07 by raveriss          #+#    #+#             */
+/*   Updated: 2024/11/23 15:41:07 by raveriss         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef TIMERWHEEL_HPP
+#define TIMERWHEEL_HPP
+
+/* For std::vector */
+#include <vector>
+
+/* For uint64_t */
+#include <stdint.h>
+
+/* For size_t, NULL */
+#include <cstddef>
+
+/* Durée d'un tick de la roue en millisecondes */
+#define TIMER_TICK_MS 1000
+
+/* Chaque niveau compte 2^TIMER_WHEEL_BITS cases */
+#define TIMER_WHEEL_BITS 6
+#define TIMER_WHEEL_SLOTS (1 << TIMER_WHEEL_BITS)
+#define TIMER_WHEEL_MASK (TIMER_WHEEL_SLOTS - 1)
+
+/* Nombre de niveaux : 64 s, ~68 min et ~3 jours à un tick par seconde */
+#define TIMER_WHEEL_LEVELS 3
+
+/**
+ * Minuteur intrusif, intégré à l'objet qu'il surveille.
+ * Chaînage double : armer et annuler se font en temps constant.
+ */
+struct TimerNode
+{
+    TimerNode *prev;
+    TimerNode *next;
+
+    /* Tick d'échéance */
+    uint64_t expires;
+
+    /* Objet propriétaire, rendu à l'échéance */
+    void *owner;
+
+    TimerNode() : prev(NULL), next(NULL), expires(0), owner(NULL) {}
+
+    /* Retourne true si le minuteur est en attente dans une roue */
+    bool armed() const { return prev != NULL; }
+};
+
+/**
+ * Roue de minuteurs hiérarchique : le premier niveau compte les ticks,
+ * les suivants des tours entiers du niveau inférieur. Un minuteur lointain
+ * redescend d'un niveau à chaque tour, sans jamais parcourir les autres.
+ */
+class TimerWheel
+{
+    public:
+
+        /* Démarre la roue à l'instant `nowMs` */
+        explicit TimerWheel(uint64_t nowMs);
+
+        /* Retourne l'horloge monotone en millisecondes */
+        static uint64_t monotonicMs();
+
+        /* Arme (ou réarme) le minuteur pour l'instant `expiresMs`, jamais avant le prochain tick */
+        void schedule(TimerNode *node, uint64_t expiresMs);
+
+        /* Désarme le minuteur s'il est en attente */
+        void cancel(TimerNode *node);
+
+        /* Avance jusqu'à `nowMs` et ajoute à `expired` les minuteurs échus, désarmés */
+        void advance(uint64_t nowMs, std::vector<TimerNode*> &expired);
+
+        /* Retourne le délai d'attente jusqu'au prochain tick, `maxMs` si la roue est vide */
+        int timeoutMs(uint64_t nowMs, int maxMs) const;
+
+        /* Retourne le nombre de minuteurs armés */
+        size_t size() const;
+
+    private:
+
+        /* Cases de la roue : chacune est la sentinelle d'une liste circulaire */
+        TimerNode _slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+
+        /* Dernier tick traité */
+        uint64_t _now;
+
+        /* Nombre de minuteurs armés */
+        size_t _count;
+
+        /* Les sentinelles pointent sur elles-mêmes : copie interdite */
+        TimerWheel(const TimerWheel &other);
+        TimerWheel &operator=(const TimerWheel &other);
+
+        /* Range le minuteur dans la case correspondant à son échéance */
+        void place(TimerNode *node);
+
+        /* Redistribue une case d'un niveau supérieur vers les niveaux inférieurs */
+        void cascade(int level, size_t slot);
+
+        /* Détache le minuteur de sa liste */
+        static void unlink(TimerNode *node);
+};
+
+#endif /* TIMERWHEEL_HPP */
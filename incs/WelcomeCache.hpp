@@ -0,0 +1,72 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   WelcomeCache.hpp                                   :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: raveriss <raveriss@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/11/25 14:18:21 by raveriss          #+#    #+#             */
+/*   Updated: 2024/11/25 14:18:21 by raveriss         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef WELCOMECACHE_HPP
+#define WELCOMECACHE_HPP
+
+/* For std::string */
+#include <string>
+
+/* For std::vector */
+#include <vector>
+
+/* For IrcReply */
+#include "IrcReply.hpp"
+
+/**
+ * Réponses de bienvenue (002 à 005, MOTD) rendues une fois pour toutes.
+ * Seul le pseudonyme dépend du client : chaque ligne est conservée en deux
+ * morceaux, avant et après le pseudonyme, et recollée à l'envoi.
+ */
+class WelcomeCache
+{
+    public:
+
+        /* Cache vide */
+        WelcomeCache();
+
+        /**
+         * Ajoute une ligne rendue avec un pseudonyme vide : le pseudonyme sera
+         * inséré après les `headLength` premiers octets. Le CRLF final est retiré.
+         */
+        void add(const IrcReply &line, size_t headLength);
+
+        /* Retourne le nombre de lignes */
+        size_t size() const;
+
+        /* Compose la ligne `index` pour `nickname` */
+        void write(size_t index, const std::string &nickname, IrcReply &reply) const;
+
+        /* Echange le contenu avec `other`, pour remplacer le cache d'un bloc */
+        void swap(WelcomeCache &other);
+
+        /* Lit le fichier MOTD par mmap() et le découpe en lignes, sans les CR/LF */
+        static bool readMotd(const std::string &path, std::vector<std::string> &lines, std::string &error);
+
+    private:
+
+        /* Position d'une ligne dans _text */
+        struct Line
+        {
+            size_t offset;
+            size_t headLength;
+            size_t length;
+        };
+
+        /* Texte de toutes les lignes, sans CRLF, à la suite */
+        std::string _text;
+
+        /* Lignes, dans l'ordre d'envoi */
+        std::vector<Line> _lines;
+};
+
+#endif /* WELCOMECACHE_HPP */
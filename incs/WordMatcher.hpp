@@ -0,0 +1,78 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   WordMatcher.hpp                                    :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: raveriss <raveriss@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/11/24 11:06:38 by raveriss          #+#    #+#             */
+/*   Updated: 2024/11/24 11:06:38 by raveriss         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef WORDMATCHER_HPP
+#define WORDMATCHER_HPP
+
+/* For std::string */
+#include <string>
+
+/* For std::vector */
+#include <vector>
+
+/* Symboles de l'automate : 26 lettres, 10 chiffres et la frontière de mot */
+#define WORD_MATCHER_SYMBOLS 37
+
+/* Symbole de tout octet non alphanumérique */
+#define WORD_MATCHER_BOUNDARY 0
+
+/**
+ * Automate d'Aho-Corasick reconnaissant une liste de mots entiers.
+ * Chaque mot est compilé entouré de frontières, et les lettres sont repliées
+ * en minuscules par la table des symboles : l'analyse d'une ligne est une
+ * seule lecture de ses octets, une transition par octet, sans allocation,
+ * quel que soit le nombre de mots.
+ */
+class WordMatcher
+{
+    public:
+
+        /* Automate vide */
+        WordMatcher();
+
+        /* Ajoute un mot ; l'automate doit être recompilé */
+        void add(const std::string &word);
+
+        /* Construit les transitions complètes à partir des mots ajoutés */
+        void compile();
+
+        /* Retourne true si le texte contient un des mots, délimité par des frontières */
+        bool matches(const char *data, size_t length) const;
+
+        /* Retourne le nombre de mots ajoutés */
+        size_t size() const;
+
+        /* Retire tous les mots */
+        void clear();
+
+    private:
+
+        /* Table des symboles : octet vers lettre minuscule, chiffre ou frontière */
+        static const unsigned char _symbols[256];
+
+        /* Mots ajoutés depuis le dernier clear() */
+        std::vector<std::string> _words;
+
+        /* Transitions : _next[état * WORD_MATCHER_SYMBOLS + symbole] */
+        std::vector<int> _next;
+
+        /* Etats terminaux, y compris par leurs liens d'échec */
+        std::vector<char> _accept;
+
+        /* Etat atteint après la frontière de début de ligne */
+        int _start;
+
+        /* Ajoute un état sans transition, retourne son numéro */
+        int newState();
+};
+
+#endif /* WORDMATCHER_HPP */
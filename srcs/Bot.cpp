@@ -14,19 +14,28 @@
 #include "../incs/Bot.hpp"
 #include "../incs/Client.hpp"
 #include "../incs/Channel.hpp"
+#include "../incs/Server.hpp"
 
-/* For std::transform */
+/* For CpuTopology::unpinCurrentThread() */
+#include "../incs/CpuTopology.hpp"
+
+/* For pthread_create() */
+#include <pthread.h>
+
+/* For std::swap */
 #include <algorithm>
 
 /**
  * Constructeur du bot, il definit les mots interdits
  */
-Bot::Bot()
+Bot::Bot(Server &server)
+: _server(server), _rules(new RuleSet()), _pendingRules(NULL), _reloading(0)
 {
+    pthread_rwlock_init(&_rulesLock, NULL);
+    pthread_mutex_init(&_warningsLock, NULL);
+
     /* Initialize with some default forbidden words */
-    _forbiddenWords.insert("salade");
-    _forbiddenWords.insert("tomate");
-    _forbiddenWords.insert("oignon");
+    _rules->loadDefaults();
 }
 
 /**
@@ -35,54 +44,48 @@ Bot::Bot()
  */
 Bot::~Bot()
 {
-    _forbiddenWords.clear();
+    delete _rules;
+    delete _pendingRules;
     _warnings.clear();
+    pthread_rwlock_destroy(&_rulesLock);
+    pthread_mutex_destroy(&_warningsLock);
 }
 
 /**
- * Convertit le message en minuscule, remplace les caracteres non alphanumeriques
- * par des espaces et decoupe le message en mots distincts.
- * Puis il verifie le message du client mot par mot, si un mot interdit est trouve et que
- * le client n'a pas encore recu d'avertissement, il envoie un avertissement.
+ * Parcourt les paramètres qui suivent le canal, directement dans la vue du
+ * message : l'automate lit chaque octet une fois et reconnaît les mots
+ * interdits entiers, sans distinction de casse. Si un mot interdit est trouve
+ * et que le client n'a pas encore recu d'avertissement, il envoie un avertissement.
  * Si le client a deja recu un avertissement, il est expulse du canal.
  */
-void Bot::handleMessage(Client *client, Channel *channel, const std::string &message)
+void Bot::handleMessage(Client *client, Channel *channel, const IrcMessage &message)
 {
-    /* Convertir le message en minuscule */
-    std::string lowerMessage = message;
-    std::transform(lowerMessage.begin(), lowerMessage.end(), lowerMessage.begin(), ::tolower);
-
-    /* Remplacer tous les caractères non alphanumériques par des espaces */
-    for (size_t i = 0; i < lowerMessage.size(); ++i)
+    /* Le jeu de règles peut être remplacé par la boucle 0 pendant la lecture */
+    bool matched = false;
+    pthread_rwlock_rdlock(&_rulesLock);
+    for (size_t p = 1; p < message.paramCount() && !matched; ++p)
     {
-        if (!isalnum(lowerMessage[i]) && !isspace(lowerMessage[i]))
-        {
-            lowerMessage[i] = ' ';
-        }
+        IrcSlice text = message.param(p);
+        matched = _rules->matches(channel->getFoldedName(), text.data, text.length);
     }
+    pthread_rwlock_unlock(&_rulesLock);
+    if (!matched)
+        return;
 
-    /* Découper le message en mots distincts */
-    std::istringstream iss(lowerMessage);
-    std::string word;
+    /* Un client peut récidiver sur deux canaux de shards différents en même temps */
+    bool warned;
+    pthread_mutex_lock(&_warningsLock);
+    warned = (_warnings[client->getSerial()] != 0);
+    if (warned)
+        _warnings.erase(client->getSerial());
+    else
+        _warnings[client->getSerial()]++;
+    pthread_mutex_unlock(&_warningsLock);
 
-    while (iss >> word)
-    {
-        /* Si le mot figure dans la liste des mots interdits */
-        if (!word.empty() && _forbiddenWords.find(word) != _forbiddenWords.end())
-        {
-            if (_warnings[client] == 0)
-            {
-                sendWarning(client, channel);
-                _warnings[client]++;
-            }
-            else
-            {
-                kickClient(client, channel);
-                _warnings.erase(client);
-            }
-            return;
-        }
-    }
+    if (warned)
+        kickClient(client, channel);
+    else
+        sendWarning(client, channel);
 }
 
 /**
@@ -93,13 +96,9 @@ void Bot::handleMessage(Client *client, Channel *channel, const std::string &mes
 void Bot::sendWarning(Client *client, Channel *channel)
 {
     std::string warningMessage = "WARNING: Inappropriate language detected. Further violations will result in a kick.";
-    std::string message = ":" + client->getNickname() + " PRIVMSG " + channel->getName() + " :" + warningMessage + "\r\n";
+    IrcReply message = IrcMessageBuilder::buildPrivmsgMessage(client->getPrefix(), channel->getName(), warningMessage);
 
-    const std::vector<Client*> &clients = channel->getClients();
-    for (std::vector<Client*>::const_iterator it = clients.begin(); it != clients.end(); ++it)
-    {
-        send((*it)->getSocket(), message.c_str(), message.length(), 0);
-    }
+    _server.broadcastToChannel(channel, message);
 }
 
 /**
@@ -120,13 +119,110 @@ void Bot::kickClient(Client *client, Channel *channel)
     std::string kickMessage = ":" + botNickname + " KICK " + channel->getName() + " " + client->getNickname() + " :You have been kicked for inappropriate language.\r\n";
 
     /* Envoyer le message de kick à tous les clients du canal */
-    const std::vector<Client*> &channelClients = channel->getClients();
-    for (std::vector<Client*>::const_iterator it = channelClients.begin(); it != channelClients.end(); ++it)
-    {
-        send((*it)->getSocket(), kickMessage.c_str(), kickMessage.length(), 0);
-    }
+    _server.broadcastToChannel(channel, kickMessage);
 
     /* Retirer le client du canal */
     channel->removeClient(client);
     client->leaveChannel(channel);
 }
+
+/**
+ * Charge le fichier de règles au démarrage, avant la boucle d'événements.
+ * Le chemin est retenu pour les rechargements.
+ */
+bool Bot::loadRules(const std::string &path, std::string &error)
+{
+    RuleSet *rules = new RuleSet();
+    if (!rules->loadFile(path))
+    {
+        error = rules->error();
+        delete rules;
+        return false;
+    }
+
+    pthread_rwlock_wrlock(&_rulesLock);
+    std::swap(_rules, rules);
+    pthread_rwlock_unlock(&_rulesLock);
+    delete rules;
+    _rulesPath = path;
+    return true;
+}
+
+/**
+ * Lance la compilation du fichier de règles hors de la boucle d'événements.
+ * Un seul rechargement à la fois : une demande pendant la compilation est ignorée.
+ */
+bool Bot::requestReload()
+{
+    if (_rulesPath.empty())
+        return false;
+    if (__sync_lock_test_and_set(&_reloading, 1))
+        return false;
+
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, &Bot::compileRules, this) != 0)
+    {
+        __sync_lock_release(&_reloading);
+        return false;
+    }
+    pthread_detach(thread);
+    return true;
+}
+
+/**
+ * Compile le fichier de règles dans un jeu neuf, puis le publie d'un seul
+ * échange de pointeur : la boucle d'événements ne voit jamais un jeu à moitié
+ * construit, et ne bloque jamais sur la lecture du fichier.
+ */
+void *Bot::compileRules(void *arg)
+{
+    Bot *bot = static_cast<Bot *>(arg);
+
+    /* Créé par une boucle peut-être épinglée : ne lui dispute pas son processeur */
+    (void)CpuTopology::unpinCurrentThread();
+
+    RuleSet *rules = new RuleSet();
+    rules->loadFile(bot->_rulesPath);
+
+    /* Barrière complète : le jeu est entièrement écrit avant d'être publié */
+    __sync_synchronize();
+    (void)__sync_lock_test_and_set(&bot->_pendingRules, rules);
+    return NULL;
+}
+
+/**
+ * Installe le jeu de règles publié par le thread de rechargement, s'il y en a
+ * un. Un jeu en échec est écarté et les règles en vigueur sont conservées.
+ */
+void Bot::applyPendingRules()
+{
+    RuleSet *rules = __sync_lock_test_and_set(&_pendingRules, static_cast<RuleSet *>(NULL));
+    if (rules == NULL)
+        return;
+
+    if (!rules->error().empty())
+    {
+        std::cerr << "Rechargement des règles échoué : " << rules->error() << std::endl;
+        delete rules;
+    }
+    else
+    {
+        std::cout << "Règles rechargées depuis " << _rulesPath << " : " << rules->globalCount()
+                  << " mots globaux, " << rules->channelCount() << " canaux" << std::endl;
+
+        /* Les lecteurs en cours finissent avec l'ancien jeu, détruit une fois l'échange fait */
+        pthread_rwlock_wrlock(&_rulesLock);
+        std::swap(_rules, rules);
+        pthread_rwlock_unlock(&_rulesLock);
+        delete rules;
+    }
+    __sync_lock_release(&_reloading);
+}
+
+/**
+ * @return the path of the rule file, empty when the default rules are used
+ */
+const std::string &Bot::getRulesPath() const
+{
+    return _rulesPath;
+}
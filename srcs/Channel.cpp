@@ -13,12 +13,19 @@
 /* Inclusions pour les canaux et les clients */
 #include "../incs/Channel.hpp"
 #include "../incs/Client.hpp"
+#include "../incs/Casemap.hpp"
+#include "../incs/ReactorLoop.hpp"
+
+/* For std::ostringstream */
+#include <sstream>
 
 /**
  * Constructor
  */
 Channel::Channel(const std::string &name)
-: _name(name), _userLimit(0), _hasTopic(false)
+: _name(name), _foldedName(Casemap::fold(name)), _fanoutPlan(NULL), _fanoutDrain(NULL),
+  _parallelFanout(false), _modes(0), _modeString("+"),
+  _userLimit(0), _hasTopic(false)
 {}
 
 /**
@@ -31,6 +38,10 @@ Channel::~Channel()
         (*it)->leaveChannel(this);
     }
     _clients.clear();
+    _fanoutTargets.clear();
+    dropFanoutPlan();
+    if (_fanoutDrain != NULL)
+        _fanoutDrain->release();
 }
 
 /**
@@ -41,13 +52,34 @@ const std::string &Channel::getName() const
     return _name;
 }
 
+/**
+ * @return the rfc1459 folded name of the channel
+ */
+const std::string &Channel::getFoldedName() const
+{
+    return _foldedName;
+}
+
 /**
  * Add a client to the channel
  */
 void Channel::addClient(Client *client)
 {
-    if (!hasClient(client))
-        _clients.push_back(client);
+    if (hasClient(client))
+        return;
+
+    Membership membership;
+    membership.flags = 0;
+    membership.index = _clients.size();
+    _members.set(client, membership);
+    _clients.push_back(client);
+
+    FanoutTarget target;
+    target.fd = client->getSocket();
+    target.serial = client->getSerial();
+    target.loop = client->getLoop()->index;
+    _fanoutTargets.push_back(target);
+    dropFanoutPlan();
 }
 
 /**
@@ -55,16 +87,26 @@ void Channel::addClient(Client *client)
  */
 void Channel::removeClient(Client *client)
 {
+    Membership *membership = _members.find(client);
 
-    /* Suppression du client de la liste des clients */
-    _clients.erase(std::remove(_clients.begin(), _clients.end(), client), _clients.end());
-
-    /* Suppression du client de la liste des opérateurs */
-    if (_operators.erase(client) > 0)
-        std::cout << "\033[0mClient supprimé de _operators" << std::endl;
+    /* Suppression du client de la liste des clients, en déplaçant le dernier à sa place */
+    if (membership != NULL)
+    {
+        if (membership->flags & MEMBER_OPERATOR)
+            std::cout << "\033[0mClient supprimé des opérateurs" << std::endl;
+
+        Client *last = _clients.back();
+        _clients[membership->index] = last;
+        _fanoutTargets[membership->index] = _fanoutTargets.back();
+        _members.find(last)->index = membership->index;
+        _clients.pop_back();
+        _fanoutTargets.pop_back();
+        _members.erase(client);
+        dropFanoutPlan();
+    }
 
     /* Suppression du client de la liste des invités */
-    if (_invitedClients.erase(client) > 0)
+    if (_invitedClients.erase(client->getSerial()) > 0)
         std::cout << "\033[0mClient supprimé de _invitedClients" << std::endl;
 }
 
@@ -73,7 +115,7 @@ void Channel::removeClient(Client *client)
  */
 bool Channel::hasClient(Client *client) const
 {
-    return std::find(_clients.begin(), _clients.end(), client) != _clients.end();
+    return _members.find(client) != NULL;
 }
 
 /**
@@ -84,12 +126,94 @@ const std::vector<Client*> &Channel::getClients() const
     return _clients;
 }
 
+/**
+ * @return the fd, serial and loop of every member, in getClients() order
+ */
+const std::vector<FanoutTarget> &Channel::getFanoutTargets() const
+{
+    return _fanoutTargets;
+}
+
+/**
+ * Build the plan on the first broadcast after a membership change; the
+ * following broadcasts share it with the workers still delivering it.
+ * @return the plan of the current members
+ */
+FanoutPlan *Channel::getFanoutPlan(const FanoutEngine &engine)
+{
+    if (_fanoutPlan == NULL)
+        _fanoutPlan = engine.makePlan(_fanoutTargets);
+    return _fanoutPlan;
+}
+
+/**
+ * @return the in-flight counter of the channel, NULL before its first switch to the workers
+ */
+FanoutDrain *Channel::getFanoutDrain() const
+{
+    return _fanoutDrain;
+}
+
+/**
+ * @return true if broadcasts to this channel go through the fanout workers
+ */
+bool Channel::usesParallelFanout() const
+{
+    return _parallelFanout;
+}
+
+/**
+ * Route every later broadcast through the fanout workers
+ */
+void Channel::enableParallelFanout()
+{
+    if (_fanoutDrain == NULL)
+        _fanoutDrain = new FanoutDrain;
+    _parallelFanout = true;
+}
+
+/**
+ * Route later broadcasts inline again, but only once every block posted by
+ * the workers has been queued by its loop: a message posted by a worker
+ * must not be overtaken by a later one queued inline.
+ * @return true if the channel went back to inline delivery
+ */
+bool Channel::disableParallelFanout()
+{
+    if (!_fanoutDrain->drained())
+        return false;
+    _parallelFanout = false;
+    dropFanoutPlan();
+    return true;
+}
+
+/**
+ * Forget the plan, freed by whoever drops its last reference
+ */
+void Channel::dropFanoutPlan()
+{
+    if (_fanoutPlan == NULL)
+        return;
+    _fanoutPlan->release();
+    _fanoutPlan = NULL;
+}
+
+/**
+ * @return the status flags of the client, 0 if it is not a member
+ */
+unsigned int Channel::getMemberFlags(Client *client) const
+{
+    const Membership *membership = _members.find(client);
+    return membership ? membership->flags : 0;
+}
+
 /**
  * Set a mode to the channel
  */
 void Channel::setMode(char mode)
 {
-    _modes.insert(mode);
+    _modes |= modeBit(mode);
+    updateModeString();
 }
 
 /**
@@ -97,7 +221,8 @@ void Channel::setMode(char mode)
  */
 void Channel::unsetMode(char mode)
 {
-    _modes.erase(mode);
+    _modes &= ~modeBit(mode);
+    updateModeString();
 }
 
 /**
@@ -105,7 +230,64 @@ void Channel::unsetMode(char mode)
  */
 bool Channel::hasMode(char mode) const
 {
-    return _modes.find(mode) != _modes.end();
+    return (_modes & modeBit(mode)) != 0;
+}
+
+/**
+ * @return the active modes, e.g. "+itkl"
+ */
+const std::string &Channel::getModeString() const
+{
+    return _modeString;
+}
+
+/**
+ * @return the parameters of the active modes, e.g. " key 10"
+ */
+const std::string &Channel::getModeParams() const
+{
+    return _modeParams;
+}
+
+/**
+ * @return the bit of the mode, 0 if the mode is not supported
+ */
+unsigned int Channel::modeBit(char mode)
+{
+    switch (mode)
+    {
+        case 'i': return CHANNEL_MODE_INVITE;
+        case 't': return CHANNEL_MODE_TOPIC;
+        case 'k': return CHANNEL_MODE_KEY;
+        case 'l': return CHANNEL_MODE_LIMIT;
+        default: return 0;
+    }
+}
+
+/**
+ * Rebuild the cached mode string and its parameters, only on mode changes
+ */
+void Channel::updateModeString()
+{
+    _modeString = "+";
+    _modeParams.clear();
+
+    if (_modes & CHANNEL_MODE_INVITE)
+        _modeString += 'i';
+    if (_modes & CHANNEL_MODE_TOPIC)
+        _modeString += 't';
+    if (_modes & CHANNEL_MODE_KEY)
+    {
+        _modeString += 'k';
+        _modeParams += " " + _key;
+    }
+    if (_modes & CHANNEL_MODE_LIMIT)
+    {
+        std::ostringstream oss;
+        oss << _userLimit;
+        _modeString += 'l';
+        _modeParams += " " + oss.str();
+    }
 }
 
 /**
@@ -139,7 +321,7 @@ bool Channel::checkKey(const std::string &key) const
  */
 bool Channel::hasKey() const
 {
-    return hasMode('k');
+    return (_modes & CHANNEL_MODE_KEY) != 0;
 }
 
 /* Gestion de la limite d'utilisateurs */
@@ -171,7 +353,7 @@ int Channel::getUserLimit() const
  */
 bool Channel::isFull() const
 {
-    return hasMode('l') && static_cast<int>(_clients.size()) >= _userLimit;
+    return (_modes & CHANNEL_MODE_LIMIT) && static_cast<int>(_clients.size()) >= _userLimit;
 }
 
 /**
@@ -179,7 +361,9 @@ bool Channel::isFull() const
  */
 void Channel::addOperator(Client *client)
 {
-    _operators.insert(client);
+    Membership *membership = _members.find(client);
+    if (membership != NULL)
+        membership->flags |= MEMBER_OPERATOR;
 }
 
 /**
@@ -187,7 +371,9 @@ void Channel::addOperator(Client *client)
  */
 void Channel::removeOperator(Client *client)
 {
-    _operators.erase(client);
+    Membership *membership = _members.find(client);
+    if (membership != NULL)
+        membership->flags &= ~MEMBER_OPERATOR;
 }
 
 /**
@@ -195,7 +381,7 @@ void Channel::removeOperator(Client *client)
  */
 bool Channel::isOperator(Client *client) const
 {
-    return _operators.find(client) != _operators.end();
+    return (getMemberFlags(client) & MEMBER_OPERATOR) != 0;
 }
 
 /**
@@ -203,7 +389,7 @@ bool Channel::isOperator(Client *client) const
  */
 void Channel::inviteClient(Client *client)
 {
-    _invitedClients.insert(client);
+    _invitedClients.insert(client->getSerial());
 }
 
 /**
@@ -211,7 +397,7 @@ void Channel::inviteClient(Client *client)
  */
 bool Channel::isInvited(Client *client) const
 {
-    return _invitedClients.find(client) != _invitedClients.end();
+    return _invitedClients.find(client->getSerial()) != _invitedClients.end();
 }
 
 /**
@@ -219,7 +405,7 @@ bool Channel::isInvited(Client *client) const
  */
 void Channel::removeInvitation(Client *client)
 {
-    _invitedClients.erase(client);
+    _invitedClients.erase(client->getSerial());
 }
 
 /**
@@ -252,7 +438,7 @@ bool Channel::hasTopic() const
  */
 bool Channel::hasVoice(const Client *client) const
 {
-    return _voicedClients.find(const_cast<Client*>(client)) != _voicedClients.end();
+    return (getMemberFlags(const_cast<Client*>(client)) & MEMBER_VOICE) != 0;
 }
 
 const std::string & Channel::getKey() const
@@ -0,0 +1,107 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   ChannelShard.cpp                                   :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: raveriss <raveriss@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/11/26 14:52:13 by raveriss          #+#    #+#             */
+/*   Updated: 2024/11/26 14:52:13 by raveriss         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../incs/ChannelShard.hpp"
+
+/* For pipe(), read(), write(), close() */
+#include <unistd.h>
+
+/* For sched_yield() */
+#include <sched.h>
+
+/**
+ * Constructor
+ */
+ShardTask::ShardTask()
+: client(NULL)
+{}
+
+/**
+ * Constructor, the thread is started by the server
+ */
+ChannelShard::ChannelShard(Server &server, size_t index, size_t loopCount)
+: server(server), index(index), thread(), cpu(-1), outbox(loopCount), _queue(CHANNELSHARD_QUEUE_SIZE), _sleeping(0)
+{
+    _wakePipe[0] = -1;
+    _wakePipe[1] = -1;
+    pthread_mutex_init(&lock, NULL);
+}
+
+/**
+ * Destructor
+ */
+ChannelShard::~ChannelShard()
+{
+    if (_wakePipe[0] >= 0)
+        close(_wakePipe[0]);
+    if (_wakePipe[1] >= 0)
+        close(_wakePipe[1]);
+    pthread_mutex_destroy(&lock);
+}
+
+/**
+ * Create the wake pipe; the shard blocks on its read end when idle
+ * @return false if the pipe cannot be created
+ */
+bool ChannelShard::openWakePipe()
+{
+    return pipe(_wakePipe) == 0;
+}
+
+/**
+ * Queue `task`, yielding while the queue is full, and wake the shard if
+ * it sleeps. Must not be called with a channel lock held: the shard needs
+ * its own to drain the queue.
+ */
+void ChannelShard::push(const ShardTask &task)
+{
+    while (!_queue.tryPush(task))
+        sched_yield();
+
+    if (__sync_bool_compare_and_swap(&_sleeping, 1, 0))
+    {
+        ssize_t written = write(_wakePipe[1], "", 1);
+        (void)written;
+    }
+}
+
+/**
+ * @return true and the oldest task in `task`, false if the queue is empty
+ */
+bool ChannelShard::pop(ShardTask &task)
+{
+    return _queue.tryPop(task);
+}
+
+/**
+ * Sleep on the wake pipe until a producer publishes a task. The queue is
+ * checked again after announcing the sleep, so a task pushed in between
+ * is never missed; a stale wake byte only costs one empty round.
+ */
+void ChannelShard::waitForTasks()
+{
+    if (!_queue.empty())
+        return;
+
+    __sync_lock_test_and_set(&_sleeping, 1);
+    __sync_synchronize();
+    if (!_queue.empty())
+    {
+        __sync_bool_compare_and_swap(&_sleeping, 1, 0);
+        return;
+    }
+
+    char drain[64];
+    ssize_t got = read(_wakePipe[0], drain, sizeof(drain));
+    (void)got;
+    __sync_lock_test_and_set(&_sleeping, 0);
+}
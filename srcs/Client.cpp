@@ -13,17 +13,30 @@
 /* Inclusions pour les clients et les canaux */
 #include "../incs/Client.hpp"
 #include "../incs/Channel.hpp"
+#include "../incs/Casemap.hpp"
+#include "../incs/MutexGuard.hpp"
+
+/* Bit de _queuedCommands : la boucle attend le dernier décompte pour reprendre la lecture */
+static const int AWAITING_QUEUED = 0x40000000;
+
+/* Dernier numéro de série attribué, partagé par toutes les boucles */
+static unsigned long nextSerial = 0;
 
 /**
  * Constructor
  */
 Client::Client(int socket)
-    : _socket(socket), _registered(false), _sentPass(false), _sentNick(false), 
-        _sentUser(false), _isAway(false), _isOperator(false), _lastPongTime(0),
-        _lastActivityTime(time(NULL)), pingReceived(false)
+    : _socket(socket), _serial(__sync_add_and_fetch(&nextSerial, 1)), _loop(NULL), _registered(false), _sentPass(false), _sentNick(false), 
+        _sentUser(false), _isAway(false), _isOperator(false), _closing(false), _closeRequested(false), _queuedCommands(0), _shardRouted(false),
+        _parked(false), _parkedOverflow(0),
+        _readPending(false), _inputClosed(false),
+        _lastPongTime(0),
+        _lastActivityTime(0), pingReceived(false), _keepaliveState(KEEPALIVE_REGISTRATION),
+        _outOffset(0), _outPending(0), _writeArmed(false), _flushScheduled(false)
 {
-    /* Initialiser le temps de la dernière activité */
-    _lastActivityTime = time(NULL);
+    /* Le minuteur rend le client à son échéance */
+    _keepaliveTimer.owner = this;
+    pthread_mutex_init(&_channelsLock, NULL);
 }
 
 /**
@@ -37,6 +50,7 @@ Client::~Client()
         (*it)->removeClient(this);
     }
     _channels.clear();
+    pthread_mutex_destroy(&_channelsLock);
 }
 
 /**
@@ -47,6 +61,30 @@ int Client::getSocket() const
     return _socket;
 }
 
+/**
+ * @return the serial number of the client
+ */
+unsigned long Client::getSerial() const
+{
+    return _serial;
+}
+
+/**
+ * @return the event loop that owns the client
+ */
+ReactorLoop *Client::getLoop() const
+{
+    return _loop;
+}
+
+/**
+ * Set the event loop that owns the client
+ */
+void Client::setLoop(ReactorLoop *loop)
+{
+    _loop = loop;
+}
+
 /**
  * @return true if the client is registered, false otherwise
  */
@@ -80,11 +118,11 @@ void Client::setSentPass(bool status)
 }
 
 /**
- * @return the message buffer of the client
+ * @return the line framer of the client
  */
-std::string& Client::getMessageBuffer()
-{ 
-    return _messageBuffer; 
+LineFramer& Client::getFramer()
+{
+    return _framer;
 }
 
 /**
@@ -133,6 +171,16 @@ const std::string &Client::getNickname() const
 void Client::setNickname(const std::string &nickname)
 {
     _nickname = nickname;
+    _foldedNickname = Casemap::fold(nickname);
+    updatePrefix();
+}
+
+/**
+ * @return the rfc1459 folded nickname of the client
+ */
+const std::string &Client::getFoldedNickname() const
+{
+    return _foldedNickname;
 }
 
 /**
@@ -149,6 +197,7 @@ const std::string &Client::getUsername() const
 void Client::setUsername(const std::string &username)
 {
     _username = username;
+    updatePrefix();
 }
 
 /**
@@ -165,6 +214,30 @@ const std::string &Client::getHostname() const
 void Client::setHostname(const std::string &hostname)
 {
     _hostname = hostname;
+    updatePrefix();
+}
+
+/**
+ * @return the ":nick!user@host" source prefix of the messages sent by the client
+ */
+const std::string &Client::getPrefix() const
+{
+    return _prefix;
+}
+
+/**
+ * Rebuild the source prefix; called by the setters of its three parts
+ */
+void Client::updatePrefix()
+{
+    _prefix.clear();
+    _prefix.reserve(3 + _nickname.size() + _username.size() + _hostname.size());
+    _prefix += ':';
+    _prefix += _nickname;
+    _prefix += '!';
+    _prefix += _username;
+    _prefix += '@';
+    _prefix += _hostname;
 }
 
 /**
@@ -204,15 +277,18 @@ void Client::setRealname(const std::string &realname)
  */
 void Client::joinChannel(Channel *channel)
 {
+    MutexGuard guard(_channelsLock);
     _channels.insert(channel);
 }
 
 /**
  * Remove a channel from the list of channels of the client
+ * @return false if the client had already left it
  */
-void Client::leaveChannel(Channel *channel)
+bool Client::leaveChannel(Channel *channel)
 {
-    _channels.erase(channel);
+    MutexGuard guard(_channelsLock);
+    return _channels.erase(channel) > 0;
 }
 
 /**
@@ -220,9 +296,10 @@ void Client::leaveChannel(Channel *channel)
  */
 bool Client::isInChannel(const std::string &channelName) const
 {
+    MutexGuard guard(_channelsLock);
     for (std::set<Channel*>::const_iterator it = _channels.begin(); it != _channels.end(); ++it)
     {
-        if ((*it)->getName() == channelName)
+        if (Casemap::equals((*it)->getName(), channelName))
             return true;
     }
     return false;
@@ -231,11 +308,23 @@ bool Client::isInChannel(const std::string &channelName) const
 /**
  * @return the list of channels of the client
  */
-const std::set<Channel*> &Client::getChannels() const
+std::set<Channel*> Client::getChannels() const
 {
+    MutexGuard guard(_channelsLock);
     return _channels;
 }
 
+/**
+ * Copy the channels of the client with their folded names; a channel stays alive while
+ * the client is one of its members, so the names are read under the same lock
+ */
+void Client::copyChannels(std::vector<std::pair<Channel*, std::string> > &channels) const
+{
+    MutexGuard guard(_channelsLock);
+    for (std::set<Channel*>::const_iterator it = _channels.begin(); it != _channels.end(); ++it)
+        channels.push_back(std::make_pair(*it, (*it)->getFoldedName()));
+}
+
 /**
  * Set the time of the last PONG received from the client
  */
@@ -287,11 +376,174 @@ void Client::setOperator(bool status)
 /**
  * Update the time of the last activity
  */
-void Client::updateLastActivity()
+void Client::updateLastActivity(time_t now)
+{
+    _lastActivityTime = now;
+}
+
+/**
+ * @return the time of the last activity, in seconds of the monotonic clock
+ */
+time_t Client::getLastActivityTime() const
+{
+    return _lastActivityTime;
+}
+
+/**
+ * @return true if the client has been removed and awaits deletion
+ */
+bool Client::isClosing() const
+{
+    return _closing;
+}
+
+/**
+ * Set the closing status of the client
+ */
+void Client::setClosing(bool status)
+{
+    _closing = status;
+}
+
+/**
+ * @return true if the close of the client was requested from its loop
+ */
+bool Client::isCloseRequested() const
+{
+    return _closeRequested;
+}
+
+/**
+ * Set the close-requested status of the client
+ */
+void Client::setCloseRequested(bool status)
+{
+    _closeRequested = status;
+}
+
+/**
+ * Count a command handed to a shard or to the pipeline; called before the push
+ */
+void Client::addQueuedCommand()
+{
+    __sync_add_and_fetch(&_queuedCommands, 1);
+}
+
+/**
+ * Uncount a command once executed and its replies posted
+ */
+bool Client::finishQueuedCommand()
+{
+    if (__sync_sub_and_fetch(&_queuedCommands, 1) != AWAITING_QUEUED)
+        return false;
+    /* Un seul décompte retire le bit : la reprise est publiée une fois */
+    return __sync_bool_compare_and_swap(&_queuedCommands, AWAITING_QUEUED, 0);
+}
+
+/**
+ * @return the number of commands handed to other threads and not yet executed
+ */
+int Client::queuedCommands()
+{
+    return __sync_add_and_fetch(&_queuedCommands, 0) & ~AWAITING_QUEUED;
+}
+
+/**
+ * Ask the thread finishing the last queued command to resume the client
+ * @return false if no command is queued anymore, the loop may go on at once
+ */
+bool Client::awaitQueuedCommands()
+{
+    int queued = __sync_add_and_fetch(&_queuedCommands, 0);
+    while (queued > 0)
+    {
+        int seen = __sync_val_compare_and_swap(&_queuedCommands, queued, queued | AWAITING_QUEUED);
+        if (seen == queued)
+            return true;
+        queued = seen;
+    }
+    return false;
+}
+
+/**
+ * Park the loop on `line` until the shards have run the commands sent before it
+ */
+void Client::park(const std::string &line, const char *rest, size_t restLength, size_t overflow)
+{
+    _parked = true;
+    _parkedLine = line;
+    _parkedInput.assign(rest, restLength);
+    _parkedOverflow = overflow;
+}
+
+/**
+ * @return true if a line waits for the shards to run the commands sent before it
+ */
+bool Client::isParked() const
+{
+    return _parked;
+}
+
+/**
+ * Hand back the parked line, the unframed input after it and the overflow count
+ */
+void Client::unpark(std::string &line, std::string &rest, size_t &overflow)
+{
+    _parked = false;
+    line.swap(_parkedLine);
+    rest.swap(_parkedInput);
+    overflow = _parkedOverflow;
+    _parkedLine.clear();
+    _parkedInput.clear();
+    _parkedOverflow = 0;
+}
+
+/**
+ * @return true if commands were handed to shards since the loop last waited for them
+ */
+bool Client::isShardRouted() const
+{
+    return _shardRouted;
+}
+
+/**
+ * Set the shard-routed status of the client
+ */
+void Client::setShardRouted(bool status)
+{
+    _shardRouted = status;
+}
+
+/**
+ * @return true if the client still has unread data after exhausting its read budget
+ */
+bool Client::isReadPending() const
+{
+    return _readPending;
+}
+
+/**
+ * Set the read pending status of the client
+ */
+void Client::setReadPending(bool status)
+{
+    _readPending = status;
+}
+
+/**
+ * @return true if the end of stream was read and the close handed to the state thread
+ */
+bool Client::isInputClosed() const
+{
+    return _inputClosed;
+}
+
+/**
+ * Set the input-closed status of the client
+ */
+void Client::setInputClosed(bool status)
 {
-    
-    /* Mettre à jour l'heure de la dernière activité */
-    _lastActivityTime = time(NULL);
+    _inputClosed = status;
 }
 
 /**
@@ -302,4 +554,151 @@ bool Client::isPingReceived() const
     return pingReceived;
 }
 
+/**
+ * @return the deadline currently watched by the keepalive timer
+ */
+Client::KeepaliveState Client::getKeepaliveState() const
+{
+    return _keepaliveState;
+}
+
+/**
+ * Set the deadline watched by the keepalive timer
+ */
+void Client::setKeepaliveState(KeepaliveState state)
+{
+    _keepaliveState = state;
+}
+
+/**
+ * @return the keepalive timer of the client
+ */
+TimerNode &Client::getKeepaliveTimer()
+{
+    return _keepaliveTimer;
+}
+
+/**
+ * Append a shared message to the output queue, retaining it without a copy
+ */
+void Client::queueOutput(const SharedPayload &payload)
+{
+    if (payload.empty())
+        return;
+    _outQueue.push_back(payload);
+    _outPending += payload.size();
+}
+
+/**
+ * Copy a reply at the end of the queue. Replies to a single client are
+ * packed into blocks of OUTPUT_BLOCK_SIZE bytes owned by this queue alone,
+ * so queuing a reply only allocates when the last block is full or shared.
+ */
+void Client::queueOutput(const char *data, size_t length)
+{
+    if (length == 0)
+        return;
+
+    if (_outQueue.empty() || !_outQueue.back().append(data, length))
+    {
+        _outQueue.push_back(SharedPayload::withCapacity(length > OUTPUT_BLOCK_SIZE ? length : OUTPUT_BLOCK_SIZE));
+        _outQueue.back().append(data, length);
+    }
+    _outPending += length;
+}
+
+/**
+ * @return true if some data is waiting to be sent
+ */
+bool Client::hasPendingOutput() const
+{
+    return _outPending > 0;
+}
+
+/**
+ * @return the number of bytes waiting to be sent
+ */
+size_t Client::getPendingOutputSize() const
+{
+    return _outPending;
+}
+
+/**
+ * Describe up to maxIov queued blocks for a single writev() call
+ * @return the number of iovec entries filled
+ */
+size_t Client::fillOutputVector(struct iovec *iov, size_t maxIov) const
+{
+    size_t count = 0;
+    for (std::deque<SharedPayload>::const_iterator it = _outQueue.begin(); it != _outQueue.end() && count < maxIov; ++it)
+    {
+        size_t offset = (count == 0) ? _outOffset : 0;
+        iov[count].iov_base = const_cast<char *>(it->data() + offset);
+        iov[count].iov_len = it->size() - offset;
+        ++count;
+    }
+    return count;
+}
+
+/**
+ * Drop the bytes that have been written to the socket,
+ * possibly spanning several queued blocks
+ */
+void Client::consumeOutput(size_t bytes)
+{
+    _outPending -= bytes;
+    while (bytes > 0)
+    {
+        size_t available = _outQueue.front().size() - _outOffset;
+        if (bytes < available)
+        {
+            _outOffset += bytes;
+            return;
+        }
+        bytes -= available;
+        _outQueue.pop_front();
+        _outOffset = 0;
+    }
+}
+
+/**
+ * Discard everything waiting to be sent
+ */
+void Client::clearOutput()
+{
+    _outQueue.clear();
+    _outOffset = 0;
+    _outPending = 0;
+}
+
+/**
+ * @return true if the socket is watched for write readiness
+ */
+bool Client::isWriteArmed() const
+{
+    return _writeArmed;
+}
+
+/**
+ * Set whether the socket is watched for write readiness
+ */
+void Client::setWriteArmed(bool status)
+{
+    _writeArmed = status;
+}
 
+/**
+ * @return true if the client waits for the end-of-iteration flush
+ */
+bool Client::isFlushScheduled() const
+{
+    return _flushScheduled;
+}
+
+/**
+ * Set whether the client waits for the end-of-iteration flush
+ */
+void Client::setFlushScheduled(bool status)
+{
+    _flushScheduled = status;
+}
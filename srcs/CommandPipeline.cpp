@@ -0,0 +1,117 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   CommandPipeline.cpp                                :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: raveriss <raveriss@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/11/27 11:38:02 by raveriss          #+#    #+#             */
+/*   Updated: 2024/11/27 11:38:02 by raveriss         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../incs/CommandPipeline.hpp"
+
+/* For pipe(), read(), write(), close() */
+#include <unistd.h>
+
+/**
+ * Constructor
+ */
+CommandRecord::CommandRecord()
+: kind(COMMAND), client(NULL), entry(NULL), valid(false)
+{}
+
+/**
+ * Constructor, the state thread is started by the server
+ */
+CommandPipeline::CommandPipeline(size_t loopCount)
+: thread(), cpu(-1), outbox(loopCount), _ring(COMMANDPIPELINE_RING_SIZE), _sleeping(0)
+{
+    _wakePipe[0] = -1;
+    _wakePipe[1] = -1;
+}
+
+/**
+ * Destructor
+ */
+CommandPipeline::~CommandPipeline()
+{
+    if (_wakePipe[0] >= 0)
+        close(_wakePipe[0]);
+    if (_wakePipe[1] >= 0)
+        close(_wakePipe[1]);
+}
+
+/**
+ * Create the wake pipe; the state thread blocks on its read end when idle
+ * @return false if the pipe cannot be created
+ */
+bool CommandPipeline::openWakePipe()
+{
+    return pipe(_wakePipe) == 0;
+}
+
+/**
+ * Claim the next slot, yielding while the ring is full. Must not be called
+ * with the state lock held: the state thread needs it to free slots.
+ * @return the slot of `sequence`, to be filled then published
+ */
+CommandRecord &CommandPipeline::claim(size_t &sequence)
+{
+    sequence = _ring.claim();
+    return _ring.slot(sequence);
+}
+
+/**
+ * Publish a filled slot and wake the state thread if it sleeps
+ */
+void CommandPipeline::publish(size_t sequence)
+{
+    _ring.publish(sequence);
+    if (__sync_bool_compare_and_swap(&_sleeping, 1, 0))
+    {
+        ssize_t written = write(_wakePipe[1], "", 1);
+        (void)written;
+    }
+}
+
+/**
+ * @return the next published record, NULL if the next sequence is not published yet
+ */
+CommandRecord *CommandPipeline::next()
+{
+    return _ring.next();
+}
+
+/**
+ * Hand the records read so far back to the producers
+ */
+void CommandPipeline::release()
+{
+    _ring.release();
+}
+
+/**
+ * Sleep on the wake pipe until a record is published. The ring is checked
+ * again after announcing the sleep, so a record published in between is
+ * never missed.
+ */
+void CommandPipeline::waitForRecords()
+{
+    if (_ring.ready())
+        return;
+
+    __sync_lock_test_and_set(&_sleeping, 1);
+    __sync_synchronize();
+    if (_ring.ready())
+    {
+        __sync_bool_compare_and_swap(&_sleeping, 1, 0);
+        return;
+    }
+
+    char drain[64];
+    ssize_t got = read(_wakePipe[0], drain, sizeof(drain));
+    (void)got;
+    __sync_lock_test_and_set(&_sleeping, 0);
+}
@@ -0,0 +1,121 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   CommandTable.cpp                                   :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: raveriss <raveriss@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/11/21 18:29:13 by raveriss          #+#    #+#             */
+/*   Updated: 2024/11/21 18:29:13 by raveriss         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../incs/CommandTable.hpp"
+
+/* For strlen() */
+#include <cstring>
+
+/* For toupper() */
+#include <cctype>
+
+/* For std::logic_error */
+#include <stdexcept>
+
+/* Masque d'emplacement dans la table */
+#define COMMAND_TABLE_MASK (COMMAND_TABLE_SIZE - 1)
+
+/* Paramètres de l'empreinte FNV-1a 32 bits */
+#define FNV_OFFSET_BASIS 2166136261u
+#define FNV_PRIME 16777619u
+
+/**
+ * Constructor
+ */
+CommandTable::CommandTable()
+: _count(0)
+{
+    for (size_t i = 0; i < COMMAND_TABLE_SIZE; ++i)
+    {
+        _entries[i].name = NULL;
+        _entries[i].hash = 0;
+        _entries[i].needsRegistration = false;
+        _entries[i].handler = NULL;
+        _entries[i].channelScoped = false;
+        _entries[i].splitTargets = false;
+        _entries[i].channelParam = 0;
+        _entries[i].hits = 0;
+    }
+}
+
+/**
+ * Register a command in the first free slot of its probe sequence
+ */
+void CommandTable::add(const char *name, bool needsRegistration, CommandHandler handler,
+                       bool channelScoped, bool splitTargets, size_t channelParam)
+{
+    /* La table garde toujours un emplacement libre pour terminer les recherches */
+    if (_count + 1 >= COMMAND_TABLE_SIZE)
+        throw std::logic_error("Table de commandes pleine.");
+
+    unsigned int h = hash(name, std::strlen(name));
+    size_t slot = h & COMMAND_TABLE_MASK;
+    while (_entries[slot].name != NULL)
+        slot = (slot + 1) & COMMAND_TABLE_MASK;
+
+    _entries[slot].name = name;
+    _entries[slot].hash = h;
+    _entries[slot].needsRegistration = needsRegistration;
+    _entries[slot].handler = handler;
+    _entries[slot].channelScoped = channelScoped;
+    _entries[slot].splitTargets = splitTargets;
+    _entries[slot].channelParam = channelParam;
+    _entries[slot].hits = 0;
+    _order[_count++] = slot;
+}
+
+/**
+ * @return the entry of `command`, or NULL if it is not registered
+ */
+CommandEntry *CommandTable::find(const IrcSlice &command)
+{
+    unsigned int h = hash(command.data, command.length);
+    size_t slot = h & COMMAND_TABLE_MASK;
+
+    while (_entries[slot].name != NULL)
+    {
+        if (_entries[slot].hash == h && command.iequals(_entries[slot].name))
+            return &_entries[slot];
+        slot = (slot + 1) & COMMAND_TABLE_MASK;
+    }
+    return NULL;
+}
+
+/**
+ * @return the number of registered commands
+ */
+size_t CommandTable::count() const
+{
+    return _count;
+}
+
+/**
+ * @return the entry registered at position `index`
+ */
+const CommandEntry &CommandTable::entry(size_t index) const
+{
+    return _entries[_order[index]];
+}
+
+/**
+ * @return the FNV-1a hash of the uppercase form of `data`
+ */
+unsigned int CommandTable::hash(const char *data, size_t length)
+{
+    unsigned int h = FNV_OFFSET_BASIS;
+    for (size_t i = 0; i < length; ++i)
+    {
+        h ^= static_cast<unsigned char>(std::toupper(static_cast<unsigned char>(data[i])));
+        h *= FNV_PRIME;
+    }
+    return h;
+}
@@ -0,0 +1,241 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   CpuTopology.cpp                                    :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: raveriss <raveriss@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/11/28 09:41:17 by raveriss          #+#    #+#             */
+/*   Updated: 2024/11/28 09:41:17 by raveriss         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../incs/CpuTopology.hpp"
+
+/* For std::ifstream */
+#include <fstream>
+
+/* For std::ostringstream */
+#include <sstream>
+
+/* For strtol() */
+#include <cstdlib>
+
+/* For sysconf() */
+#include <unistd.h>
+
+/* For cpu_set_t, sched_getaffinity() */
+#include <sched.h>
+
+/* For pthread_setaffinity_np() */
+#include <pthread.h>
+
+/**
+ * Nœuds NUMA au plus cherchés dans /sys
+ */
+static const int MAX_NUMA_NODES = 64;
+
+/**
+ * Masque d'affinité du processus, retenu par la première lecture de la
+ * topologie, avant tout épinglage
+ */
+static cpu_set_t processMask;
+static bool processMaskSaved = false;
+
+/**
+ * Read the topology: online processors from sysconf(), the process
+ * affinity mask, then the cpulist of each NUMA node under /sys.
+ */
+CpuTopology::CpuTopology()
+: _online(1), _nodes(1), _nodeOf(CPU_SETSIZE, 0), _allowed(CPU_SETSIZE, false)
+{
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    if (online > 0)
+        _online = static_cast<size_t>(online);
+
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    if (sched_getaffinity(0, sizeof(mask), &mask) == 0)
+    {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+            _allowed[cpu] = CPU_ISSET(cpu, &mask);
+        if (!processMaskSaved)
+        {
+            processMask = mask;
+            processMaskSaved = true;
+        }
+    }
+    else
+    {
+        for (size_t cpu = 0; cpu < _online && cpu < _allowed.size(); ++cpu)
+            _allowed[cpu] = true;
+    }
+
+    size_t nodes = 0;
+    for (int node = 0; node < MAX_NUMA_NODES; ++node)
+    {
+        std::ostringstream path;
+        path << "/sys/devices/system/node/node" << node << "/cpulist";
+        std::ifstream file(path.str().c_str());
+        std::string line;
+        std::vector<int> cpus;
+        if (!file || !std::getline(file, line) || !parseList(line, cpus))
+            continue;
+
+        for (size_t i = 0; i < cpus.size(); ++i)
+            _nodeOf[cpus[i]] = node;
+        nodes = static_cast<size_t>(node) + 1;
+    }
+    if (nodes > 0)
+        _nodes = nodes;
+}
+
+/**
+ * Parse a comma-separated list of processors and ranges, such as 0-3,6.
+ * An empty line (a memoryless node in /sys) yields an empty list.
+ * @return false on a malformed entry or a processor beyond CPU_SETSIZE
+ */
+bool CpuTopology::parseList(const std::string &text, std::vector<int> &cpus)
+{
+    cpus.clear();
+    std::string::size_type start = 0;
+    while (start < text.size())
+    {
+        std::string::size_type end = text.find(',', start);
+        if (end == std::string::npos)
+            end = text.size();
+        std::string item = text.substr(start, end - start);
+        start = end + 1;
+
+        std::string::size_type dash = item.find('-');
+        std::string first = item.substr(0, dash);
+        std::string last = dash == std::string::npos ? first : item.substr(dash + 1);
+        if (first.empty() || last.empty()
+            || first.find_first_not_of("0123456789") != std::string::npos
+            || last.find_first_not_of("0123456789") != std::string::npos)
+            return false;
+
+        long low = std::strtol(first.c_str(), NULL, 10);
+        long high = std::strtol(last.c_str(), NULL, 10);
+        if (low > high || high >= CPU_SETSIZE)
+            return false;
+        for (long cpu = low; cpu <= high; ++cpu)
+            cpus.push_back(static_cast<int>(cpu));
+    }
+    return true;
+}
+
+/**
+ * Format a list of processors, folding consecutive ones into ranges
+ */
+std::string CpuTopology::formatList(const std::vector<int> &cpus)
+{
+    std::ostringstream out;
+    for (size_t i = 0; i < cpus.size(); ++i)
+    {
+        size_t j = i;
+        while (j + 1 < cpus.size() && cpus[j + 1] == cpus[j] + 1)
+            ++j;
+        if (i > 0)
+            out << ',';
+        out << cpus[i];
+        if (j > i)
+            out << '-' << cpus[j];
+        i = j;
+    }
+    return out.str();
+}
+
+/**
+ * @return the processor of the thread ranked `index`, wrapping around
+ * the list, or -1 if no list was given
+ */
+int CpuTopology::pick(const std::vector<int> &cpus, size_t index)
+{
+    if (cpus.empty())
+        return -1;
+    return cpus[index % cpus.size()];
+}
+
+/**
+ * Pin the calling thread to a single processor. Memory it touches first
+ * afterwards is placed on that processor's node by the kernel.
+ */
+bool CpuTopology::pinCurrentThread(int cpu)
+{
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+/**
+ * Give the calling thread back the affinity mask the process started with.
+ * A thread created by a pinned thread inherits its single processor; an
+ * occasional thread calls this so it does not compete with that one.
+ * @return false if the mask was never read or cannot be applied
+ */
+bool CpuTopology::unpinCurrentThread()
+{
+    if (!processMaskSaved)
+        return false;
+    return pthread_setaffinity_np(pthread_self(), sizeof(processMask), &processMask) == 0;
+}
+
+/**
+ * @return the number of online processors
+ */
+size_t CpuTopology::onlineCpus() const
+{
+    return _online;
+}
+
+/**
+ * @return the number of NUMA nodes, 1 without /sys
+ */
+size_t CpuTopology::nodeCount() const
+{
+    return _nodes;
+}
+
+/**
+ * @return the NUMA node of `cpu`
+ */
+int CpuTopology::nodeOf(int cpu) const
+{
+    if (cpu < 0 || static_cast<size_t>(cpu) >= _nodeOf.size())
+        return 0;
+    return _nodeOf[cpu];
+}
+
+/**
+ * @return true if `cpu` is in the process affinity mask
+ */
+bool CpuTopology::isAllowed(int cpu) const
+{
+    if (cpu < 0 || static_cast<size_t>(cpu) >= _allowed.size())
+        return false;
+    return _allowed[cpu];
+}
+
+/**
+ * @return the distinct nodes of a list of processors, in ascending order
+ */
+std::vector<int> CpuTopology::nodesOf(const std::vector<int> &cpus) const
+{
+    std::vector<bool> seen(_nodes, false);
+    for (size_t i = 0; i < cpus.size(); ++i)
+    {
+        int node = nodeOf(cpus[i]);
+        if (static_cast<size_t>(node) < seen.size())
+            seen[node] = true;
+    }
+
+    std::vector<int> nodes;
+    for (size_t node = 0; node < seen.size(); ++node)
+    {
+        if (seen[node])
+            nodes.push_back(static_cast<int>(node));
+    }
+    return nodes;
+}
@@ -0,0 +1,135 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   EpollReactor.cpp                                   :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: raveriss <raveriss@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/11/20 14:38:14 by raveriss          #+#    #+#             */
+/*   Updated: 2024/11/20 14:38:14 by raveriss         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../incs/EpollReactor.hpp"
+
+#ifdef __linux__
+
+/* For close() */
+#include <unistd.h>
+
+/* For errno */
+#include <cerrno>
+
+/* For strerror() */
+#include <cstring>
+
+/* For std::runtime_error */
+#include <stdexcept>
+
+/**
+ * Constructor
+ */
+EpollReactor::EpollReactor()
+: _epollFd(epoll_create1(EPOLL_CLOEXEC)), _ready(EPOLL_INITIAL_EVENTS)
+{
+    if (_epollFd < 0)
+        throw std::runtime_error("Erreur lors de la création de l'instance epoll : " + std::string(strerror(errno)));
+}
+
+/**
+ * Destructor
+ */
+EpollReactor::~EpollReactor()
+{
+    close(_epollFd);
+}
+
+/**
+ * Traduit l'intérêt EV_* en drapeaux epoll, toujours en edge-triggered
+ */
+unsigned int EpollReactor::toEpoll(int events)
+{
+    unsigned int mask = EPOLLET;
+    if (events & EV_READ)
+        mask |= EPOLLIN | EPOLLRDHUP;
+    if (events & EV_WRITE)
+        mask |= EPOLLOUT;
+    return mask;
+}
+
+/**
+ * Enregistre un fd dans l'instance epoll
+ */
+bool EpollReactor::add(int fd, int events)
+{
+    struct epoll_event ev;
+    std::memset(&ev, 0, sizeof(ev));
+    ev.events = toEpoll(events);
+    ev.data.fd = fd;
+    return epoll_ctl(_epollFd, EPOLL_CTL_ADD, fd, &ev) == 0;
+}
+
+/**
+ * Change l'intérêt d'un fd déjà enregistré
+ */
+bool EpollReactor::modify(int fd, int events)
+{
+    struct epoll_event ev;
+    std::memset(&ev, 0, sizeof(ev));
+    ev.events = toEpoll(events);
+    ev.data.fd = fd;
+    return epoll_ctl(_epollFd, EPOLL_CTL_MOD, fd, &ev) == 0;
+}
+
+/**
+ * Désenregistre un fd (fermer le fd suffirait, mais on reste explicite)
+ */
+void EpollReactor::remove(int fd)
+{
+    epoll_ctl(_epollFd, EPOLL_CTL_DEL, fd, NULL);
+}
+
+/**
+ * Attend les fd prêts. Seuls les fd actifs sont renvoyés par le noyau,
+ * le coût ne dépend donc pas du nombre de connexions inactives.
+ */
+int EpollReactor::wait(std::vector<ReactorEvent> &events, int timeoutMs)
+{
+    events.clear();
+
+    int ready = epoll_wait(_epollFd, &_ready[0], static_cast<int>(_ready.size()), timeoutMs);
+    if (ready < 0)
+        return errno == EINTR ? 0 : -1;
+
+    for (int i = 0; i < ready; ++i)
+    {
+        ReactorEvent event;
+        event.fd = _ready[i].data.fd;
+        event.events = 0;
+
+        /* Une erreur ou une fermeture est remontée comme une lecture : recv() la détectera */
+        if (_ready[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))
+            event.events |= EV_READ;
+        if (_ready[i].events & EPOLLOUT)
+            event.events |= EV_WRITE;
+        if (_ready[i].events & (EPOLLHUP | EPOLLERR))
+            event.events |= EV_ERROR;
+        events.push_back(event);
+    }
+
+    /* Tampon plein : d'autres fd attendent peut-être, on l'agrandit pour le prochain tour */
+    if (ready == static_cast<int>(_ready.size()))
+        _ready.resize(_ready.size() * 2);
+
+    return ready;
+}
+
+/**
+ * @return the name of the backend
+ */
+const char *EpollReactor::name() const
+{
+    return "epoll";
+}
+
+#endif /* __linux__ */
@@ -0,0 +1,388 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   FanoutEngine.cpp                                   :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: raveriss <raveriss@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/11/26 17:08:26 by raveriss          #+#    #+#             */
+/*   Updated: 2024/11/26 17:08:26 by raveriss         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../incs/FanoutEngine.hpp"
+
+/* For CpuTopology */
+#include "../incs/CpuTopology.hpp"
+
+/* For pipe(), read(), write(), close() */
+#include <unistd.h>
+
+/* For sched_yield() */
+#include <sched.h>
+
+/* For std::cerr */
+#include <iostream>
+
+/* For std::exit() */
+#include <cstdlib>
+
+/* For std::runtime_error */
+#include <stdexcept>
+
+/* For clock_gettime() */
+#include <ctime>
+
+/* Horloge monotone en nanosecondes, pour la latence des diffusions */
+static uint64_t monotonicNs()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<uint64_t>(now.tv_sec) * 1000000000ULL + static_cast<uint64_t>(now.tv_nsec);
+}
+
+/**
+ * Constructor, holding the reference of its creator
+ */
+FanoutPlan::FanoutPlan()
+: groups(0), refs(1)
+{}
+
+/**
+ * Take a reference
+ */
+void FanoutPlan::acquire()
+{
+    __sync_add_and_fetch(&refs, 1);
+}
+
+/**
+ * Drop a reference, freeing the plan with the last one
+ */
+void FanoutPlan::release()
+{
+    if (__sync_sub_and_fetch(&refs, 1) == 0)
+        delete this;
+}
+
+/**
+ * Constructor, holding the reference of the channel
+ */
+FanoutDrain::FanoutDrain()
+: refs(1)
+{}
+
+/**
+ * Take `count` references, one per group of a broadcast
+ */
+void FanoutDrain::acquire(int count)
+{
+    __sync_add_and_fetch(&refs, count);
+}
+
+/**
+ * Drop a reference, freeing the counter with the last one
+ */
+void FanoutDrain::release()
+{
+    if (__sync_sub_and_fetch(&refs, 1) == 0)
+        delete this;
+}
+
+/**
+ * @return true if every block posted by the workers has been queued by its loop
+ */
+bool FanoutDrain::drained()
+{
+    return __sync_add_and_fetch(&refs, 0) == 1;
+}
+
+/**
+ * Constructor
+ */
+FanoutJob::FanoutJob()
+: plan(NULL), drain(NULL), exceptFd(-1), exceptSerial(0), submittedNs(0)
+{}
+
+/**
+ * Constructor
+ */
+FanoutEngine::Worker::Worker(FanoutEngine &engine, size_t index, int cpu)
+: engine(engine), index(index), thread(), cpu(cpu), queue(FANOUTENGINE_QUEUE_SIZE), sleeping(0)
+{
+    wakePipe[0] = -1;
+    wakePipe[1] = -1;
+    for (size_t i = 0; i < FANOUTENGINE_LATENCY_BUCKETS; ++i)
+        latency[i] = 0;
+}
+
+/**
+ * Constructor
+ */
+FanoutEngine::FanoutEngine()
+: _loops(NULL), _batches(0), _deliveries(0)
+{}
+
+/**
+ * Destructor
+ */
+FanoutEngine::~FanoutEngine()
+{
+    for (size_t i = 0; i < _workers.size(); ++i)
+    {
+        if (_workers[i]->wakePipe[0] >= 0)
+            close(_workers[i]->wakePipe[0]);
+        if (_workers[i]->wakePipe[1] >= 0)
+            close(_workers[i]->wakePipe[1]);
+        delete _workers[i];
+    }
+}
+
+/**
+ * Create the wake pipes and start the worker threads. The caller blocks
+ * signals around this call so that they stay with the main thread.
+ * @return false if a pipe or a thread cannot be created
+ */
+bool FanoutEngine::start(size_t workers, const std::vector<ReactorLoop*> &loops, const std::vector<int> &cpus)
+{
+    _loops = &loops;
+    for (size_t i = 0; i < workers; ++i)
+    {
+        Worker *worker = new Worker(*this, i, CpuTopology::pick(cpus, i));
+        _workers.push_back(worker);
+        if (pipe(worker->wakePipe) != 0)
+            return false;
+    }
+    for (size_t i = 0; i < _workers.size(); ++i)
+    {
+        if (pthread_create(&_workers[i]->thread, NULL, &FanoutEngine::workerThread, _workers[i]) != 0)
+            return false;
+    }
+    return true;
+}
+
+/**
+ * @return the number of workers
+ */
+size_t FanoutEngine::workerCount() const
+{
+    return _workers.size();
+}
+
+/**
+ * Sort the targets by worker, then by loop within each worker's share, in
+ * two counting passes: a broadcast then costs each worker its own share only.
+ * @return a plan holding one reference for the caller
+ */
+FanoutPlan *FanoutEngine::makePlan(const std::vector<FanoutTarget> &targets) const
+{
+    size_t workers = _workers.size();
+    size_t loops = _loops->size();
+    std::vector<size_t> offsets(workers * loops + 1, 0);
+    for (size_t i = 0; i < targets.size(); ++i)
+        ++offsets[(static_cast<size_t>(targets[i].fd) % workers) * loops + targets[i].loop + 1];
+
+    FanoutPlan *plan = new FanoutPlan;
+    for (size_t group = 1; group < offsets.size(); ++group)
+    {
+        if (offsets[group] > 0)
+            ++plan->groups;
+        offsets[group] += offsets[group - 1];
+    }
+    plan->shares.resize(workers + 1);
+    for (size_t w = 0; w <= workers; ++w)
+        plan->shares[w] = offsets[w * loops];
+
+    plan->targets.resize(targets.size());
+    for (size_t i = 0; i < targets.size(); ++i)
+        plan->targets[offsets[(static_cast<size_t>(targets[i].fd) % workers) * loops + targets[i].loop]++] = targets[i];
+    return plan;
+}
+
+/**
+ * Hand the broadcast to the workers that own a share of the plan, yielding
+ * while a queue is full. The drain counts every group before any worker can
+ * release one. Each worker wakes only if it announced its sleep.
+ */
+void FanoutEngine::submit(FanoutPlan *plan, FanoutDrain *drain, const SharedPayload &payload,
+                          int exceptFd, unsigned long exceptSerial)
+{
+    FanoutJob job;
+    job.plan = plan;
+    job.drain = drain;
+    job.payload = payload;
+    job.exceptFd = exceptFd;
+    job.exceptSerial = exceptSerial;
+    job.submittedNs = monotonicNs();
+    drain->acquire(plan->groups);
+    __sync_add_and_fetch(&_batches, 1);
+
+    for (size_t i = 0; i < _workers.size(); ++i)
+    {
+        if (plan->shares[i] == plan->shares[i + 1])
+            continue;
+
+        Worker &worker = *_workers[i];
+        plan->acquire();
+        while (!worker.queue.tryPush(job))
+            sched_yield();
+
+        if (__sync_bool_compare_and_swap(&worker.sleeping, 1, 0))
+        {
+            ssize_t written = write(worker.wakePipe[1], "", 1);
+            (void)written;
+        }
+    }
+}
+
+/**
+ * @return the number of batches submitted
+ */
+unsigned long FanoutEngine::batches() const
+{
+    return _batches;
+}
+
+/**
+ * @return the number of blocks posted by the workers
+ */
+unsigned long FanoutEngine::deliveries() const
+{
+    return _deliveries;
+}
+
+/**
+ * Merge the workers' histograms and walk them up to `percent` % of the
+ * broadcasts; the answer is the upper bound of that bucket, within a factor of two
+ * @return the latency bound in microseconds, 0 if nothing was broadcast
+ */
+unsigned long FanoutEngine::latencyPercentile(unsigned int percent) const
+{
+    unsigned long counts[FANOUTENGINE_LATENCY_BUCKETS];
+    unsigned long total = 0;
+    for (size_t b = 0; b < FANOUTENGINE_LATENCY_BUCKETS; ++b)
+    {
+        counts[b] = 0;
+        for (size_t w = 0; w < _workers.size(); ++w)
+            counts[b] += IoStats::load(_workers[w]->latency[b]);
+        total += counts[b];
+    }
+    if (total == 0)
+        return 0;
+
+    unsigned long wanted = (total * percent + 99) / 100;
+    unsigned long seen = 0;
+    for (size_t b = 0; b < FANOUTENGINE_LATENCY_BUCKETS; ++b)
+    {
+        seen += counts[b];
+        if (seen >= wanted)
+            return 1UL << b;
+    }
+    return 1UL << (FANOUTENGINE_LATENCY_BUCKETS - 1);
+}
+
+/**
+ * Worker thread entry point
+ */
+void *FanoutEngine::workerThread(void *arg)
+{
+    Worker *worker = static_cast<Worker *>(arg);
+    try
+    {
+        worker->engine.runWorker(*worker);
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Erreur du serveur (diffusion " << worker->index << ") : " << e.what() << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    return NULL;
+}
+
+/**
+ * Serve batches in arrival order, sleeping on the wake pipe when idle.
+ * The queue is checked again after announcing the sleep, so a batch
+ * pushed in between is never missed.
+ */
+void FanoutEngine::runWorker(Worker &worker)
+{
+    /* Épinglé avant sa première allocation : ses blocs en attente restent sur son nœud */
+    if (worker.cpu >= 0 && !CpuTopology::pinCurrentThread(worker.cpu))
+        throw std::runtime_error("Erreur lors de l'épinglage d'un travailleur de diffusion.");
+
+    FanoutJob job;
+    while (true)
+    {
+        while (worker.queue.tryPop(job))
+        {
+            deliver(worker, job);
+            job.plan->release();
+            job.payload = SharedPayload();
+        }
+
+        __sync_lock_test_and_set(&worker.sleeping, 1);
+        __sync_synchronize();
+        if (!worker.queue.empty())
+        {
+            __sync_bool_compare_and_swap(&worker.sleeping, 1, 0);
+            continue;
+        }
+
+        char drain[64];
+        ssize_t got = read(worker.wakePipe[0], drain, sizeof(drain));
+        (void)got;
+        __sync_lock_test_and_set(&worker.sleeping, 0);
+    }
+}
+
+/**
+ * Post the block to this worker's share of the plan, one mailbox lock per
+ * loop. The last block of each group carries the drain reference, released
+ * by the loop once queued; a group left empty by the excluded client
+ * releases it here.
+ */
+void FanoutEngine::deliver(Worker &worker, const FanoutJob &job)
+{
+    const FanoutPlan &plan = *job.plan;
+    size_t end = plan.shares[worker.index + 1];
+    size_t posted = 0;
+    size_t i = plan.shares[worker.index];
+    while (i < end)
+    {
+        size_t loop = plan.targets[i].loop;
+        for (; i < end && plan.targets[i].loop == loop; ++i)
+        {
+            const FanoutTarget &target = plan.targets[i];
+            if (target.fd == job.exceptFd && target.serial == job.exceptSerial)
+                continue;
+
+            /* Construit en place : une seule référence prise sur le bloc */
+            worker.outbox.push_back(LoopMessage());
+            LoopMessage &message = worker.outbox.back();
+            message.fd = target.fd;
+            message.serial = target.serial;
+            message.payload = job.payload;
+        }
+
+        if (worker.outbox.empty())
+        {
+            job.drain->release();
+            continue;
+        }
+        worker.outbox.back().drain = job.drain;
+        posted += worker.outbox.size();
+        (*_loops)[loop]->postAll(worker.outbox);
+        worker.outbox.clear();
+    }
+    __sync_add_and_fetch(&_deliveries, posted);
+
+    /* Latence du dépôt au dernier bloc déposé, en puissances de deux de µs */
+    uint64_t micros = (monotonicNs() - job.submittedNs) / 1000;
+    size_t bucket = 0;
+    while (micros > 0 && bucket + 1 < FANOUTENGINE_LATENCY_BUCKETS)
+    {
+        micros >>= 1;
+        ++bucket;
+    }
+    IoStats::count(worker.latency[bucket]);
+}
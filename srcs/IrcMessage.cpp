@@ -0,0 +1,227 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   IrcMessage.cpp                                     :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: raveriss <raveriss@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/11/21 14:37:51 by raveriss          #+#    #+#             */
+/*   Updated: 2024/11/21 14:37:51 by raveriss         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../incs/IrcMessage.hpp"
+
+/* For memcmp() */
+#include <cstring>
+
+/* For toupper() */
+#include <cctype>
+
+/**
+ * Constructor
+ */
+IrcSlice::IrcSlice()
+: data(""), length(0)
+{}
+
+/**
+ * Constructor
+ */
+IrcSlice::IrcSlice(const char *data, size_t length)
+: data(data), length(length)
+{}
+
+/**
+ * @return true if the slice is empty
+ */
+bool IrcSlice::empty() const
+{
+    return length == 0;
+}
+
+/**
+ * @return a copy of the slice
+ */
+std::string IrcSlice::str() const
+{
+    return std::string(data, length);
+}
+
+/**
+ * @return true if the slice matches `other` exactly
+ */
+bool IrcSlice::equals(const std::string &other) const
+{
+    return other.size() == length && std::memcmp(other.data(), data, length) == 0;
+}
+
+/**
+ * @return true if the slice matches the uppercase word `upper`, ignoring case
+ */
+bool IrcSlice::iequals(const char *upper) const
+{
+    size_t i = 0;
+    for (; i < length && upper[i] != '\0'; ++i)
+    {
+        if (std::toupper(static_cast<unsigned char>(data[i])) != upper[i])
+            return false;
+    }
+    return i == length && upper[i] == '\0';
+}
+
+/**
+ * @return the character at `index`, or '\0' past the end
+ */
+char IrcSlice::operator[](size_t index) const
+{
+    return index < length ? data[index] : '\0';
+}
+
+/**
+ * Constructor
+ */
+IrcMessage::IrcMessage()
+: _line(""), _length(0), _paramCount(0), _hasTrailing(false)
+{
+    _prefix.offset = _prefix.length = 0;
+    _command.offset = _command.length = 0;
+}
+
+/**
+ * Split a line into prefix, command and parameters in a single pass
+ * @return false if the line holds no command
+ */
+bool IrcMessage::parse(const char *line, size_t length)
+{
+    _line = line;
+    _length = length;
+    _prefix.offset = _prefix.length = 0;
+    _command.offset = _command.length = 0;
+    _paramCount = 0;
+    _hasTrailing = false;
+
+    size_t pos = 0;
+
+    /* Les séparateurs multiples sont tolérés */
+    while (pos < length && line[pos] == ' ')
+        ++pos;
+
+    /* Préfixe optionnel */
+    if (pos < length && line[pos] == ':')
+    {
+        _prefix.offset = ++pos;
+        while (pos < length && line[pos] != ' ')
+            ++pos;
+        _prefix.length = pos - _prefix.offset;
+        while (pos < length && line[pos] == ' ')
+            ++pos;
+    }
+
+    /* Commande */
+    _command.offset = pos;
+    while (pos < length && line[pos] != ' ')
+        ++pos;
+    _command.length = pos - _command.offset;
+    if (_command.length == 0)
+        return false;
+
+    /* Paramètres */
+    while (true)
+    {
+        while (pos < length && line[pos] == ' ')
+            ++pos;
+        if (pos >= length)
+            break;
+
+        Range &param = _params[_paramCount++];
+
+        /**
+         * Le trailing, introduit par ':', s'étend jusqu'à la fin de la ligne.
+         * Le quinzième paramètre l'est aussi, même sans ':'.
+         */
+        if (line[pos] == ':' || _paramCount == IRC_MAX_PARAMS)
+        {
+            if (line[pos] == ':')
+            {
+                ++pos;
+                _hasTrailing = true;
+            }
+            param.offset = pos;
+            param.length = length - pos;
+            break;
+        }
+
+        param.offset = pos;
+        while (pos < length && line[pos] != ' ')
+            ++pos;
+        param.length = pos - param.offset;
+    }
+    return true;
+}
+
+/**
+ * @return true if the message starts with a prefix
+ */
+bool IrcMessage::hasPrefix() const
+{
+    return _prefix.offset != 0;
+}
+
+/**
+ * @return the prefix, without its leading ':'
+ */
+IrcSlice IrcMessage::prefix() const
+{
+    return slice(_prefix);
+}
+
+/**
+ * @return the command, as sent by the client
+ */
+IrcSlice IrcMessage::command() const
+{
+    return slice(_command);
+}
+
+/**
+ * @return the number of parameters, trailing included
+ */
+size_t IrcMessage::paramCount() const
+{
+    return _paramCount;
+}
+
+/**
+ * @return the parameter at `index`, or an empty slice past the last one
+ */
+IrcSlice IrcMessage::param(size_t index) const
+{
+    if (index >= _paramCount)
+        return IrcSlice();
+    return slice(_params[index]);
+}
+
+/**
+ * @return true if the last parameter was introduced by ':'
+ */
+bool IrcMessage::hasTrailing() const
+{
+    return _hasTrailing;
+}
+
+/**
+ * @return the whole parsed line
+ */
+IrcSlice IrcMessage::line() const
+{
+    return IrcSlice(_line, _length);
+}
+
+/**
+ * @return the slice of the line covered by `range`
+ */
+IrcSlice IrcMessage::slice(const Range &range) const
+{
+    return IrcSlice(_line + range.offset, range.length);
+}
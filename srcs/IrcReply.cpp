@@ -0,0 +1,130 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   IrcReply.cpp                                       :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: raveriss <raveriss@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/11/25 09:37:44 by raveriss          #+#    #+#             */
+/*   Updated: 2024/11/25 09:37:44 by raveriss         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../incs/IrcReply.hpp"
+
+/* For std::memcpy, std::strlen */
+#include <cstring>
+
+/* Place réservée au CRLF final */
+#define IRC_REPLY_BODY_MAX (IRC_LINE_MAX - 2)
+
+/**
+ * Constructor
+ */
+IrcReply::IrcReply()
+: _length(0), _finished(false)
+{}
+
+/**
+ * Append a string, truncated at the line limit
+ */
+IrcReply &IrcReply::operator<<(const std::string &text)
+{
+    return append(text.data(), text.size());
+}
+
+/**
+ * Append a C string, truncated at the line limit
+ */
+IrcReply &IrcReply::operator<<(const char *text)
+{
+    return append(text, std::strlen(text));
+}
+
+/**
+ * Append a single character
+ */
+IrcReply &IrcReply::operator<<(char c)
+{
+    return append(&c, 1);
+}
+
+/**
+ * Append a number in decimal, written backwards into a small local buffer
+ */
+IrcReply &IrcReply::operator<<(unsigned long value)
+{
+    char digits[24];
+    size_t start = sizeof(digits);
+
+    do
+    {
+        digits[--start] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+
+    return append(digits + start, sizeof(digits) - start);
+}
+
+/**
+ * Append raw bytes; what does not fit before the CRLF, or comes after
+ * finish(), is dropped
+ */
+IrcReply &IrcReply::append(const char *data, size_t length)
+{
+    if (_finished || _length >= IRC_REPLY_BODY_MAX)
+        return *this;
+
+    size_t room = IRC_REPLY_BODY_MAX - _length;
+    if (length > room)
+        length = room;
+    std::memcpy(_data + _length, data, length);
+    _length += length;
+    return *this;
+}
+
+/**
+ * Terminate the line with CRLF; the body never exceeds 510 bytes so it always fits.
+ * Once finished, the line no longer accepts bytes and further calls do nothing.
+ */
+IrcReply &IrcReply::finish()
+{
+    if (_finished)
+        return *this;
+    _data[_length++] = '\r';
+    _data[_length++] = '\n';
+    _finished = true;
+    return *this;
+}
+
+/**
+ * @return the bytes of the line
+ */
+const char *IrcReply::data() const
+{
+    return _data;
+}
+
+/**
+ * @return the length of the line
+ */
+size_t IrcReply::size() const
+{
+    return _length;
+}
+
+/**
+ * @return a copy of the line
+ */
+std::string IrcReply::str() const
+{
+    return std::string(_data, _length);
+}
+
+/**
+ * Write the line to a stream, without copying it
+ */
+std::ostream &operator<<(std::ostream &out, const IrcReply &reply)
+{
+    return out.write(reply.data(), reply.size());
+}
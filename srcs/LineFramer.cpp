@@ -0,0 +1,225 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   LineFramer.cpp                                     :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: raveriss <raveriss@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/11/21 10:31:05 by raveriss          #+#    #+#             */
+/*   Updated: 2024/11/21 10:31:05 by raveriss         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../incs/LineFramer.hpp"
+
+/* For memcpy(), memchr() */
+#include <cstring>
+
+/* Masque de position dans l'anneau */
+#define LINE_FRAMER_MASK (LINE_FRAMER_CAPACITY - 1)
+
+/**
+ * Constructor
+ */
+LineFramer::LineFramer()
+: _start(0), _scan(0), _end(0), _discarding(false), _overflowCount(0)
+{}
+
+/**
+ * Copy incoming bytes into the ring, dropping the tail of an oversized line
+ * @return the number of bytes consumed from `data`
+ */
+size_t LineFramer::append(const char *data, size_t length)
+{
+    size_t consumed = 0;
+
+    /* Fin d'une ligne trop longue : tout est ignoré jusqu'au prochain '\n' */
+    if (_discarding)
+    {
+        const char *newline = static_cast<const char *>(std::memchr(data, '\n', length));
+        if (newline == NULL)
+            return length;
+        _discarding = false;
+        consumed = newline - data + 1;
+    }
+
+    size_t count = LINE_FRAMER_CAPACITY - (_end - _start);
+    if (count > length - consumed)
+        count = length - consumed;
+
+    /* Copie en deux morceaux si l'écriture passe la fin de l'anneau */
+    size_t offset = _end & LINE_FRAMER_MASK;
+    size_t first = LINE_FRAMER_CAPACITY - offset;
+    if (first > count)
+        first = count;
+    std::memcpy(_ring + offset, data + consumed, first);
+    std::memcpy(_ring, data + consumed + first, count - first);
+
+    _end += count;
+    return consumed + count;
+}
+
+/**
+ * Extract the next complete line, skipping those longer than IRC_LINE_MAX
+ * @return true if `line` was filled, false if no complete line is buffered
+ */
+bool LineFramer::nextLine(LineSpan &line)
+{
+    while (true)
+    {
+        size_t newline = findNewline(_scan, _end);
+
+        /* Pas de ligne complète : une ligne déjà trop longue est jetée sans attendre sa fin */
+        if (newline == _end)
+        {
+            _scan = _end;
+            if (_end - _start >= IRC_LINE_MAX)
+            {
+                _start = _scan = _end;
+                _discarding = true;
+                ++_overflowCount;
+            }
+            return false;
+        }
+
+        size_t begin = _start;
+        size_t length = newline - begin;
+        _start = _scan = newline + 1;
+
+        /* CRLF : le CR ne fait pas partie de la ligne */
+        if (length > 0 && _ring[(begin + length - 1) & LINE_FRAMER_MASK] == '\r')
+            --length;
+
+        /* La limite de 512 octets inclut le CRLF */
+        if (length > IRC_LINE_MAX - 2)
+        {
+            ++_overflowCount;
+            continue;
+        }
+
+        size_t offset = begin & LINE_FRAMER_MASK;
+        if (offset + length <= LINE_FRAMER_CAPACITY)
+        {
+            line.data = _ring + offset;
+        }
+        else
+        {
+            /* Ligne à cheval sur la fin de l'anneau : recopiée pour être contiguë */
+            size_t first = LINE_FRAMER_CAPACITY - offset;
+            std::memcpy(_line, _ring + offset, first);
+            std::memcpy(_line + first, _ring, length - first);
+            line.data = _line;
+        }
+        line.length = length;
+        return true;
+    }
+}
+
+/**
+ * Extract the next line from an external buffer, copying only partial lines into the ring
+ * @return true if `line` was filled, false once `data` has been fully consumed
+ */
+bool LineFramer::nextLine(const char *&data, size_t &length, LineSpan &line)
+{
+    while (true)
+    {
+        /* Lignes déjà complètes dans l'anneau */
+        if (nextLine(line))
+            return true;
+        if (length == 0)
+            return false;
+
+        const char *newline = static_cast<const char *>(std::memchr(data, '\n', length));
+
+        /* Une ligne est commencée dans l'anneau : on la complète jusqu'au prochain '\n' */
+        if (_discarding || _end != _start)
+        {
+            size_t count = append(data, newline ? newline - data + 1 : length);
+            data += count;
+            length -= count;
+            continue;
+        }
+
+        /* Ligne partielle en fin de tampon : seule copie nécessaire */
+        if (newline == NULL)
+        {
+            if (length >= IRC_LINE_MAX)
+            {
+                _discarding = true;
+                ++_overflowCount;
+            }
+            else
+                append(data, length);
+            data += length;
+            length = 0;
+            return false;
+        }
+
+        /* Ligne complète : rendue en place, sans passer par l'anneau */
+        const char *begin = data;
+        size_t lineLength = newline - begin;
+        data = newline + 1;
+        length -= lineLength + 1;
+
+        if (lineLength > 0 && begin[lineLength - 1] == '\r')
+            --lineLength;
+
+        if (lineLength > IRC_LINE_MAX - 2)
+        {
+            ++_overflowCount;
+            continue;
+        }
+
+        line.data = begin;
+        line.length = lineLength;
+        return true;
+    }
+}
+
+/**
+ * @return the number of lines dropped for exceeding IRC_LINE_MAX since the last call
+ */
+size_t LineFramer::takeOverflowCount()
+{
+    size_t count = _overflowCount;
+    _overflowCount = 0;
+    return count;
+}
+
+/**
+ * @return the number of buffered bytes
+ */
+size_t LineFramer::size() const
+{
+    return _end - _start;
+}
+
+/**
+ * Drop every buffered byte
+ */
+void LineFramer::clear()
+{
+    _start = _scan = _end = 0;
+    _discarding = false;
+}
+
+/**
+ * Search for '\n' between two absolute positions, one contiguous run at a time
+ * @return the absolute position of '\n', or `end` if there is none
+ */
+size_t LineFramer::findNewline(size_t begin, size_t end) const
+{
+    while (begin < end)
+    {
+        size_t offset = begin & LINE_FRAMER_MASK;
+        size_t run = LINE_FRAMER_CAPACITY - offset;
+        if (run > end - begin)
+            run = end - begin;
+
+        const char *found = static_cast<const char *>(std::memchr(_ring + offset, '\n', run));
+        if (found != NULL)
+            return begin + (found - (_ring + offset));
+        begin += run;
+    }
+    return end;
+}
@@ -0,0 +1,37 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   Reactor.cpp                                        :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: raveriss <raveriss@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/11/20 14:16:45 by raveriss          #+#    #+#             */
+/*   Updated: 2024/11/20 14:16:45 by raveriss         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../incs/Reactor.hpp"
+#include "../incs/SelectReactor.hpp"
+#include "../incs/EpollReactor.hpp"
+
+/**
+ * Destructor
+ */
+Reactor::~Reactor()
+{}
+
+/**
+ * Crée le backend demandé au démarrage.
+ * epoll n'existe que sous Linux ; ailleurs seul select() est disponible.
+ * @return un backend alloué, ou NULL si le nom est inconnu ou indisponible
+ */
+Reactor *Reactor::create(const std::string &backend)
+{
+    if (backend == "select")
+        return new SelectReactor();
+#ifdef __linux__
+    if (backend == "epoll")
+        return new EpollReactor();
+#endif
+    return NULL;
+}
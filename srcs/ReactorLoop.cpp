@@ -0,0 +1,222 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   ReactorLoop.cpp                                    :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: raveriss <raveriss@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/11/26 09:12:05 by raveriss          #+#    #+#             */
+/*   Updated: 2024/11/26 09:12:05 by raveriss         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../incs/ReactorLoop.hpp"
+
+/* For MutexGuard */
+#include "../incs/MutexGuard.hpp"
+
+/* For pipe(), read(), write(), close() */
+#include <unistd.h>
+
+/* For fcntl() */
+#include <fcntl.h>
+
+/* Boucle du thread courant */
+static __thread ReactorLoop *currentLoop = NULL;
+
+/**
+ * Constructor
+ */
+IoStats::IoStats()
+: commands(0), waits(0), accepts(0), reads(0), writes(0), clients(0), clientsHigh(0), clientSlots(0)
+{}
+
+/**
+ * Increment a counter of the owning loop
+ */
+void IoStats::count(volatile unsigned long &counter)
+{
+    __sync_add_and_fetch(&counter, 1);
+}
+
+/**
+ * @return the current value of a counter, possibly owned by another loop
+ */
+unsigned long IoStats::load(volatile unsigned long &counter)
+{
+    return __sync_add_and_fetch(&counter, 0);
+}
+
+/**
+ * Overwrite a counter of the owning loop
+ */
+void IoStats::store(volatile unsigned long &counter, unsigned long value)
+{
+    __sync_lock_test_and_set(&counter, value);
+}
+
+/**
+ * Constructor
+ */
+LoopMessage::LoopMessage()
+: fd(-1), serial(0), close(false), resume(false), drain(NULL)
+{}
+
+/**
+ * Constructor, the socket and the backend are opened by the server and
+ * the buffers are allocated by the loop's own thread
+ */
+ReactorLoop::ReactorLoop(Server &server, size_t index, size_t recvBufferSize, uint64_t nowMs)
+: server(server), index(index), thread(), cpu(-1), listenSocket(-1), reactor(NULL),
+  nowMs(nowMs), timers(nowMs), _recvBufferSize(recvBufferSize), _signalled(false)
+{
+    _wakePipe[0] = -1;
+    _wakePipe[1] = -1;
+    pthread_mutex_init(&_mailboxLock, NULL);
+}
+
+/**
+ * Destructor
+ */
+ReactorLoop::~ReactorLoop()
+{
+    if (listenSocket >= 0)
+        close(listenSocket);
+    if (_wakePipe[0] >= 0)
+        close(_wakePipe[0]);
+    if (_wakePipe[1] >= 0)
+        close(_wakePipe[1]);
+    delete reactor;
+    pthread_mutex_destroy(&_mailboxLock);
+}
+
+/**
+ * Copy the client pool figures into ioStats, where other loops may read them
+ */
+void ReactorLoop::publishPoolStats()
+{
+    IoStats::store(ioStats.clients, clientPool.inUse());
+    IoStats::store(ioStats.clientsHigh, clientPool.highWater());
+    IoStats::store(ioStats.clientSlots, clientPool.capacity());
+}
+
+/**
+ * Allocate the receive buffer and preallocate client slabs up to the pool
+ * limit. Called by the loop's thread once pinned: the kernel places pages
+ * on the node of the processor that first touches them.
+ * @return false if memory runs out
+ */
+bool ReactorLoop::allocateBuffers()
+{
+    recvBuffer.resize(_recvBufferSize);
+    return clientPool.reserve(clientPool.limit());
+}
+
+/**
+ * Create the non-blocking wake pipe and watch its read end
+ * @return false if the pipe cannot be created or watched
+ */
+bool ReactorLoop::openMailbox()
+{
+    if (pipe(_wakePipe) < 0)
+        return false;
+    if (fcntl(_wakePipe[0], F_SETFL, O_NONBLOCK) < 0 || fcntl(_wakePipe[1], F_SETFL, O_NONBLOCK) < 0)
+        return false;
+    return reactor->add(_wakePipe[0], Reactor::EV_READ);
+}
+
+/**
+ * @return the descriptor the loop watches for posted messages
+ */
+int ReactorLoop::mailboxFd() const
+{
+    return _wakePipe[0];
+}
+
+/**
+ * Queue a block for `client`, owned by this loop, and wake the loop
+ */
+void ReactorLoop::post(Client *client, const SharedPayload &payload)
+{
+    LoopMessage message;
+    message.fd = client->getSocket();
+    message.serial = client->getSerial();
+    message.payload = payload;
+    post(message);
+}
+
+/**
+ * Queue an addressed message and wake the loop.
+ * Only the first message since the last takeMessages() writes to the pipe.
+ */
+void ReactorLoop::post(const LoopMessage &message)
+{
+    MutexGuard guard(_mailboxLock);
+    _mailbox.push_back(message);
+    if (!_signalled)
+    {
+        _signalled = true;
+        ssize_t written = write(_wakePipe[1], "", 1);
+        (void)written;
+    }
+}
+
+/**
+ * Queue a batch of messages under a single lock and wake the loop once
+ */
+void ReactorLoop::postAll(const std::vector<LoopMessage> &messages)
+{
+    MutexGuard guard(_mailboxLock);
+    _mailbox.insert(_mailbox.end(), messages.begin(), messages.end());
+    if (!_signalled)
+    {
+        _signalled = true;
+        ssize_t written = write(_wakePipe[1], "", 1);
+        (void)written;
+    }
+}
+
+/**
+ * Drain the wake pipe and swap the posted messages into `messages`
+ */
+void ReactorLoop::takeMessages(std::vector<LoopMessage> &messages)
+{
+    char drain[64];
+    while (read(_wakePipe[0], drain, sizeof(drain)) > 0)
+        ;
+
+    messages.clear();
+    MutexGuard guard(_mailboxLock);
+    messages.swap(_mailbox);
+    _signalled = false;
+}
+
+/**
+ * @return the client registered on `fd` if it still carries `serial`,
+ * NULL if it was removed or the fd now belongs to another client
+ */
+Client *ReactorLoop::clientAt(int fd, unsigned long serial) const
+{
+    if (fd < 0 || static_cast<size_t>(fd) >= clientsByFd.size())
+        return NULL;
+    Client *client = clientsByFd[fd];
+    if (client == NULL || client->getSerial() != serial)
+        return NULL;
+    return client;
+}
+
+/**
+ * Bind this loop to the calling thread
+ */
+void ReactorLoop::makeCurrent()
+{
+    currentLoop = this;
+}
+
+/**
+ * @return the loop running on the calling thread, NULL outside of any loop
+ */
+ReactorLoop *ReactorLoop::current()
+{
+    return currentLoop;
+}
@@ -0,0 +1,77 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   ReplyOutbox.cpp                                    :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: raveriss <raveriss@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/11/27 10:21:54 by raveriss          #+#    #+#             */
+/*   Updated: 2024/11/27 10:21:54 by raveriss         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../incs/ReplyOutbox.hpp"
+
+/* Boîte du thread courant */
+static __thread ReplyOutbox *currentOutbox = NULL;
+
+/**
+ * Constructor
+ */
+ReplyOutbox::ReplyOutbox(size_t loopCount)
+: _messages(loopCount)
+{}
+
+/**
+ * Keep a block for `client` until the next flush()
+ */
+void ReplyOutbox::defer(Client *client, const SharedPayload &payload)
+{
+    LoopMessage message;
+    message.fd = client->getSocket();
+    message.serial = client->getSerial();
+    message.payload = payload;
+    _messages[client->getLoop()->index].push_back(message);
+}
+
+/**
+ * Keep a close request for `client`, behind the blocks already deferred
+ */
+void ReplyOutbox::deferClose(Client *client)
+{
+    LoopMessage message;
+    message.fd = client->getSocket();
+    message.serial = client->getSerial();
+    message.close = true;
+    _messages[client->getLoop()->index].push_back(message);
+}
+
+/**
+ * Hand every deferred message to its loop, one mailbox lock per loop
+ */
+void ReplyOutbox::flush(const std::vector<ReactorLoop*> &loops)
+{
+    for (size_t i = 0; i < _messages.size(); ++i)
+    {
+        if (_messages[i].empty())
+            continue;
+        loops[i]->postAll(_messages[i]);
+        _messages[i].clear();
+    }
+}
+
+/**
+ * Bind this outbox to the calling thread
+ */
+void ReplyOutbox::makeCurrent()
+{
+    currentOutbox = this;
+}
+
+/**
+ * @return the outbox of the calling thread, NULL on an event loop
+ */
+ReplyOutbox *ReplyOutbox::current()
+{
+    return currentOutbox;
+}
@@ -0,0 +1,155 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   RuleSet.cpp                                        :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: raveriss <raveriss@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/11/24 16:52:13 by raveriss          #+#    #+#             */
+/*   Updated: 2024/11/24 16:52:13 by raveriss         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../incs/RuleSet.hpp"
+#include "../incs/Casemap.hpp"
+
+/* For std::ifstream */
+#include <fstream>
+
+/* For std::ostringstream */
+#include <sstream>
+
+/**
+ * Constructor
+ */
+RuleSet::RuleSet()
+{}
+
+/**
+ * Destructor
+ */
+RuleSet::~RuleSet()
+{
+    for (size_t i = 0; i < _channels.capacity(); ++i)
+    {
+        if (_channels.occupied(i))
+            delete _channels.valueAt(i);
+    }
+}
+
+/**
+ * Forbid the default words on every channel
+ */
+void RuleSet::loadDefaults()
+{
+    _global.add("salade");
+    _global.add("tomate");
+    _global.add("oignon");
+    _global.compile();
+}
+
+/**
+ * Read the rule file and compile one automaton for the global words
+ * and one per channel section
+ * @return false if the file cannot be read or a section is malformed
+ */
+bool RuleSet::loadFile(const std::string &path)
+{
+    std::ifstream file(path.c_str());
+    if (!file)
+    {
+        _error = "cannot open " + path;
+        return false;
+    }
+
+    WordMatcher *target = &_global;
+    std::string line;
+    size_t lineNumber = 0;
+
+    while (std::getline(file, line))
+    {
+        ++lineNumber;
+
+        /* Espaces et fin de ligne CRLF ignorés aux deux extrémités */
+        std::string::size_type first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line[first] == '#')
+            continue;
+        std::string entry = line.substr(first, line.find_last_not_of(" \t\r") - first + 1);
+
+        if (entry[0] != '[')
+        {
+            target->add(entry);
+            continue;
+        }
+
+        if (entry.size() < 3 || entry[entry.size() - 1] != ']')
+        {
+            std::ostringstream oss;
+            oss << path << ":" << lineNumber << ": malformed section " << entry;
+            _error = oss.str();
+            return false;
+        }
+
+        std::string section = entry.substr(1, entry.size() - 2);
+        if (section == "*")
+        {
+            target = &_global;
+            continue;
+        }
+
+        /* Une section répétée complète la liste déjà commencée */
+        std::string folded = Casemap::fold(section);
+        WordMatcher **existing = _channels.find(folded);
+        if (existing == NULL)
+        {
+            target = new WordMatcher();
+            _channels.set(folded, target);
+        }
+        else
+            target = *existing;
+    }
+
+    _global.compile();
+    for (size_t i = 0; i < _channels.capacity(); ++i)
+    {
+        if (_channels.occupied(i))
+            _channels.valueAt(i)->compile();
+    }
+    return true;
+}
+
+/**
+ * @return the reason of the last loading failure
+ */
+const std::string &RuleSet::error() const
+{
+    return _error;
+}
+
+/**
+ * @return true if the text contains a word forbidden everywhere or on the channel
+ */
+bool RuleSet::matches(const std::string &foldedChannel, const char *data, size_t length) const
+{
+    if (_global.matches(data, length))
+        return true;
+
+    WordMatcher *const *channel = _channels.find(foldedChannel);
+    return channel != NULL && (*channel)->matches(data, length);
+}
+
+/**
+ * @return the number of words forbidden everywhere
+ */
+size_t RuleSet::globalCount() const
+{
+    return _global.size();
+}
+
+/**
+ * @return the number of channels with their own rules
+ */
+size_t RuleSet::channelCount() const
+{
+    return _channels.size();
+}
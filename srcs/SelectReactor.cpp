@@ -0,0 +1,130 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   SelectReactor.cpp                                  :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: raveriss <raveriss@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/11/20 14:21:50 by raveriss          #+#    #+#             */
+/*   Updated: 2024/11/20 14:21:50 by raveriss         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../incs/SelectReactor.hpp"
+
+/* For errno */
+#include <cerrno>
+
+/**
+ * Constructor
+ */
+SelectReactor::SelectReactor()
+: _fdMax(-1)
+{
+    FD_ZERO(&_readSet);
+    FD_ZERO(&_writeSet);
+}
+
+/**
+ * Destructor
+ */
+SelectReactor::~SelectReactor()
+{}
+
+/**
+ * Ajoute un fd aux ensembles surveillés.
+ * select() ne sait pas surveiller un fd supérieur ou égal à FD_SETSIZE.
+ */
+bool SelectReactor::add(int fd, int events)
+{
+    if (fd < 0 || fd >= FD_SETSIZE)
+        return false;
+    if (fd > _fdMax)
+        _fdMax = fd;
+    return modify(fd, events);
+}
+
+/**
+ * Met à jour l'intérêt lecture/écriture d'un fd
+ */
+bool SelectReactor::modify(int fd, int events)
+{
+    if (fd < 0 || fd >= FD_SETSIZE)
+        return false;
+    if (events & EV_READ)
+        FD_SET(fd, &_readSet);
+    else
+        FD_CLR(fd, &_readSet);
+    if (events & EV_WRITE)
+        FD_SET(fd, &_writeSet);
+    else
+        FD_CLR(fd, &_writeSet);
+    return true;
+}
+
+/**
+ * Retire un fd des ensembles surveillés
+ */
+void SelectReactor::remove(int fd)
+{
+    if (fd < 0 || fd >= FD_SETSIZE)
+        return;
+    FD_CLR(fd, &_readSet);
+    FD_CLR(fd, &_writeSet);
+    if (fd == _fdMax)
+        shrinkFdMax();
+}
+
+/**
+ * Redescend _fdMax jusqu'au plus grand fd encore surveillé
+ */
+void SelectReactor::shrinkFdMax()
+{
+    while (_fdMax >= 0 && !FD_ISSET(_fdMax, &_readSet) && !FD_ISSET(_fdMax, &_writeSet))
+        --_fdMax;
+}
+
+/**
+ * Copie les ensembles, appelle select() puis parcourt tous les fd
+ * jusqu'à _fdMax pour collecter ceux qui sont prêts.
+ */
+int SelectReactor::wait(std::vector<ReactorEvent> &events, int timeoutMs)
+{
+    events.clear();
+
+    fd_set readSet = _readSet;
+    fd_set writeSet = _writeSet;
+
+    struct timeval timeout;
+    timeout.tv_sec = timeoutMs / 1000;
+    timeout.tv_usec = (timeoutMs % 1000) * 1000;
+
+    int ready = select(_fdMax + 1, &readSet, &writeSet, NULL, &timeout);
+    if (ready < 0)
+        return errno == EINTR ? 0 : -1;
+
+    for (int fd = 0; fd <= _fdMax && ready > 0; ++fd)
+    {
+        ReactorEvent event;
+        event.fd = fd;
+        event.events = 0;
+        if (FD_ISSET(fd, &readSet))
+            event.events |= EV_READ;
+        if (FD_ISSET(fd, &writeSet))
+            event.events |= EV_WRITE;
+        if (event.events)
+        {
+            events.push_back(event);
+            --ready;
+        }
+    }
+    return static_cast<int>(events.size());
+}
+
+/**
+ * @return the name of the backend
+ */
+const char *SelectReactor::name() const
+{
+    return "select";
+}
@@ -14,13 +14,32 @@
 #include "../incs/Server.hpp"
 #include "../incs/Client.hpp"
 #include "../incs/Channel.hpp"
+#include "../incs/MutexGuard.hpp"
 
 /* Déclaration statique de Server* pour gérer les signaux */
 Server* Server::instance = NULL;
 
+/* Client dont la commande s'exécute sur le thread courant ; NULL hors d'une commande */
+static __thread Client *commandAuthor = NULL;
+
+/* Shard du thread courant, dont le verrou est tenu pendant son lot ; NULL hors d'un shard */
+static __thread ChannelShard *currentShard = NULL;
+
 /**
  * Gestionnaire de signaux pour SIGINT et SIGTSTP
  */
+volatile sig_atomic_t Server::_reloadRequested = 0;
+
+/**
+ * SIGHUP : le rechargement est seulement demandé ici, la boucle
+ * d'événements lance la compilation des règles à l'itération suivante.
+ */
+void Server::handleReloadSignal(int signal)
+{
+	(void)signal;
+	_reloadRequested = 1;
+}
+
 void Server::handleSignal(int signal)
 {
 	const char* signalName;
@@ -42,66 +61,88 @@ void Server::handleSignal(int signal)
  */
 void Server::shutdown()
 {
-
-	/* Libération des clients */
-	for (std::vector<Client*>::iterator it = _clients.begin(); it != _clients.end(); ++it)
+	/**
+	 * Avec plusieurs boucles ou des threads d'exécution, ceux-ci servent peut-être encore
+	 * leurs clients : seuls les sockets d'écoute sont fermés, le reste est
+	 * rendu au système par la fin du processus.
+	 */
+	if (_loops.size() > 1 || !_shards.empty() || _fanout.workerCount() > 0 || _pipeline != NULL)
 	{
-		delete *it;
+		for (size_t i = 0; i < _loops.size(); ++i)
+		{
+			if (_loops[i]->listenSocket >= 0)
+			{
+				close(_loops[i]->listenSocket);
+				_loops[i]->listenSocket = -1;
+			}
+		}
+		return;
 	}
-	_clients.clear();
 
-	/* Libération des clients dans _clientsToRemove */
-	for (std::vector<Client*>::iterator it = _clientsToRemove.begin(); it != _clientsToRemove.end(); ++it)
+	for (size_t i = 0; i < _loops.size(); ++i)
 	{
-		delete *it;
-	}
-	_clientsToRemove.clear();
+		ReactorLoop &loop = *_loops[i];
 
-	/* Réinitialise complètement la capacité des vecteurs */
-	std::vector<Client*>().swap(_clients);
-	std::vector<Client*>().swap(_clientsToRemove);
+		/* Libération des clients dans clientsToRemove (encore présents dans clients) */
+		purgeRemovedClients(loop);
 
-	/* Libération des canaux */
-	for (std::map<std::string, Channel*>::iterator it = _channels.begin(); it != _channels.end(); ++it) 
-	{
-		delete it->second;
+		/* Libération des clients */
+		for (std::vector<Client*>::iterator it = loop.clients.begin(); it != loop.clients.end(); ++it)
+		{
+			loop.clientPool.destroy(*it);
+		}
+		loop.clients.clear();
+
+		/* Réinitialise complètement la capacité des vecteurs */
+		std::vector<Client*>().swap(loop.clients);
+		std::vector<Client*>().swap(loop.clientsToRemove);
+		std::vector<Client*>().swap(loop.clientsByFd);
 	}
-	_channels.clear();
 
-	/* Fermer le socket d'écoute */
-	if (_listenSocket >= 0) 
+	/* Libération des canaux */
+	for (size_t i = 0; i < _channels.capacity(); ++i)
 	{
-		close(_listenSocket);
-		_listenSocket = -1;
+		if (_channels.occupied(i))
+			_channelPool.destroy(_channels.valueAt(i));
 	}
+	_channels.clear();
 
 	/* Libération du Bot */
 	_bot.~Bot();
 
-	/* Libération des descripteurs de fichiers */
-	FD_ZERO(&_masterSet);
-	_fdMax = 0;
+	/* Fermeture des sockets d'écoute et des boucles d'événements */
+	for (size_t i = 0; i < _loops.size(); ++i)
+		delete _loops[i];
+	_loops.clear();
+	for (size_t i = 0; i < _shards.size(); ++i)
+		delete _shards[i];
+	_shards.clear();
+	delete _pipeline;
+	_pipeline = NULL;
 
 	/* Libération de l'instance statique */
 	instance = NULL;
-
-	/* Fermer tous les descripteurs de fichiers ouverts */
-	for (int fd = 0; fd <= _fdMax; ++fd)
-	{
-		if (FD_ISSET(fd, &_masterSet))
-			close(fd);
-	}
 }
 
 /**
  * Constructor
  */
-Server::Server(unsigned short port, const std::string &password)
-: _port(port), _password(password), _serverName("ircserv"), _listenSocket(-1), _fdMax(0)
+Server::Server(unsigned short port, const std::string &password, const ServerConfig &config)
+: _port(port), _password(password), _serverName("ircserv"), _config(config), _pipeline(NULL), _bot(*this)
 {
 	/* Définit l'instance pour l'accès dans le gestionnaire */
 	instance = this;
 
+	/* Verrous des canaux et des pseudonymes, récursifs ; verrou du cache d'accueil */
+	pthread_mutexattr_t attr;
+	pthread_mutexattr_init(&attr);
+	pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+	pthread_mutex_init(&_channelLock, &attr);
+	pthread_mutex_init(&_nickLock, &attr);
+	pthread_mutexattr_destroy(&attr);
+	pthread_mutex_init(&_welcomeLock, NULL);
+	pthread_mutex_init(&_channelIndexLock, NULL);
+
 	/**
 	 * Initialise un gestionnaire de signaux pour permettre une fermeture propre du serveur.
 	 * Configuration pour intercepter SIGINT (Ctrl+C) et SIGTSTP (Ctrl+Z).
@@ -136,6 +177,25 @@ Server::Server(unsigned short port, const std::string &password)
 	 */
 	if (sigaction(CTRL_C, &sa, NULL) == FAILURE || sigaction(CTRL_Z, &sa, NULL) == FAILURE)
 		throw std::runtime_error("Erreur lors de la configuration du signal SIGINT.");
+
+	/* SIGHUP recharge les règles du bot sans interrompre le serveur */
+	sa.sa_handler = &Server::handleReloadSignal;
+	if (sigaction(SIGHUP, &sa, NULL) == FAILURE)
+		throw std::runtime_error("Erreur lors de la configuration du signal SIGHUP.");
+
+	/* Règles du bot : un fichier illisible au démarrage est une erreur de configuration */
+	if (!_config.rulesFile.empty())
+	{
+		std::string error;
+		if (!_bot.loadRules(_config.rulesFile, error))
+			throw std::runtime_error("Erreur lors du chargement des règles : " + error);
+	}
+
+	/* Réponses d'accueil et MOTD, rendus une fois pour tous les clients */
+	std::string motdError;
+	if (!renderWelcome(motdError))
+		throw std::runtime_error("Erreur lors du chargement du MOTD : " + motdError);
+	registerCommands();
 	init();
 }
 
@@ -144,11 +204,22 @@ Server::Server(unsigned short port, const std::string &password)
  */
 Server::~Server()
 {
-	close(_listenSocket);
-	for (std::vector<Client*>::iterator it = _clients.begin(); it != _clients.end(); ++it)
+	for (size_t i = 0; i < _loops.size(); ++i)
 	{
-		delete *it;
-	}
+		ReactorLoop *loop = _loops[i];
+		for (std::vector<Client*>::iterator it = loop->clients.begin(); it != loop->clients.end(); ++it)
+		{
+			loop->clientPool.destroy(*it);
+		}
+		delete loop;
+	}
+	for (size_t i = 0; i < _shards.size(); ++i)
+		delete _shards[i];
+	delete _pipeline;
+	pthread_mutex_destroy(&_channelIndexLock);
+	pthread_mutex_destroy(&_welcomeLock);
+	pthread_mutex_destroy(&_nickLock);
+	pthread_mutex_destroy(&_channelLock);
 }
 
 /**
@@ -156,74 +227,74 @@ Server::~Server()
  */
 void Server::init()
 {
-	/* Création du socket d'écoute */
-	_listenSocket = socket(IPV4, TCP, 0);
-	if (_listenSocket < 0)
-		throw std::runtime_error("Erreur lors de la création du socket d'écoute.");
-
-	/* Configuration pour réutiliser l'adresse et le port */
-	int opt = OPT_ON;
-	if (setsockopt(_listenSocket, TCP, REUSE_ADDR, &opt, sizeof(opt)) < 0)
-		throw std::runtime_error("Erreur lors de la configuration du socket.");
-
-	/* Déclare la structure d'adresse du serveur */
-	sockaddr_in serverAddr;
-
-	/* Initialise la structure avec des zéros */
-	std::memset(&serverAddr, 0, sizeof(serverAddr));
-
 	/**
-	 * `sin` for S.ocket IN.ternet
+	 * Une boucle d'événements par thread demandé. La limite de --max-clients
+	 * est répartie entre les boucles, chacune préallouant sa part.
 	 */
-	
-	/* Définit la famille d'adresses à IPv4 */
-	serverAddr.sin_family = IPV4;
-
-	/* Définit l'adresse IP du serveur à INADDR_ANY */
-	serverAddr.sin_addr.s_addr = ALL_ADDR;
+	size_t count = _config.reactors;
+	size_t share = (_config.maxClients + count - 1) / count;
 
-	/**
-	 * `htons` for Host TO Network Short
-	 */
+	/* Les processeurs demandés doivent figurer dans le masque d'affinité du processus */
+	CpuTopology topology;
+	checkCpus(topology, _config.reactorCpus, "--reactor-cpus");
+	checkCpus(topology, _config.shardCpus, "--shard-cpus");
+	checkCpus(topology, _config.workerCpus, "--worker-cpus");
 
-	/* Définit le port du serveur en convertissant _port en format réseau (big-endian) */
-	serverAddr.sin_port = htons(_port);
+	for (size_t i = 0; i < count; ++i)
+	{
+		ReactorLoop *loop = new ReactorLoop(*this, i, _config.recvBufferSize, TimerWheel::monotonicMs());
+		_loops.push_back(loop);
+		loop->cpu = CpuTopology::pick(_config.reactorCpus, i);
 
-	/*
-	* Associe le socket d'écoute (_listenSocket) à l'adresse IP et au port spécifiés dans serverAddr
-	* en utilisant bind() (lie le descripteur de socket à une adresse locale) ;
-	* lève une exception avec un message détaillé en cas d'échec
-	*/
-	if (bind(_listenSocket, (struct sockaddr*)&serverAddr, sizeof(serverAddr)) < 0)
-		throw std::runtime_error("Erreur lors de la liaison du socket : " + std::string(strerror(errno)));
+		/* Réserve des clients : bornée, et préallouée par la boucle si --max-clients est donné */
+		loop->clientPool.setLimit(share);
+	}
 
-	/* 
-	* Met le socket en mode écoute pour accepter les connexions entrantes,
-	* en spécifiant la taille maximale de la file d'attente avec MAX_CONNEXIONS
-	* (nombre maximal de connexions en attente autorisées par le système) ;
-	* lève une exception en cas d'échec
-	*/
-	if (listen(_listenSocket, MAX_CONNEXIONS) < 0)
-		throw std::runtime_error("Erreur lors de l'écoute sur le socket.");
+	for (size_t i = 0; i < count; ++i)
+	{
+		ReactorLoop &loop = *_loops[i];
+		openListener(loop);
 
-	/**
-	 * _listenSocket : Socket principal d'écoute, utilisé pour accepter les nouvelles
-	 *                 connexions entrantes des clients.
-	 */
+		/**
+		 * reactor : Boucle d'événements choisie au démarrage (epoll ou select),
+		 *           qui surveille le socket d'écoute et les sockets clients actifs.
+		 */
+		loop.reactor = Reactor::create(_config.reactorBackend);
+		if (loop.reactor == NULL)
+			throw std::runtime_error("Backend de boucle d'événements inconnu : " + _config.reactorBackend);
 
-	/**
-	 * _masterSet : Ensemble de descripteurs de fichiers, incluant le socket d'écoute
-	 *              (_listenSocket) et les sockets clients actifs, surveillé par select().
-	 */
+		/* Ajoute le socket d'écoute à la boucle d'événements */
+		if (!loop.reactor->add(loop.listenSocket, Reactor::EV_READ))
+			throw std::runtime_error("Erreur lors de l'enregistrement du socket d'écoute.");
 
-	/* Initialise le set de descripteurs de fichiers pour les connexions */
-	FD_ZERO(&_masterSet);
+		/* Boîte aux lettres : messages des autres boucles pour les clients de celle-ci */
+		if (!loop.openMailbox())
+			throw std::runtime_error("Erreur lors de la création de la boîte aux lettres de la boucle.");
+	}
 
-	/* Ajoute le socket d'écoute au set de descripteurs */
-	FD_SET(_listenSocket, &_masterSet);
+	/* Shards des commandes de canal : chacun possède les canaux dont l'empreinte lui revient */
+	for (size_t i = 0; i < _config.shards; ++i)
+	{
+		ChannelShard *shard = new ChannelShard(*this, i, count);
+		_shards.push_back(shard);
+		shard->cpu = CpuTopology::pick(_config.shardCpus, i);
+		if (!shard->openWakePipe())
+			throw std::runtime_error("Erreur lors de la création du tube de réveil d'un shard.");
+	}
 
-	/* Met à jour la valeur maximale des descripteurs de fichiers */
-	_fdMax = _listenSocket;
+	/**
+	 * Mode pipeline : un seul fil d'état exécute toutes les commandes, dans
+	 * l'ordre de l'anneau. Les shards se partageraient les canaux avec lui.
+	 */
+	if (_config.pipeline)
+	{
+		if (!_shards.empty())
+			throw std::runtime_error("--pipeline=on et --shards ne peuvent pas être combinés.");
+		_pipeline = new CommandPipeline(count);
+		_pipeline->cpu = CpuTopology::pick(_config.shardCpus, 0);
+		if (!_pipeline->openWakePipe())
+			throw std::runtime_error("Erreur lors de la création du tube de réveil du pipeline.");
+	}
 
     /**
 	 * `if` for I.nterF.ace
@@ -266,7 +337,107 @@ void Server::init()
         freeifaddrs(ifaddr);
     }
 
-    std::cout << "Serveur IRC démarré sur " << _serverIp << ":" << _port << std::endl;
+    std::cout << "Serveur IRC démarré sur " << _serverIp << ":" << _port
+              << " (backend " << _loops[0]->reactor->name() << ", " << _loops.size()
+              << (_loops.size() > 1 ? " boucles, " : " boucle, ") << _shards.size()
+              << (_shards.size() > 1 ? " shards)" : " shard)") << std::endl;
+}
+
+/**
+ * Vérifie que chaque processeur d'une option --*-cpus est en ligne et
+ * permis par le masque d'affinité du processus (taskset, cgroups).
+ * Lance une exception sinon.
+ * @param topology : la topologie lue au démarrage
+ * @param cpus : les processeurs demandés
+ * @param option : le nom de l'option, pour le message d'erreur
+ */
+void Server::checkCpus(const CpuTopology &topology, const std::vector<int> &cpus, const std::string &option)
+{
+	for (size_t i = 0; i < cpus.size(); ++i)
+	{
+		if (!topology.isAllowed(cpus[i]))
+		{
+			std::ostringstream message;
+			message << "Processeur " << cpus[i] << " indisponible pour " << option << ".";
+			throw std::runtime_error(message.str());
+		}
+	}
+}
+
+/**
+ * Crée le socket d'écoute de la boucle, lié au port du serveur.
+ * Lance une exception en cas d'échec.
+ * @param loop : la boucle qui acceptera les connexions de ce socket
+ */
+void Server::openListener(ReactorLoop &loop)
+{
+	/* Création du socket d'écoute */
+	loop.listenSocket = socket(IPV4, TCP, 0);
+	if (loop.listenSocket < 0)
+		throw std::runtime_error("Erreur lors de la création du socket d'écoute.");
+
+	/* Configuration pour réutiliser l'adresse et le port */
+	int opt = OPT_ON;
+	if (setsockopt(loop.listenSocket, TCP, REUSE_ADDR, &opt, sizeof(opt)) < 0)
+		throw std::runtime_error("Erreur lors de la configuration du socket.");
+
+	/**
+	 * Avec plusieurs boucles, chacune lie son propre socket au même port :
+	 * le noyau répartit les connexions entrantes entre elles.
+	 */
+#ifdef SO_REUSEPORT
+	if (_loops.size() > 1 && setsockopt(loop.listenSocket, GLOB_SOCK_OPT, SO_REUSEPORT, &opt, sizeof(opt)) < 0)
+		throw std::runtime_error("Erreur lors de la configuration de SO_REUSEPORT : " + std::string(strerror(errno)));
+#endif
+
+	/* Déclare la structure d'adresse du serveur */
+	sockaddr_in serverAddr;
+
+	/* Initialise la structure avec des zéros */
+	std::memset(&serverAddr, 0, sizeof(serverAddr));
+
+	/**
+	 * `sin` for S.ocket IN.ternet
+	 */
+	
+	/* Définit la famille d'adresses à IPv4 */
+	serverAddr.sin_family = IPV4;
+
+	/* Définit l'adresse IP du serveur à INADDR_ANY */
+	serverAddr.sin_addr.s_addr = ALL_ADDR;
+
+	/**
+	 * `htons` for Host TO Network Short
+	 */
+
+	/* Définit le port du serveur en convertissant _port en format réseau (big-endian) */
+	serverAddr.sin_port = htons(_port);
+
+	/*
+	* Associe le socket d'écoute (loop.listenSocket) à l'adresse IP et au port spécifiés dans serverAddr
+	* en utilisant bind() (lie le descripteur de socket à une adresse locale) ;
+	* lève une exception avec un message détaillé en cas d'échec
+	*/
+	if (bind(loop.listenSocket, (struct sockaddr*)&serverAddr, sizeof(serverAddr)) < 0)
+		throw std::runtime_error("Erreur lors de la liaison du socket : " + std::string(strerror(errno)));
+
+	/* 
+	* Met le socket en mode écoute pour accepter les connexions entrantes,
+	* en spécifiant la taille maximale de la file d'attente avec MAX_CONNEXIONS
+	* (nombre maximal de connexions en attente autorisées par le système) ;
+	* lève une exception en cas d'échec
+	*/
+	if (listen(loop.listenSocket, MAX_CONNEXIONS) < 0)
+		throw std::runtime_error("Erreur lors de l'écoute sur le socket.");
+
+	/**
+	 * listenSocket : Socket d'écoute de la boucle, utilisé pour accepter les nouvelles
+	 *                connexions entrantes des clients.
+	 * Il est non bloquant : handleNewConnection() accepte jusqu'à EAGAIN,
+	 * ce qu'exige le mode edge-triggered d'epoll.
+	 */
+	if (fcntl(loop.listenSocket, F_SETFL, O_NONBLOCK) < 0)
+		throw std::runtime_error("Erreur lors du passage du socket d'écoute en mode non bloquant.");
 }
 
 /**
@@ -274,131 +445,876 @@ void Server::init()
  */
 void Server::run()
 {
+	/**
+	 * Les shards, le fil d'état du pipeline, les boucles 1 à N - 1 et les
+	 * travailleurs de diffusion ont chacun leur thread, créé avec tous les signaux bloqués : SIGINT et SIGHUP restent
+	 * traités par le thread principal.
+	 */
+	sigset_t blocked;
+	sigset_t previous;
+	sigfillset(&blocked);
+	pthread_sigmask(SIG_BLOCK, &blocked, &previous);
+	for (size_t i = 0; i < _shards.size(); ++i)
+	{
+		if (pthread_create(&_shards[i]->thread, NULL, &Server::shardThread, _shards[i]) != 0)
+		{
+			pthread_sigmask(SIG_SETMASK, &previous, NULL);
+			throw std::runtime_error("Erreur lors de la création du thread d'un shard.");
+		}
+	}
+	for (size_t i = 1; i < _loops.size(); ++i)
+	{
+		if (pthread_create(&_loops[i]->thread, NULL, &Server::loopThread, _loops[i]) != 0)
+		{
+			pthread_sigmask(SIG_SETMASK, &previous, NULL);
+			throw std::runtime_error("Erreur lors de la création du thread d'une boucle d'événements.");
+		}
+	}
+	if (_pipeline != NULL && pthread_create(&_pipeline->thread, NULL, &Server::pipelineThread, this) != 0)
+	{
+		pthread_sigmask(SIG_SETMASK, &previous, NULL);
+		throw std::runtime_error("Erreur lors de la création du fil d'état du pipeline.");
+	}
+	if (_config.fanoutThreshold > 0 && !_fanout.start(_config.fanoutWorkers, _loops, _config.workerCpus))
+	{
+		pthread_sigmask(SIG_SETMASK, &previous, NULL);
+		throw std::runtime_error("Erreur lors du démarrage des travailleurs de diffusion.");
+	}
+	pthread_sigmask(SIG_SETMASK, &previous, NULL);
+
+	/* La boucle 0 tourne sur le thread principal */
+	runLoop(*_loops[0]);
+}
+
+/**
+ * Point d'entrée des threads des boucles secondaires. Une boucle qui
+ * s'arrête sur une erreur arrête le processus, comme la boucle principale.
+ */
+void *Server::loopThread(void *arg)
+{
+	ReactorLoop *loop = static_cast<ReactorLoop *>(arg);
+	try
+	{
+		loop->server.runLoop(*loop);
+	}
+	catch (const std::exception &e)
+	{
+		std::cerr << "Erreur du serveur (boucle " << loop->index << ") : " << e.what() << std::endl;
+		std::exit(EXIT_FAILURE);
+	}
+	return NULL;
+}
+
+/**
+ * Boucle d'événements : ne sert que les clients acceptés sur son propre
+ * socket d'écoute. Canaux et pseudonymes ne sont touchés que sous leur
+ * verrou, pris par la commande qui en a besoin.
+ * @param loop : la boucle à faire tourner sur le thread appelant
+ */
+void Server::runLoop(ReactorLoop &loop)
+{
+	/**
+	 * Epingle la boucle avant d'allouer ses tampons : le noyau place une page
+	 * sur le nœud NUMA du processeur qui la touche en premier.
+	 */
+	if (loop.cpu >= 0 && !CpuTopology::pinCurrentThread(loop.cpu))
+		throw std::runtime_error("Erreur lors de l'épinglage d'une boucle d'événements.");
+	if (!loop.allocateBuffers())
+		throw std::runtime_error("Erreur lors de la préallocation des clients.");
+
+	/* Les envois vers les clients des autres boucles passeront par leur boîte aux lettres */
+	loop.makeCurrent();
 
 	/* Boucle principale du serveur, tourne indéfiniment */
 	while (true)
 	{
         /** 
-         * _masterSet :
-         * Contient tous les descripteurs actifs à surveiller (ex. : socket d'écoute, clients connectés).
-         * Initialisé au démarrage du serveur et mis à jour avec chaque connexion ou déconnexion.
-		 * 
-         * readSet :
-         * Copie de _masterSet à chaque itération. Utilisé pour vérifier quels descripteurs sont prêts pour la lecture
-         * (données des clients ou nouvelles connexions).
+         * Attend que des descripteurs soient prêts, au plus REACTOR_TIMEOUT_MS,
+         * sans attendre si des clients ont encore des données à lire.
+         * Seuls les descripteurs actifs sont renvoyés dans events : le coût d'un
+         * réveil ne dépend pas du nombre de connexions inactives.
+         * Lance une exception en cas d'erreur.
          */
-		fd_set readSet = _masterSet;
+		int timeoutMs = loop.readBacklog.empty() ? loop.timers.timeoutMs(loop.nowMs, REACTOR_TIMEOUT_MS) : 0;
+		if (loop.reactor->wait(loop.events, timeoutMs) < 0)
+			throw std::runtime_error("Erreur lors de l'attente des événements.");
+		IoStats::count(loop.ioStats.waits);
 
-        /** 
-         * writeSet :
-         * Ensemble temporaire pour les descripteurs prêts pour l'écriture. Initialisé à vide ici avec FD_ZERO.
-         * Peut être configuré si le serveur gère l'écriture asynchrone vers les clients.
-         */
-		fd_set writeSet;
-		FD_ZERO(&writeSet);
-		
-		/* Délai pour la fonction select */
-		struct timeval timeout;
+		/* Une seule lecture de l'horloge par itération, partagée par tous les traitements */
+		loop.nowMs = TimerWheel::monotonicMs();
 
-		/* Intervalle de 1 seconde pour déclencher régulièrement les vérifications PING */
-		timeout.tv_sec = 1;
-		timeout.tv_usec = 0;
+		/* Parcourt uniquement les descripteurs signalés */
+		for (size_t i = 0; i < loop.events.size(); ++i)
+		{
+			int fd = loop.events[i].fd;
 
-        /** 
-         * Surveille l'activité sur les descripteurs dans readSet, jusqu'à _fdMax.
-         * Timeout défini à 1 seconde pour des vérifications régulières.
-         * Lance une exception en cas d'erreur.
-         */
-		if (select(_fdMax + 1, &readSet, NULL, NULL, &timeout) < 0)
-			throw std::runtime_error("Erreur lors de la sélection des descripteurs.");
-
-		/* Parcourt tous les descripteurs pour vérifier les événements */
-		for (int fd = 0; fd <= _fdMax; ++fd)
-		{            
-			/** 
-			 * Vérifie si le descripteur fd contient des données prêtes à être lues dans readSet.
-			 * Indique qu'il y a des données en attente de traitement sur ce descripteur.
-			 */
-			if (FD_ISSET(fd, &readSet))
+            /** 
+             * Si le client se présente au listenSocket, c'est un nouveau client.
+             * handleNewConnection() est appelé pour accepter cette connexion et
+             * lui attribuer un descripteur de socket spécifique.
+             */
+			if (fd == loop.listenSocket)
 			{
-                /** 
-                 * Si le client se présente au _listenSocket, c'est un nouveau client.
-                 * handleNewConnection() est appelé pour accepter cette connexion et
-                 * lui attribuer un descripteur de socket spécifique.
-                 */
-				if (fd == _listenSocket)
-				{
-					/* Nouvelle connexion entrante */
-					handleNewConnection();
-				}
-				
-                /** 
-                 * Sinon, le client est déjà connecté : on traite le message reçu.
-                 */
-				else
-				{
-					/* Traite les données provenant d'un client existant */
-					Client *client = NULL;
-					for (std::vector<Client*>::iterator it = _clients.begin(); it != _clients.end(); ++it)
-					{
-						/* Trouve le client correspondant au descripteur */
-						if ((*it)->getSocket() == fd)
-						{
-							client = *it;
-							break;
-						}
-					}
-					
-					/* Si un client est trouvé, traite le message reçu */
-					if (client)
-						handleClientMessage(client);
-				}
+				/* Nouvelle connexion entrante */
+				handleNewConnection(loop);
+			}
+
+			/* Des messages d'autres boucles attendent d'être placés dans les files d'envoi */
+			else if (fd == loop.mailboxFd())
+			{
+				deliverMessages(loop);
+			}
+
+            /** 
+             * Sinon, le client est déjà connecté : on traite le message reçu.
+             */
+			else
+			{
+				/**
+				 * Trouve le client correspondant au descripteur : une simple lecture
+				 * dans la table indexée par fd, quel que soit le nombre de clients.
+				 */
+				Client *client = NULL;
+				if (fd >= 0 && static_cast<size_t>(fd) < loop.clientsByFd.size())
+					client = loop.clientsByFd[fd];
+
+				if (client == NULL)
+					continue;
+
+				/* Le socket accepte de nouveau des données : reprend l'envoi de sa file */
+				if (loop.events[i].events & Reactor::EV_WRITE)
+					flushClient(client);
+
+				/* Traite les données reçues */
+				if ((loop.events[i].events & Reactor::EV_READ) && !client->isClosing())
+					handleClientMessage(client);
 			}
 		}
 
-		/* Suppression différée des clients après la boucle principale */
-		for (std::vector<Client*>::iterator it = _clientsToRemove.begin(); it != _clientsToRemove.end(); ++it)
+		/* Lecture des clients interrompus au tour précédent */
+		serviceReadBacklog(loop);
+
+		/* Echéances d'enregistrement, de PING et de PONG */
+		runTimers(loop);
+
+		/* Rechargement des règles et du MOTD : demandé par SIGHUP, règles installées une fois compilées */
+		if (loop.index == 0)
 		{
-			delete *it;
+			if (_reloadRequested)
+			{
+				_reloadRequested = 0;
+				rehash();
+			}
+			_bot.applyPendingRules();
 		}
-		_clientsToRemove.clear();
+
+		/* Envoi groupé des réponses produites pendant l'itération */
+		flushPendingClients(loop);
+
+		/* Suppression différée des clients après la boucle principale */
+		purgeRemovedClients(loop);
+
+		/* Etat de la réserve, lu par STATS z depuis les autres boucles */
+		loop.publishPoolStats();
 	}
 }
 
-std::string Server::getBackgroundColorCode(int socket)
+/**
+ * Point d'entrée des threads des shards
+ */
+void *Server::shardThread(void *arg)
 {
-	/* Génère un code de couleur de fond de 41 à 47 */
-	int colorCode = 41 + (socket % 7);
-	std::stringstream color;
-
-	/* 1 pour le gras, 97 pour le texte en blanc vif */
-	color << "\033[1;97;" << colorCode << "m";
-	return color.str();
+	ChannelShard *shard = static_cast<ChannelShard *>(arg);
+	try
+	{
+		shard->server.runShard(*shard);
+	}
+	catch (const std::exception &e)
+	{
+		std::cerr << "Erreur du serveur (shard " << shard->index << ") : " << e.what() << std::endl;
+		std::exit(EXIT_FAILURE);
+	}
+	return NULL;
 }
 
-void Server::printClientInfo(int newSocket, const std::string& host)
+/**
+ * Exécute, dans leur ordre d'arrivée, les commandes confiées au shard.
+ * Le verrou du shard, qui ne protège que ses canaux, est pris une fois
+ * pour CHANNELSHARD_BATCH commandes au plus : les autres shards tournent
+ * en même temps. Les réponses sont déposées dans les boîtes aux lettres
+ * des boucles une fois le verrou rendu, puis les clients décomptés ; le
+ * dernier décompte d'un client suspendu publie sa reprise, après ses réponses.
+ * @param shard : le shard à faire tourner sur le thread appelant
+ */
+void Server::runShard(ChannelShard &shard)
 {
-	std::string colorCode = getBackgroundColorCode(newSocket);
-	std::cout << colorCode
-			  << "\nClient " << newSocket << ", IP " << host
-			  << ". Cmds PASS, NICK et USER pour enregistrer le client."
-			  << "\033[0m\033[K" << std::endl;
+	/* Epinglé avant sa première allocation, comme les boucles */
+	if (shard.cpu >= 0 && !CpuTopology::pinCurrentThread(shard.cpu))
+		throw std::runtime_error("Erreur lors de l'épinglage d'un shard.");
+
+	/* sendToClient() met de côté les réponses produites par ce thread */
+	shard.outbox.makeCurrent();
+	currentShard = &shard;
+
+	ShardTask task;
+	std::vector<Client*> executed;
+	while (true)
+	{
+		shard.waitForTasks();
+		{
+			MutexGuard guard(shard.lock);
+			for (size_t n = 0; n < CHANNELSHARD_BATCH && shard.pop(task); ++n)
+			{
+				/**
+				 * Un expéditeur retiré depuis (erreur d'envoi, PING sans réponse...) est
+				 * toujours alloué, mais ses commandes en attente sont abandonnées : un JOIN
+				 * le rajouterait à un canal qu'il a quitté.
+				 */
+				executed.push_back(task.client);
+				if (task.client->isClosing() || task.client->isCloseRequested())
+					continue;
+
+				IrcMessage message;
+				if (message.parse(task.line.data(), task.line.size()))
+					executeMessage(task.client, message, _commands.find(message.command()));
+			}
+		}
+		shard.outbox.flush(_loops);
+
+		/* Réponses déposées : les boucles peuvent exécuter la suite, ou détruire les clients */
+		for (size_t i = 0; i < executed.size(); ++i)
+		{
+			/* Adresse lue avant le décompte, dernier accès de ce thread au client */
+			Client *client = executed[i];
+			ReactorLoop *loop = client->getLoop();
+			LoopMessage resume;
+			resume.fd = client->getSocket();
+			resume.serial = client->getSerial();
+			resume.resume = true;
+			if (client->finishQueuedCommand())
+				loop->post(resume);
+		}
+		executed.clear();
+	}
 }
 
 /**
- * Process a command received from a client
+ * Point d'entrée du fil d'état du pipeline
  */
-void Server::handleNewConnection()
+void *Server::pipelineThread(void *arg)
 {
-    /** 
-     * Attribue un fd unique au nouveau client présenté sur _listenSocket.
-     */
-	int fdNewClient = accept(_listenSocket, NULL, NULL);
-	if (fdNewClient == FAILURE)
+	Server *server = static_cast<Server *>(arg);
+	try
 	{
-		perror("accept");
-		return;
+		server->runPipeline();
 	}
+	catch (const std::exception &e)
+	{
+		std::cerr << "Erreur du serveur (fil d'état) : " << e.what() << std::endl;
+		std::exit(EXIT_FAILURE);
+	}
+	return NULL;
+}
+
+/**
+ * Fil d'état du pipeline : exécute les commandes publiées par les boucles,
+ * dans l'ordre des séquences, en lisant chaque case en place. Chaque
+ * commande prend les verrous de l'état qu'elle touche ; après
+ * COMMANDPIPELINE_BATCH commandes au plus, les cases sont rendues aux
+ * boucles, les réponses déposées, puis les clients décomptés.
+ */
+void Server::runPipeline()
+{
+	/* Epinglé avant sa première allocation, comme les boucles */
+	if (_pipeline->cpu >= 0 && !CpuTopology::pinCurrentThread(_pipeline->cpu))
+		throw std::runtime_error("Erreur lors de l'épinglage du fil d'état.");
+
+	/* sendToClient() et removeClient() mettent de côté ce que produit ce thread */
+	_pipeline->outbox.makeCurrent();
+
+	std::vector<Client*> executed;
+	while (true)
+	{
+		_pipeline->waitForRecords();
+		CommandRecord *record;
+		for (size_t n = 0; n < COMMANDPIPELINE_BATCH && (record = _pipeline->next()) != NULL; ++n)
+		{
+			/* Le client compte la case : il reste alloué jusqu'au décompte, après le lot */
+			Client *client = record->client;
+			executed.push_back(client);
+
+			if (record->kind == CommandRecord::COMMAND && !record->valid)
+				continue;
+
+			/* L'expéditeur a pu quitter le serveur, ou demandé à le quitter, depuis la lecture */
+			if (client->isClosing() || client->isCloseRequested())
+				continue;
+
+			if (record->kind == CommandRecord::END_OF_STREAM)
+			{
+				/* Retiré ici, après ses commandes : la boucle le détruit à la livraison */
+				removeClient(client);
+				continue;
+			}
+			if (record->kind == CommandRecord::LINE_TOO_LONG)
+			{
+				const std::string &nick = client->getNickname().empty() ? "*" : client->getNickname();
+				sendToClient(client, IrcMessageBuilder::buildInputTooLongError(_serverName, nick));
+				continue;
+			}
+
+			executeMessage(client, record->message, record->entry);
+		}
+		_pipeline->release();
+		_pipeline->outbox.flush(_loops);
+
+		/* Réponses déposées : les boucles peuvent détruire les clients ; aucune ne suspend sa lecture ici */
+		for (size_t i = 0; i < executed.size(); ++i)
+			executed[i]->finishQueuedCommand();
+		executed.clear();
+	}
+}
+
+/**
+ * Place dans les files d'envoi les blocs déposés par les autres boucles.
+ * Un message dont le client a été détruit, ou dont le fd a été réattribué
+ * entre-temps, est ignoré. Les clients repris par leur shard ne le sont
+ * qu'une fois toute la boîte livrée : une reprise exécute des lignes, qui
+ * peuvent elles-mêmes livrer la boîte.
+ * @param loop : la boucle propriétaire des destinataires
+ */
+void Server::deliverMessages(ReactorLoop &loop)
+{
+	loop.takeMessages(loop.inbox);
+	for (size_t i = 0; i < loop.inbox.size(); ++i)
+	{
+		const LoopMessage &message = loop.inbox[i];
+		Client *client = loop.clientAt(message.fd, message.serial);
+
+		if (client != NULL)
+		{
+			/* Fermeture demandée par le fil d'état, après les réponses qui la précèdent */
+			if (message.close)
+				removeClient(client);
+			/* Dernière commande confiée aux shards exécutée, ses réponses livrées juste avant */
+			else if (message.resume)
+				loop.resumed.push_back(client);
+			else
+				sendToClient(client, message.payload);
+		}
+
+		/* Dernier bloc d'un groupe d'un travailleur : le canal peut revenir à l'envoi direct */
+		if (message.drain)
+			message.drain->release();
+	}
+	loop.inbox.clear();
+
+	while (!loop.resumed.empty())
+	{
+		Client *client = loop.resumed.back();
+		loop.resumed.pop_back();
+		resumeClient(client);
+	}
+}
+
+/**
+ * Reprend la lecture des clients qui ont épuisé leur budget au tour
+ * précédent. Avec epoll en mode edge-triggered, aucun nouvel événement ne
+ * serait signalé pour ces données déjà présentes dans le noyau.
+ */
+void Server::serviceReadBacklog(ReactorLoop &loop)
+{
+	std::vector<Client*> backlog;
+	backlog.swap(loop.readBacklog);
+
+	for (size_t i = 0; i < backlog.size(); ++i)
+	{
+		Client *client = backlog[i];
+		client->setReadPending(false);
+		if (!client->isClosing())
+			handleClientMessage(client);
+	}
+}
+
+/**
+ * Horloge monotone en secondes, lue une fois en début d'itération par la
+ * boucle du thread appelant.
+ */
+time_t Server::now() const
+{
+	ReactorLoop *loop = ReactorLoop::current();
+	return static_cast<time_t>((loop ? loop->nowMs : TimerWheel::monotonicMs()) / 1000);
+}
+
+/**
+ * Arme le minuteur du client pour dans `seconds` secondes.
+ * Armer un minuteur déjà armé le déplace : coût constant dans les deux cas.
+ */
+void Server::armKeepalive(Client *client, time_t seconds)
+{
+	ReactorLoop &loop = *client->getLoop();
+	loop.timers.schedule(&client->getKeepaliveTimer(), loop.nowMs + static_cast<uint64_t>(seconds) * 1000);
+}
+
+/**
+ * Avance la roue jusqu'à l'instant courant. Seuls les clients dont
+ * l'échéance est atteinte sont visités, jamais l'ensemble des clients.
+ */
+void Server::runTimers(ReactorLoop &loop)
+{
+	loop.expiredTimers.clear();
+	loop.timers.advance(loop.nowMs, loop.expiredTimers);
+	if (loop.expiredTimers.empty())
+		return;
+
+	for (size_t i = 0; i < loop.expiredTimers.size(); ++i)
+	{
+		Client *client = static_cast<Client *>(loop.expiredTimers[i]->owner);
+		if (!client->isClosing())
+			handleKeepaliveTimer(client);
+	}
+}
+
+/**
+ * Traite l'échéance du client selon ce qu'elle surveille.
+ * L'activité ne réarme pas le minuteur à chaque lecture : elle est
+ * comparée ici, et le minuteur est reporté d'autant s'il a sonné trop tôt.
+ */
+void Server::handleKeepaliveTimer(Client *client)
+{
+	switch (client->getKeepaliveState())
+	{
+		/* La connexion ne s'est pas enregistrée à temps */
+		case Client::KEEPALIVE_REGISTRATION:
+			if (!client->isRegistered())
+			{
+				closeLink(client, "Registration timeout");
+				return;
+			}
+			client->setKeepaliveState(Client::KEEPALIVE_IDLE);
+			/* fall through */
+
+		/* Sans activité depuis PING_INTERVAL, le serveur sonde le client */
+		case Client::KEEPALIVE_IDLE:
+		{
+			time_t idle = now() - client->getLastActivityTime();
+			if (idle < PING_INTERVAL)
+			{
+				armKeepalive(client, PING_INTERVAL - idle);
+				return;
+			}
+			sendToClient(client, IrcMessageBuilder::buildPingMessage(_serverName));
+			client->setKeepaliveState(Client::KEEPALIVE_AWAITING_PONG);
+			armKeepalive(client, PING_RESPONSE_DELAY);
+			return;
+		}
+
+		/* Rien reçu depuis le PING : la connexion est considérée comme morte */
+		case Client::KEEPALIVE_AWAITING_PONG:
+			closeLink(client, "Ping timeout");
+			return;
+	}
+}
+
+/**
+ * Envoie ERROR au client puis le retire : la file d'envoi est vidée
+ * une dernière fois avant la fermeture du socket.
+ */
+void Server::closeLink(Client *client, const std::string &reason)
+{
+	std::cout << "Client " << client->getSocket() << " déconnecté : " << reason << std::endl;
+	sendToClient(client, IrcMessageBuilder::buildClosingLinkMessage(client->getHostname(), reason));
+	removeClient(client);
+}
+
+/**
+ * Supprime les clients retirés pendant l'itération.
+ * removeClient() ne touche pas à clients afin que les gestionnaires
+ * puissent le parcourir sans risque ; le nettoyage se fait ici, en une passe.
+ */
+void Server::purgeRemovedClients(ReactorLoop &loop)
+{
+	if (loop.clientsToRemove.empty())
+		return;
+
+	/* Retire d'un coup tous les clients marqués de la liste des clients actifs */
+	std::vector<Client*>::iterator last = loop.clients.begin();
+	for (std::vector<Client*>::iterator it = loop.clients.begin(); it != loop.clients.end(); ++it)
+	{
+		if (!(*it)->isClosing())
+			*last++ = *it;
+	}
+	loop.clients.erase(last, loop.clients.end());
+
+	/* Un client retiré n'a plus rien à lire */
+	last = loop.readBacklog.begin();
+	for (std::vector<Client*>::iterator it = loop.readBacklog.begin(); it != loop.readBacklog.end(); ++it)
+	{
+		if (!(*it)->isClosing())
+			*last++ = *it;
+	}
+	loop.readBacklog.erase(last, loop.readBacklog.end());
+
+	/* Dernière tentative, sans attendre, pour les réponses d'adieu (ex. : mot de passe incorrect) */
+	for (std::vector<Client*>::iterator it = loop.clientsToRemove.begin(); it != loop.clientsToRemove.end(); ++it)
+	{
+		if ((*it)->hasPendingOutput())
+			writeOutput(*it);
+	}
+
+    /**
+     * Le client quitte ses canaux, partagés avec les autres boucles, sous le
+     * verrou de chacun. Un client dont des commandes attendent encore sur un
+     * shard ou dans l'anneau du pipeline reste alloué : il sera détruit à une
+     * itération suivante, une fois ces commandes exécutées.
+     */
+	last = loop.clientsToRemove.begin();
+	for (std::vector<Client*>::iterator it = loop.clientsToRemove.begin(); it != loop.clientsToRemove.end(); ++it)
+	{
+		if ((*it)->queuedCommands() > 0)
+			*last++ = *it;
+		else
+		{
+			detachFromChannels(*it);
+			loop.clientPool.destroy(*it);
+		}
+	}
+	loop.clientsToRemove.erase(last, loop.clientsToRemove.end());
+}
+
+/**
+ * Place un message dans la file d'envoi du client.
+ * Rien n'est écrit ici : les réponses destinées au même client pendant une
+ * itération de la boucle sont regroupées puis envoyées en un seul writev()
+ * par flushPendingClients(). Un client qui ne lit pas coûte de la mémoire
+ * (bornée par MAX_SENDQ_BYTES), jamais de latence pour les autres.
+ * @param client : le client destinataire
+ * @param message : le message complet, CRLF compris
+ */
+void Server::sendToClient(Client *client, const std::string &message)
+{
+	/* Un client retiré ne reçoit plus rien */
+	if (client == NULL || client->isClosing())
+		return;
+
+	sendToClient(client, SharedPayload(message));
+}
+
+/**
+ * Place un message partagé dans la file d'envoi du client : la file retient
+ * le bloc du message, qui n'est copié qu'une fois pour tous ses destinataires.
+ */
+void Server::sendToClient(Client *client, const SharedPayload &payload)
+{
+	/* Un client retiré ne reçoit plus rien */
+	if (client == NULL || client->isClosing())
+		return;
+
+	/* Exécuté par un shard ou le fil d'état : le bloc sera déposé à la fin du lot */
+	ReplyOutbox *outbox = ReplyOutbox::current();
+	if (outbox != NULL)
+	{
+		outbox->defer(client, payload);
+		return;
+	}
+
+	/* Client d'une autre boucle : le bloc lui est confié par sa boîte aux lettres */
+	ReactorLoop *owner = client->getLoop();
+	if (owner != ReactorLoop::current())
+	{
+		owner->post(client, payload);
+		return;
+	}
+
+	client->queueOutput(payload);
+	scheduleFlush(client);
+}
+
+/**
+ * Copie une réponse composée en place dans la file d'envoi du client :
+ * elle rejoint le dernier bloc de la file, sans allocation tant qu'il a la place.
+ */
+void Server::sendToClient(Client *client, const IrcReply &reply)
+{
+	/* Un client retiré ne reçoit plus rien */
+	if (client == NULL || client->isClosing())
+		return;
+
+	/* Exécuté par un shard ou le fil d'état : la réponse voyage dans un bloc partagé */
+	ReplyOutbox *outbox = ReplyOutbox::current();
+	if (outbox != NULL)
+	{
+		outbox->defer(client, SharedPayload(reply.data(), reply.size()));
+		return;
+	}
+
+	/* Client d'une autre boucle : la réponse voyage dans un bloc partagé */
+	ReactorLoop *owner = client->getLoop();
+	if (owner != ReactorLoop::current())
+	{
+		owner->post(client, SharedPayload(reply.data(), reply.size()));
+		return;
+	}
+
+	client->queueOutput(reply.data(), reply.size());
+	scheduleFlush(client);
+}
+
+/**
+ * Applique la limite de la file d'envoi, puis programme l'envoi de fin d'itération.
+ */
+void Server::scheduleFlush(Client *client)
+{
+	/* Le client ne lit plus ses réponses : on le déconnecte plutôt que d'accumuler */
+	if (client->getPendingOutputSize() > MAX_SENDQ_BYTES)
+	{
+		std::cerr << "File d'envoi saturée pour le client " << client->getSocket() << ", déconnexion." << std::endl;
+		client->clearOutput();
+		removeClient(client);
+		return;
+	}
+
+	/**
+	 * Programme l'envoi de fin d'itération. Si le socket est déjà surveillé
+	 * en écriture, la fenêtre TCP est pleine : EV_WRITE prendra le relais.
+	 */
+	if (!client->isFlushScheduled() && !client->isWriteArmed())
+	{
+		client->setFlushScheduled(true);
+		client->getLoop()->pendingFlush.push_back(client);
+	}
+}
+
+/**
+ * Diffuse un message à tous les membres du canal, sauf `except`.
+ * Le message est copié une seule fois ; chaque file d'envoi en retient le bloc.
+ */
+void Server::broadcastToChannel(Channel *channel, const std::string &message, Client *except)
+{
+	broadcastPayload(channel, SharedPayload(message), except);
+}
+
+/**
+ * Diffuse une réponse composée en place, copiée une seule fois pour tous les membres.
+ */
+void Server::broadcastToChannel(Channel *channel, const IrcReply &reply, Client *except)
+{
+	broadcastPayload(channel, SharedPayload(reply.data(), reply.size()), except);
+}
+
+/**
+ * Diffuse un bloc aux membres du canal, sauf `except`. Au-delà de
+ * --fanout-threshold membres, le canal passe aux travailleurs : l'appelant
+ * ne dépose qu'une référence au plan du canal, réparti une fois par
+ * travailleur et par boucle, et la commande suivante n'attend pas la fin
+ * de la diffusion. Redescendu sous la moitié du seuil, le canal revient à
+ * l'envoi direct dès que les boucles ont traité tous les blocs des
+ * travailleurs ; l'écart entre les deux seuils évite d'osciller.
+ * L'auteur de la commande en cours reçoit toujours sa copie en ligne,
+ * avec ses autres réponses : passée par les travailleurs, elle pourrait
+ * arriver après les réponses de ses commandes suivantes. Les appelants
+ * qui donnent `except` y désignent cet auteur.
+ */
+void Server::broadcastPayload(Channel *channel, const SharedPayload &payload, Client *except)
+{
+	size_t members = channel->getClients().size();
+	if (_fanout.workerCount() > 0 && !channel->usesParallelFanout() && members >= _config.fanoutThreshold)
+		channel->enableParallelFanout();
+	else if (channel->usesParallelFanout() && members * 2 < _config.fanoutThreshold)
+		channel->disableParallelFanout();
+
+	if (channel->usesParallelFanout())
+	{
+		if (except == NULL && commandAuthor != NULL && channel->hasClient(commandAuthor))
+		{
+			sendToClient(commandAuthor, payload);
+			except = commandAuthor;
+		}
+
+		/* Les réponses déjà mises de côté par un shard ou le fil d'état partent avant la diffusion */
+		ReplyOutbox *outbox = ReplyOutbox::current();
+		if (outbox != NULL)
+			outbox->flush(_loops);
+
+		_fanout.submit(channel->getFanoutPlan(_fanout), channel->getFanoutDrain(), payload,
+					   except ? except->getSocket() : -1, except ? except->getSerial() : 0);
+		return;
+	}
+
+	const std::vector<Client*> &channelClients = channel->getClients();
+	for (size_t i = 0; i < channelClients.size(); ++i)
+	{
+		if (channelClients[i] != except)
+			sendToClient(channelClients[i], payload);
+	}
+}
+
+/**
+ * Envoie, pour chaque client ayant reçu des réponses pendant l'itération,
+ * toute sa file en un seul appel système.
+ */
+void Server::flushPendingClients(ReactorLoop &loop)
+{
+	for (size_t i = 0; i < loop.pendingFlush.size(); ++i)
+	{
+		Client *client = loop.pendingFlush[i];
+		client->setFlushScheduled(false);
+
+		/* Les clients retirés sont vidés une dernière fois par purgeRemovedClients() */
+		if (!client->isClosing())
+			flushClient(client);
+	}
+	loop.pendingFlush.clear();
+}
+
+/**
+ * Ecrit la file d'envoi du client sur son socket non bloquant,
+ * jusqu'à ce qu'elle soit vide ou que le noyau réponde EAGAIN.
+ * @param client : le client dont la file doit être vidée
+ */
+void Server::flushClient(Client *client)
+{
+	/* Connexion rompue : la file n'a plus de destinataire */
+	if (!writeOutput(client))
+	{
+		client->clearOutput();
+		removeClient(client);
+		return;
+	}
+	updateWriteInterest(client);
+}
+
+/**
+ * Ecrit les blocs en attente avec writev() : plusieurs réponses partent
+ * en un seul appel système, jusqu'à WRITEV_MAX_IOV blocs à la fois.
+ * @param client : le client dont la file doit être écrite
+ * @return false si la connexion est rompue, true sinon (file vide ou EAGAIN)
+ */
+bool Server::writeOutput(Client *client)
+{
+	struct iovec iov[WRITEV_MAX_IOV];
+
+	while (client->hasPendingOutput())
+	{
+		size_t count = client->fillOutputVector(iov, WRITEV_MAX_IOV);
+
+		struct msghdr msg;
+		std::memset(&msg, 0, sizeof(msg));
+		msg.msg_iov = iov;
+		msg.msg_iovlen = count;
+
+		/* sendmsg() est un writev() qui accepte MSG_NOSIGNAL */
+		ssize_t sent = sendmsg(client->getSocket(), &msg, SEND_FLAGS);
+		IoStats::count(client->getLoop()->ioStats.writes);
+		if (sent > 0)
+		{
+			client->consumeOutput(static_cast<size_t>(sent));
+			continue;
+		}
+
+		/* Fenêtre TCP pleine : on attendra que le socket redevienne inscriptible */
+		if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+			return true;
+
+		/* Appel interrompu par un signal : on réessaie */
+		if (sent < 0 && errno == EINTR)
+			continue;
+
+		return false;
+	}
+	return true;
+}
+
+/**
+ * Ajuste l'intérêt en écriture du socket : surveillé tant que la file
+ * d'envoi contient des données, ignoré sinon pour ne pas réveiller la boucle.
+ * @param client : le client concerné
+ */
+void Server::updateWriteInterest(Client *client)
+{
+	bool wantsWrite = client->hasPendingOutput();
+	if (wantsWrite == client->isWriteArmed())
+		return;
+
+	bool reading = !client->isInputClosed() && !client->isParked();
+	int events = (reading ? Reactor::EV_READ : 0) | (wantsWrite ? Reactor::EV_WRITE : 0);
+	if (client->getLoop()->reactor->modify(client->getSocket(), events))
+		client->setWriteArmed(wantsWrite);
+}
+
+/**
+ * Ajuste l'intérêt en lecture du socket : ignoré tant que la lecture est
+ * suspendue derrière les shards, pour qu'un backend à niveau ne réveille
+ * pas la boucle sur des données qu'elle ne lira pas encore.
+ * @param client : le client concerné
+ */
+void Server::updateReadInterest(Client *client)
+{
+	bool reading = !client->isInputClosed() && !client->isParked();
+	int events = (reading ? Reactor::EV_READ : 0) | (client->isWriteArmed() ? Reactor::EV_WRITE : 0);
+	if (!client->getLoop()->reactor->modify(client->getSocket(), events))
+		std::cerr << "Erreur lors de la mise à jour de la lecture du client " << client->getSocket() << std::endl;
+}
+
+std::string Server::getBackgroundColorCode(int socket)
+{
+	/* Génère un code de couleur de fond de 41 à 47 */
+	int colorCode = 41 + (socket % 7);
+	std::stringstream color;
+
+	/* 1 pour le gras, 97 pour le texte en blanc vif */
+	color << "\033[1;97;" << colorCode << "m";
+	return color.str();
+}
+
+void Server::printClientInfo(int newSocket, const std::string& host)
+{
+	std::string colorCode = getBackgroundColorCode(newSocket);
+	std::cout << colorCode
+			  << "\nClient " << newSocket << ", IP " << host
+			  << ". Cmds PASS, NICK et USER pour enregistrer le client."
+			  << "\033[0m\033[K" << std::endl;
+}
+
+/**
+ * Accepte toutes les connexions en attente sur le socket d'écoute.
+ * Le socket d'écoute est non bloquant : on boucle jusqu'à EAGAIN, sinon
+ * epoll (edge-triggered) ne signalerait plus les connexions restantes.
+ */
+void Server::handleNewConnection(ReactorLoop &loop)
+{
+	while (true)
+	{
+        /** 
+         * Attribue un fd unique au nouveau client présenté sur le socket d'écoute de la boucle.
+         */
+		int fdNewClient = accept(loop.listenSocket, NULL, NULL);
+		IoStats::count(loop.ioStats.accepts);
+		if (fdNewClient == FAILURE)
+		{
+			/* Plus aucune connexion en attente */
+			if (errno == EAGAIN || errno == EWOULDBLOCK)
+				return;
+
+			/* Connexion abandonnée par le client ou appel interrompu : on continue */
+			if (errno == EINTR || errno == ECONNABORTED)
+				continue;
+
+			perror("accept");
+			return;
+		}
+		addClient(loop, fdNewClient);
+	}
+}
+
+/**
+ * Crée le Client associé à un socket fraîchement accepté et l'inscrit
+ * dans la boucle d'événements qui l'a accepté.
+ * @param loop : la boucle propriétaire du nouveau client
+ * @param fdNewClient : le descripteur retourné par accept()
+ */
+void Server::addClient(ReactorLoop &loop, int fdNewClient)
+{
 
     /** 
      * Prépare une structure pour stocker l'adresse du client, compatible avec IPv4 et IPv6.
@@ -442,27 +1358,25 @@ void Server::handleNewConnection()
      * Le descripteur fdNewClient permet d'identifier et de gérer les interactions
      * avec ce client spécifique tout au long de la session.
      */
-    /* Allocation sécurisée avec nothrow */
-    Client *newClient = new (std::nothrow) Client(fdNewClient);
+    /* Emplacement pris dans la réserve des clients, NULL si elle est pleine ou la mémoire épuisée */
+    Client *newClient = loop.clientPool.create(fdNewClient);
     if (newClient == NULL)
     {
-        std::cerr << "Échec de l'allocation mémoire pour le nouvel objet Client." << std::endl;
+        if (loop.clientPool.limit() != 0 && loop.clientPool.inUse() >= loop.clientPool.limit())
+        {
+            /* Refus annoncé au client, sans attendre : le socket n'a pas de file d'envoi */
+            IrcReply refusal = IrcMessageBuilder::buildClosingLinkMessage(host, "Server full");
+            send(fdNewClient, refusal.data(), refusal.size(), MSG_DONTWAIT | MSG_NOSIGNAL);
+            std::cerr << "Connexion refusée : " << _config.maxClients << " clients au plus." << std::endl;
+        }
+        else
+            std::cerr << "Échec de l'allocation mémoire pour le nouvel objet Client." << std::endl;
         close(fdNewClient);
         return;
     }
 
-    /** 
-     * Définit une valeur par défaut pour le nom d'hôte, "unknown".
-     * Cette valeur est utilisée si l'adresse IP du client ne peut pas être obtenue.
-     */
-	std::string defaultHost = "unknown";
-
-    /** 
-     * Enregistre l'adresse IP obtenue pour ce client dans _serverIp.
-     * Cela permet au serveur de conserver une référence directe à l'adresse IP
-     * du client connecté, facilitant les vérifications ultérieures.
-     */
-	_serverIp = host;
+	/* Seule cette boucle lira le socket et écrira la file d'envoi du client */
+	newClient->setLoop(&loop);
 
     /** 
      * Vérifie si l'adresse IP (host) du client est valide et non vide.
@@ -476,65 +1390,128 @@ void Server::handleNewConnection()
 		newClient->setHostname(LOCALHOST);
 
 	/* Initialiser l'activité du client */
-	newClient->updateLastActivity();
+	newClient->updateLastActivity(now());
+
+	/**
+	 * Passe le socket en mode non bloquant : ni recv() ni send() ne doivent
+	 * pouvoir suspendre le serveur à cause d'un seul client.
+	 */
+	if (fcntl(fdNewClient, F_SETFL, O_NONBLOCK) == FAILURE)
+	{
+		perror("fcntl");
+		loop.clientPool.destroy(newClient);
+		return;
+	}
+
+	/**
+	 * Inscrit le socket dans la boucle d'événements.
+	 * Echoue notamment avec select() au-delà de FD_SETSIZE descripteurs.
+	 */
+	if (!loop.reactor->add(fdNewClient, Reactor::EV_READ))
+	{
+		std::cerr << "Impossible de surveiller le client " << fdNewClient
+				  << " avec le backend " << loop.reactor->name() << "." << std::endl;
+		loop.clientPool.destroy(newClient);
+		return;
+	}
 
 	/* Ajouter le client à la liste */
-	_clients.push_back(newClient);
+	loop.clients.push_back(newClient);
 
-	/* Ajouter le socket au master set */
-	FD_SET(fdNewClient, &_masterSet);
-	if (fdNewClient > _fdMax)
-		_fdMax = fdNewClient;
+	/* Référencer le client dans la table indexée par fd, lue par cette seule boucle */
+	if (static_cast<size_t>(fdNewClient) >= loop.clientsByFd.size())
+		loop.clientsByFd.resize(fdNewClient + 1, NULL);
+	loop.clientsByFd[fdNewClient] = newClient;
+
+	/* La connexion doit s'enregistrer avant l'échéance */
+	armKeepalive(newClient, REGISTRATION_TIMEOUT);
 
 	printClientInfo(fdNewClient, host);
 }
 
 /**
- * Return the channel object from a message
+ * Return the channel matching `name` under rfc1459 casemapping
  */
-Channel* Server::getChannelFromMessage(const std::string &message)
+Channel* Server::findChannel(const std::string &name)
 {
-	/**
-	 * `iss` for i.nput s.tring s.tream
-	 *
-     * Crée un flux de chaîne pour lire le message mot par mot.
-     * Ce flux permet de séparer la commande (JOIN, PART, etc.)
-     * et le nom du canal.
-     */
-	std::istringstream iss(message);
+	std::string folded = Casemap::fold(name);
+	MutexGuard guard(_channelIndexLock);
+	Channel **found = _channels.find(folded);
+	return found ? *found : NULL;
+}
 
-    /**
-     * Variables pour stocker la commande et le nom du canal extraits
-     * depuis le flux. La commande sera le premier mot, le nom du canal
-     * sera le second mot.
-     */
-	std::string command, channelName;
+/**
+ * Create a channel and index it; the caller holds the lock of its name
+ * @return the new channel, NULL if the pool cannot grow
+ */
+Channel* Server::createChannel(const std::string &name)
+{
+	MutexGuard guard(_channelIndexLock);
+	Channel *channel = _channelPool.create(name);
+	if (channel != NULL)
+		_channels.set(channel->getFoldedName(), channel);
+	return channel;
+}
+
+/**
+ * Unindex and destroy an empty channel; the caller holds the lock of its name
+ */
+void Server::destroyChannel(Channel *channel)
+{
+	MutexGuard guard(_channelIndexLock);
+	_channels.erase(channel->getFoldedName());
+	_channelPool.destroy(channel);
+}
+
+/**
+ * Remove a destroyed client from its channels, each one under the lock of
+ * its owner, and destroy the channels it leaves empty. The names are copied
+ * first: the client's set cannot be walked while the owners change it.
+ */
+void Server::detachFromChannels(Client *client)
+{
+	std::vector<std::pair<Channel*, std::string> > channels;
+	client->copyChannels(channels);
+
+	for (size_t i = 0; i < channels.size(); ++i)
+	{
+		Channel *channel = channels[i].first;
+		MutexGuard guard(channelLockFor(channels[i].second));
+
+		/* Exclu entre-temps par un KICK : le canal a pu être détruit */
+		if (!client->leaveChannel(channel))
+			continue;
+		channel->removeClient(client);
+		if (channel->getClients().empty())
+			destroyChannel(channel);
+	}
+}
 
+/**
+ * Return the channel named by the first parameter of a message
+ */
+Channel* Server::getChannelFromMessage(const IrcMessage &message)
+{
     /**
-     * Lit le premier mot du flux dans `command`, puis le second mot
-     * dans `channelName`. Le message est supposé avoir le format :
-     * "COMMAND #channel_name".
+     * Le nom du canal est le premier paramètre du message, déjà isolé
+     * par l'analyse : "COMMAND #channel_name ...".
      */
-	iss >> command >> channelName;
+	IrcSlice channelName = message.param(0);
+	if (channelName.empty())
+		return NULL;
 
     /**
-     * Vérifie si le canal existe dans la collection `_channels`.
      * Si `channelName` correspond à un canal, retourne un pointeur
      * vers ce canal ; sinon, retourne NULL pour indiquer l'absence.
      */
-	if (_channels.find(channelName) != _channels.end())
-		return _channels[channelName];
-
-    /** 
-     * Retourne NULL si le canal n'existe pas, indiquant que le canal
-     * mentionné dans le message n'est pas répertorié sur le serveur.
-     */
-	return NULL;
+	return findChannel(channelName.str());
 }
 
 /**
  * Gère un message reçu d'un client. Met à jour l'activité du client,
  * lit les données envoyées, traite les messages complets et les passe au bot.
+ * Le socket est lu jusqu'à EAGAIN : avec epoll en edge-triggered, des données
+ * laissées dans le noyau ne seraient plus jamais signalées.
  * @param client : un pointeur vers l'objet Client
  */
 void Server::handleClientMessage(Client *client)
@@ -543,156 +1520,542 @@ void Server::handleClientMessage(Client *client)
      * Met à jour le temps de la dernière activité du client.
      * Cela permet de suivre l'activité et de détecter les clients inactifs.
      */
-	client->updateLastActivity();
+	client->updateLastActivity(now());
 
-    /**
-     * Buffer pour stocker les données reçues du client. La taille est
-     * définie par IRC_BUFFER_SIZE pour éviter l'utilisation de valeurs en dur.
-     */
-	char buffer[IRC_BUFFER_SIZE];
+	/* Toute donnée reçue vaut réponse au PING en attente */
+	if (client->getKeepaliveState() == Client::KEEPALIVE_AWAITING_PONG)
+		client->setKeepaliveState(Client::KEEPALIVE_IDLE);
 
     /**
-     * Reçoit les données du socket client et les stocke dans buffer.
-     * `bytesRead` contient le nombre d'octets lus, ou -1 en cas d'erreur.
+     * Tampon de réception partagé par tous les clients de la boucle : il n'est
+     * utilisé que le temps de traiter les lignes complètes de chaque lecture,
+     * seule la ligne partielle de fin est copiée dans l'anneau du client.
      */
-	int bytesRead = recv(client->getSocket(), buffer, sizeof(buffer) - 1, 0);
-	
-    /**
-     * Vérifie si la connexion a été fermée ou s'il y a eu une erreur.
-     * Si bytesRead est 0, le client a fermé la connexion ; si -1, il y a eu une erreur.
-     */	
-	if (bytesRead <= 0)
-	{
-		if (bytesRead == 0)
-			std::cout << "Le client " << client->getSocket() << " a fermé la connexion.\033[0m" << std::endl;
-		else
-			std::cerr << "Erreur lors de la réception des données du client " << client->getSocket() << std::endl;
+	ReactorLoop &loop = *client->getLoop();
+	char *buffer = &loop.recvBuffer[0];
 
-        /** 
-         * Supprime le client de la liste active car la connexion est fermée ou en erreur.
-         */		
-		removeClient(client);
-	}
-	else
+	/* Octets que ce client peut encore lire avant de laisser la main aux autres */
+	size_t budget = _config.readBudget;
+
+	/**
+	 * Lit jusqu'à EAGAIN, tant que le client n'a pas été retiré (QUIT, erreur...),
+	 * fermé en lecture, ni suspendu derrière ses commandes confiées aux shards.
+	 */
+	while (!client->isClosing() && !client->isInputClosed() && !client->isParked())
 	{
-        /**
-         * Termine la chaîne reçue en ajoutant '\0' pour rendre le buffer utilisable comme chaîne C.
-         * Cela garantit que les données lues dans buffer sont bien formées en tant que chaîne.
-         */
-		buffer[bytesRead] = '\0';
+		/* Budget épuisé : la suite sera lue au prochain tour de boucle */
+		if (budget == 0)
+		{
+			if (!client->isReadPending())
+			{
+				client->setReadPending(true);
+				loop.readBacklog.push_back(client);
+			}
+			return;
+		}
 
         /**
-         * Référence vers le tampon de messages incomplets du client.
-         * Les nouvelles données reçues sont ajoutées pour être traitées plus tard.
+         * Reçoit les données du socket client (non bloquant) et les stocke dans buffer.
+         * `bytesRead` contient le nombre d'octets lus, ou -1 en cas d'erreur.
          */
-		std::string& messageBuffer = client->getMessageBuffer();
-		messageBuffer.append(buffer);
+		size_t wanted = loop.recvBuffer.size() < budget ? loop.recvBuffer.size() : budget;
+		ssize_t bytesRead = recv(client->getSocket(), buffer, wanted, 0);
+		IoStats::count(loop.ioStats.reads);
+
+		/* Le noyau n'a plus de données pour ce client */
+		if (bytesRead < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+			return;
+
+		/* Appel interrompu par un signal : on relit */
+		if (bytesRead < 0 && errno == EINTR)
+			continue;
 
         /**
-         * Boucle pour rechercher des messages complets terminés par '\n' dans messageBuffer.
-         * `find('\n')` retourne la position de '\n' s'il est trouvé, ou `npos` sinon.
-         */
-		std::string::size_type pos;
-		while ((pos = messageBuffer.find('\n')) != std::string::npos)
+         * Vérifie si la connexion a été fermée ou s'il y a eu une erreur.
+         * Si bytesRead est 0, le client a fermé la connexion ; si -1, il y a eu une erreur.
+         */	
+		if (bytesRead <= 0)
 		{
+			if (bytesRead == 0)
+				std::cout << "Le client " << client->getSocket() << " a fermé la connexion.\033[0m" << std::endl;
+			else
+				std::cerr << "Erreur lors de la réception des données du client " << client->getSocket() << std::endl;
+
             /**
-             * Extrait un message complet (jusqu'à '\n') de messageBuffer et le copie dans `message`.
-             * `erase` supprime ce message de messageBuffer, laissant les données restantes.
+             * En mode pipeline, des commandes du client peuvent attendre dans
+             * l'anneau : la fin de flux y est publiée à leur suite, et le fil
+             * d'état retire le client après les avoir exécutées. La boucle
+             * cesse de le lire en attendant.
              */
-			std::string message = messageBuffer.substr(0, pos);
-			messageBuffer.erase(0, pos + 1);
-			
-            /** 
-             * Supprime le caractère '\r' en fin de message, si présent.
-             * Ceci gère les terminators CRLF des messages réseau (IRC utilise "\r\n").
+			if (_pipeline != NULL)
+			{
+				client->setInputClosed(true);
+				if (!loop.reactor->modify(client->getSocket(), client->isWriteArmed() ? Reactor::EV_WRITE : 0))
+					std::cerr << "Erreur lors de la désactivation de la lecture du client " << client->getSocket() << std::endl;
+				submitEventToPipeline(client, CommandRecord::END_OF_STREAM);
+				return;
+			}
+
+            /**
+             * Avec des shards, les commandes qu'il leur a confiées s'exécutent
+             * avant son retrait, comme celles qu'il a envoyées avant : la boucle
+             * cesse de le lire et le retire à la reprise.
              */
-			if (!message.empty() && message[message.size() - 1] == '\r')
-				message.erase(message.size() - 1);
+			client->setInputClosed(true);
+			LineSpan none = { "", 0 };
+			if (parkBehindShards(client, none, "", 0, 0))
+				return;
+
+            /** 
+             * Supprime le client de la liste active car la connexion est fermée ou en erreur.
+             */		
+			removeClient(client);
+			return;
+		}
+		budget -= bytesRead;
+
+		/* Suspendu : la suite du bloc est gardée sur le client, le socket attend la reprise */
+		if (!processInput(client, buffer, static_cast<size_t>(bytesRead)))
+			return;
+	}
+}
+
+/**
+ * Traite chaque ligne complète d'un bloc reçu. Les lignes entièrement
+ * contenues dans le bloc y sont lues en place ; l'anneau du client ne
+ * reçoit que la ligne commencée à la lecture précédente et celle restée
+ * incomplète.
+ * @param client : le client qui a envoyé le bloc
+ * @param data : le bloc reçu
+ * @param length : la longueur du bloc
+ * @return false si la lecture est suspendue derrière les shards
+ */
+bool Server::processInput(Client *client, const char *data, size_t length)
+{
+	ReactorLoop &loop = *client->getLoop();
+	LineFramer &framer = client->getFramer();
+	size_t remaining = length;
+	LineSpan line;
+
+	while (!client->isClosing() && framer.nextLine(data, remaining, line))
+	{
+		/* Mode pipeline : la ligne est analysée dans sa case de l'anneau, le fil d'état l'exécutera */
+		if (_pipeline != NULL)
+		{
+			IoStats::count(loop.ioStats.commands);
+			submitToPipeline(client, line);
+			continue;
+		}
+
+        /**
+         * La ligne n'inclut ni CR ni LF. Elle est analysée une seule fois,
+         * sans copie : gestionnaires et bot lisent la même vue.
+         */
+		IrcMessage message;
+		if (!message.parse(line.data, line.length))
+			continue;
+
+		/* Compte la commande pour le rapport d'appels système (STATS z) */
+		IoStats::count(loop.ioStats.commands);
+
+		/* Commande d'un canal confié à un shard : son thread l'exécutera */
+		if (routeToShard(client, message, line))
+			continue;
+
+		/* Exécutée sur place, après les commandes du client encore confiées aux shards */
+		if (parkBehindShards(client, line, data, remaining, 0))
+			return false;
+
+		/* La commande prend elle-même les verrous des canaux et des pseudonymes qu'elle touche */
+		executeMessage(client, message, _commands.find(message.command()));
+	}
+
+	/* Signale chaque ligne jetée car plus longue que IRC_LINE_MAX, après les réponses des shards */
+	size_t dropped = framer.takeOverflowCount();
+	if (dropped > 0 && !client->isClosing())
+	{
+		LineSpan none = { "", 0 };
+		if (parkBehindShards(client, none, data, 0, dropped))
+			return false;
+	}
+	reportOverflow(client, dropped);
+	return true;
+}
+
+/**
+ * Signale chaque ligne jetée car plus longue que IRC_LINE_MAX. En mode
+ * pipeline, le pseudonyme appartient au fil d'état, qui répond à leur rang.
+ * @param client : le client qui a envoyé les lignes
+ * @param dropped : le nombre de lignes jetées
+ */
+void Server::reportOverflow(Client *client, size_t dropped)
+{
+	for (; dropped > 0; --dropped)
+	{
+		if (_pipeline != NULL)
+		{
+			submitEventToPipeline(client, CommandRecord::LINE_TOO_LONG);
+			continue;
+		}
+
+		const std::string &nick = client->getNickname().empty() ? "*" : client->getNickname();
+		sendToClient(client, IrcMessageBuilder::buildInputTooLongError(_serverName, nick));
+	}
+}
+
+/**
+ * Exécute une commande reçue, puis la passe au bot si elle vise un canal.
+ * Appelée par la boucle du client, un shard ou le fil d'état : une commande
+ * de canal s'exécute sous le verrou de ses canaux, les autres n'en prennent
+ * aucun ici. Sur un shard, son verrou est déjà tenu et la commande ne vise
+ * que ses canaux. Les gestionnaires prennent _nickLock pour résoudre un
+ * pseudonyme.
+ * @param client : le client qui envoie la commande
+ * @param message : la commande analysée
+ * @param entry : l'entrée de la commande dans la table, NULL si elle est inconnue
+ */
+void Server::executeMessage(Client *client, const IrcMessage &message, CommandEntry *entry)
+{
+	/* Les diffusions de la commande, et celles du bot, servent leur auteur en ligne */
+	Client *previousAuthor = commandAuthor;
+	commandAuthor = client;
+
+	/* PING, NICK, PRIVMSG à un pseudonyme... ne touchent à aucun canal */
+	if (!touchesChannels(message, entry))
+		processCommand(client, message, entry);
+	else
+	{
+		bool locking = (currentShard == NULL);
+		if (locking)
+			lockChannels();
+
+	    /**
+	     * Passe le message complet à la fonction de traitement de commandes.
+	     * La fonction `processCommand` gère les commandes IRC envoyées par le client.
+	     */
+		processCommand(client, message, entry);
+
+	    /**
+	     * Passe le message au bot pour modération et traitement automatique.
+	     * `getChannelFromMessage` identifie le canal associé au message, si applicable.
+	     * Si le message correspond à un canal, le bot le modère.
+	     */
+		Channel *channel = getChannelFromMessage(message);
+		if (channel && !client->isClosing())
+			_bot.handleMessage(client, channel, message);
+
+		if (locking)
+			unlockChannels();
+	}
+
+	commandAuthor = previousAuthor;
+}
+
+/**
+ * Indique si une commande lit ou modifie un canal : une commande de canal
+ * dont le paramètre de canal en nomme au moins un, liste comprise.
+ * @param message : la commande analysée
+ * @param entry : l'entrée de la commande dans la table, NULL si elle est inconnue
+ * @return true si la commande doit s'exécuter sous le verrou de ses canaux
+ */
+bool Server::touchesChannels(const IrcMessage &message, const CommandEntry *entry) const
+{
+	if (entry == NULL || !entry->channelScoped || message.paramCount() <= entry->channelParam)
+		return false;
+
+	IrcSlice target = message.param(entry->channelParam);
+	return std::memchr(target.data, '#', target.length) != NULL
+		|| std::memchr(target.data, '&', target.length) != NULL;
+}
+
+/**
+ * Verrouille tous les canaux, pour une commande qu'aucun shard n'exécute
+ * (liste mêlant canaux et pseudonymes, client pas encore enregistré...).
+ * Les verrous des shards sont pris dans l'ordre de leur rang.
+ */
+void Server::lockChannels()
+{
+	if (_shards.empty())
+	{
+		pthread_mutex_lock(&_channelLock);
+		return;
+	}
+	for (size_t i = 0; i < _shards.size(); ++i)
+		pthread_mutex_lock(&_shards[i]->lock);
+}
+
+/**
+ * Rend les verrous pris par lockChannels(), dans l'ordre inverse
+ */
+void Server::unlockChannels()
+{
+	if (_shards.empty())
+	{
+		pthread_mutex_unlock(&_channelLock);
+		return;
+	}
+	for (size_t i = _shards.size(); i > 0; --i)
+		pthread_mutex_unlock(&_shards[i - 1]->lock);
+}
+
+/**
+ * Retourne le verrou d'un canal : celui du shard qui le possède, choisi
+ * par la même empreinte que pushShardTask(), ou _channelLock sans shards.
+ * @param foldedName : le nom replié du canal
+ */
+pthread_mutex_t &Server::channelLockFor(const std::string &foldedName)
+{
+	if (_shards.empty())
+		return _channelLock;
+	return _shards[Casemap::hash(foldedName.data(), foldedName.size()) % _shards.size()]->lock;
+}
+
+/**
+ * Copie une ligne dans la prochaine case de l'anneau du pipeline, l'y
+ * analyse et résout sa commande : la table des commandes n'est que lue,
+ * ce travail reste sur la boucle. Le fil d'état lira la case en place.
+ * Ne doit pas être appelée sous un verrou : l'anneau peut être plein.
+ * @param client : le client qui envoie la ligne
+ * @param line : la ligne reçue, sans CR ni LF
+ */
+void Server::submitToPipeline(Client *client, const LineSpan &line)
+{
+	size_t sequence;
+	CommandRecord &record = _pipeline->claim(sequence);
+
+	record.kind = CommandRecord::COMMAND;
+	record.client = client;
+	record.valid = line.length <= sizeof(record.line);
+	if (record.valid)
+	{
+		std::memcpy(record.line, line.data, line.length);
+		record.valid = record.message.parse(record.line, line.length);
+	}
+	record.entry = record.valid ? _commands.find(record.message.command()) : NULL;
+
+	/* Compté avant d'être visible du fil d'état, comme une commande confiée à un shard */
+	client->addQueuedCommand();
+	_pipeline->publish(sequence);
+}
+
+/**
+ * Publie au fil d'état un événement du client, sans ligne : une ligne jetée
+ * car trop longue, ou la fin de son flux. Il est traité après les commandes
+ * publiées avant lui, à son rang, comme une commande.
+ * @param client : le client concerné
+ * @param kind : CommandRecord::LINE_TOO_LONG ou CommandRecord::END_OF_STREAM
+ */
+void Server::submitEventToPipeline(Client *client, CommandRecord::Kind kind)
+{
+	size_t sequence;
+	CommandRecord &record = _pipeline->claim(sequence);
+
+	record.kind = kind;
+	record.client = client;
+	record.valid = false;
+	record.entry = NULL;
+
+	client->addQueuedCommand();
+	_pipeline->publish(sequence);
+}
+
+/**
+ * Confie au shard du canal visé une commande JOIN, PART, PRIVMSG, MODE,
+ * TOPIC, KICK ou INVITE d'un client enregistré. Le shard est choisi par l'empreinte
+ * du nom replié : toutes les commandes d'un canal passent par la même file,
+ * dans l'ordre de lecture. Un JOIN ou un PART à plusieurs canaux est
+ * découpé en une commande par canal, chacune confiée à son shard ; une
+ * commande visant un pseudonyme s'exécute sur place.
+ * Ne doit pas être appelée sous un verrou : la file peut être pleine.
+ * @param client : le client qui envoie la commande
+ * @param message : la commande analysée
+ * @param line : la ligne reçue, copiée dans la file du shard
+ * @return true si la commande a été confiée à un shard
+ */
+bool Server::routeToShard(Client *client, const IrcMessage &message, const LineSpan &line)
+{
+	if (_shards.empty() || !client->isRegistered())
+		return false;
+
+	CommandEntry *entry = _commands.find(message.command());
+	if (entry == NULL || !entry->channelScoped || message.paramCount() <= entry->channelParam)
+		return false;
+
+	IrcSlice target = message.param(entry->channelParam);
+	if (target.empty() || (target.data[0] != '#' && target.data[0] != '&'))
+		return false;
+
+	if (std::memchr(target.data, ',', target.length) == NULL)
+	{
+		pushShardTask(client, target, std::string(line.data, line.length));
+		return true;
+	}
+	if (!entry->splitTargets)
+		return false;
+
+	/* Chaque élément doit être un canal ; sinon le gestionnaire signale l'erreur sur place */
+	std::vector<std::string> channels = splitArg(target.str(), ',');
+	for (size_t i = 0; i < channels.size(); ++i)
+	{
+		if (channels[i][0] != '#' && channels[i][0] != '&')
+			return false;
+	}
+
+	/* Les clés de JOIN vont avec leur canal ; le second paramètre de PART est conservé tel quel */
+	bool pairedKeys = (entry->handler == &Server::handleJoinCommand);
+	std::vector<std::string> keys;
+	if (pairedKeys && message.paramCount() >= TWO_PARAMS)
+		keys = splitArg(message.param(1).str(), ',');
+
+	std::string command = message.command().str();
+	for (size_t i = 0; i < channels.size(); ++i)
+	{
+		std::string single = command + " " + channels[i];
+		if (pairedKeys && i < keys.size())
+			single += " " + keys[i];
+		else if (!pairedKeys && message.paramCount() >= TWO_PARAMS)
+			single += " :" + message.param(1).str();
+		pushShardTask(client, IrcSlice(channels[i].data(), channels[i].size()), single);
+	}
+	return true;
+}
+
+/**
+ * Confie une ligne au shard propriétaire de `target`. Le client compte
+ * la commande avant qu'elle ne soit visible du shard.
+ * @param client : le client qui envoie la commande
+ * @param target : le nom du canal, tel que reçu
+ * @param line : la ligne à exécuter, sans CR ni LF
+ */
+void Server::pushShardTask(Client *client, const IrcSlice &target, const std::string &line)
+{
+	ShardTask task;
+	task.client = client;
+	task.line = line;
+	client->addQueuedCommand();
+	client->setShardRouted(true);
+	_shards[Casemap::hash(target.data, target.length) % _shards.size()]->push(task);
+}
+
+/**
+ * Point d'ordre des commandes d'un client : une commande exécutée sur place
+ * (QUIT, NICK, INVITE...) ne dépasse ni les commandes confiées aux shards
+ * avant elle, ni leurs réponses. Si les shards ont terminé, la boucle livre
+ * les réponses qu'ils lui ont déposées et la commande s'exécute aussitôt.
+ * Sinon la ligne, la suite du bloc reçu et les lignes trop longues qui la
+ * suivent sont mises de côté sur le client, sa lecture est suspendue, et la
+ * boucle sert ses autres clients : le shard qui exécute la dernière commande
+ * publie la reprise dans la boîte aux lettres, après ses réponses.
+ * @param client : le client dont la boucle exécute la commande
+ * @param line : la ligne à exécuter sur place, vide pour des lignes trop longues seules
+ * @param rest : la suite du bloc reçu, pas encore découpée
+ * @param restLength : la longueur de `rest`
+ * @param overflow : le nombre de lignes trop longues à signaler après la ligne
+ * @return true si la lecture est suspendue
+ */
+bool Server::parkBehindShards(Client *client, const LineSpan &line, const char *rest, size_t restLength, size_t overflow)
+{
+	if (!client->isShardRouted())
+		return false;
+
+	if (!client->awaitQueuedCommands())
+	{
+		deliverMessages(*client->getLoop());
+		client->setShardRouted(false);
+		return false;
+	}
+
+	client->park(std::string(line.data, line.length), rest, restLength, overflow);
+	updateReadInterest(client);
+	return true;
+}
+
+/**
+ * Reprend un client suspendu par parkBehindShards(), une fois les réponses
+ * des shards livrées : exécute sa ligne, signale ses lignes trop longues,
+ * puis découpe la suite du bloc reçu, ou le retire s'il était suspendu sur
+ * sa fin de flux. Les données restées dans le noyau seront lues par
+ * serviceReadBacklog() : avec epoll en edge-triggered, aucun événement ne
+ * les signalerait.
+ * @param client : le client repris
+ */
+void Server::resumeClient(Client *client)
+{
+	std::string line;
+	std::string rest;
+	size_t overflow;
+	client->unpark(line, rest, overflow);
+	client->setShardRouted(false);
+	if (client->isClosing())
+		return;
+	updateReadInterest(client);
+
+	IrcMessage message;
+	if (!line.empty() && message.parse(line.data(), line.size()))
+		executeMessage(client, message, _commands.find(message.command()));
+	reportOverflow(client, overflow);
+
+	if (client->isClosing() || !processInput(client, rest.data(), rest.size()) || client->isClosing())
+		return;
 
-            /**
-             * Passe le message complet à la fonction de traitement de commandes.
-             * La fonction `processCommand` gère les commandes IRC envoyées par le client.
-             */
-			processCommand(client, message);
-			
-            /**
-             * Passe le message au bot pour modération et traitement automatique.
-             * `getChannelFromMessage` identifie le canal associé au message, si applicable.
-             * Si le message correspond à un canal, le bot le modère.
-             */
-			Channel *channel = getChannelFromMessage(message);
-			if (channel)
-				_bot.handleMessage(client, channel, message);
-		}
+	/* Suspendu sur la fin de flux : retiré après ses dernières commandes */
+	if (client->isInputClosed())
+	{
+		removeClient(client);
+		return;
+	}
+
+	ReactorLoop &loop = *client->getLoop();
+	if (!client->isReadPending())
+	{
+		client->setReadPending(true);
+		loop.readBacklog.push_back(client);
 	}
 }
 
 /**
  * Process a Mode command received from a client
  */
-void Server::handleModeCommand(Client *client, const std::vector<std::string> &params)
+void Server::handleModeCommand(Client *client, const IrcMessage &message)
 {
     /**
      * Vérifie si le nombre d'arguments est suffisant pour traiter la commande.
      * Si les arguments sont insuffisants, envoie une erreur 461 (ERR_NEEDMOREPARAMS).
      */
-	if (params.size() < TWO_ARGMNTS)
+	if (message.paramCount() < ONE_PARAM)
 	{
-        std::string error = IrcMessageBuilder::buildNeedMoreParamsError(_serverName, "MODE");
-		send(client->getSocket(), error.c_str(), error.length(), 0);
+        IrcReply error = IrcMessageBuilder::buildNeedMoreParamsError(_serverName, "MODE");
+		sendToClient(client, error);
 		return;
 	}
 
     /**
      * Récupère le nom du canal cible de la commande.
-     * `params[1]` contient le nom du canal.
+     * Le premier paramètre contient le nom du canal.
      */
-	std::string channelName = params[1];
+	std::string channelName = message.param(0).str();
 
     /**
      * Vérifie si le canal spécifié existe dans la liste des canaux.
      * Si le canal n'existe pas, envoie une erreur 403 (ERR_NOSUCHCHANNEL).
      */
-	if (_channels.find(channelName) == _channels.end())
+	Channel *channel = findChannel(channelName);
+	if (channel == NULL)
 	{
-		std::string error = IrcMessageBuilder::buildNoSuchChannelError(_serverName, channelName);
-		send(client->getSocket(), error.c_str(), error.length(), 0);
+		IrcReply error = IrcMessageBuilder::buildNoSuchChannelError(_serverName, channelName);
+		sendToClient(client, error);
 		return;
 	}
 
-    /**
-     * Récupère un pointeur vers le canal existant.
-     * Ce pointeur permet d'accéder aux propriétés et modes du canal.
-     */
-	Channel *channel = _channels[channelName];
-
     /**
      * Si aucun autre paramètre n'est fourni, renvoie les modes actuels du canal.
      * Cette réponse commence par "+", suivi des modes activés (ex: "+itk").
      */
-	if (params.size() == TWO_ARGMNTS)
+	if (message.paramCount() == ONE_PARAM)
 	{
-		std::string modes = "+";
-		std::string modeParams;
-		
-		if (channel->hasMode('i')) modes += "i";
-		if (channel->hasMode('t')) modes += "t";
-		if (channel->hasMode('k'))
-		{
-			modes += "k";
-			modeParams += " " + channel->getKey();
-		}
-		if (channel->hasMode('l'))
-		{
-			modes += "l";
-
-			/* Conversion en chaîne de caractères avec std::ostringstream */
-			std::ostringstream oss;
-			oss << channel->getUserLimit();
-			modeParams += " " + oss.str();
-		}
-		std::string response = IrcMessageBuilder::buildChannelModeIsResponse(_serverName, client->getNickname(), channelName, modes, modeParams);
-		send(client->getSocket(), response.c_str(), response.length(), 0);
+		/* La chaîne des modes est tenue à jour par le canal à chaque changement */
+		IrcReply response = IrcMessageBuilder::buildChannelModeIsResponse(_serverName, client->getNickname(), channelName, channel->getModeString(), channel->getModeParams());
+		sendToClient(client, response);
 		return;
 	}
 
@@ -702,8 +2065,8 @@ void Server::handleModeCommand(Client *client, const std::vector<std::string> &p
      */
 	if (!channel->isOperator(client))
 	{
-		std::string error = IrcMessageBuilder::buildChannelOperatorNeededError(_serverName, client->getNickname(), channelName);
-		send(client->getSocket(), error.c_str(), error.length(), 0);
+		IrcReply error = IrcMessageBuilder::buildChannelOperatorNeededError(_serverName, client->getNickname(), channelName);
+		sendToClient(client, error);
 		return;
 	}
 
@@ -711,10 +2074,10 @@ void Server::handleModeCommand(Client *client, const std::vector<std::string> &p
      * Récupère la chaîne de caractères des modes de la commande.
      * Chaque caractère de cette chaîne représente un mode à ajouter ou supprimer.
      */
-	std::string modeString = params[2];
+	std::string modeString = message.param(1).str();
 
 	/* Index du paramètre à traiter pour certains modes (ex : clé ou limite) */
-	size_t paramIndex = 3;
+	size_t paramIndex = 2;
 
 	/* Indique si les modes doivent être ajoutés (true) ou supprimés (false) */
 	bool adding = true;
@@ -749,13 +2112,13 @@ void Server::handleModeCommand(Client *client, const std::vector<std::string> &p
 		{
 			if (adding)
 			{
-				if (params.size() <= paramIndex)
+				if (message.paramCount() <= paramIndex)
 				{
-        			std::string error = IrcMessageBuilder::buildNeedMoreParamsError(_serverName, "MODE");
-					send(client->getSocket(), error.c_str(), error.length(), 0);
+        			IrcReply error = IrcMessageBuilder::buildNeedMoreParamsError(_serverName, "MODE");
+					sendToClient(client, error);
 					return;
 				}
-				std::string key = params[paramIndex++];
+				std::string key = message.param(paramIndex++).str();
 				channel->setKey(key);
 			}
 			
@@ -768,14 +2131,14 @@ void Server::handleModeCommand(Client *client, const std::vector<std::string> &p
 		{
 			if (adding)
 			{
-				if (params.size() <= paramIndex)
+				if (message.paramCount() <= paramIndex)
 				{
-        			std::string error = IrcMessageBuilder::buildNeedMoreParamsError(_serverName, "MODE");
-					send(client->getSocket(), error.c_str(), error.length(), 0);
+        			IrcReply error = IrcMessageBuilder::buildNeedMoreParamsError(_serverName, "MODE");
+					sendToClient(client, error);
 					return;
 				}
 				
-				int limit = atoi(params[paramIndex++].c_str());
+				int limit = atoi(message.param(paramIndex++).str().c_str());
 				channel->setUserLimit(limit);
 			}
 			
@@ -786,30 +2149,23 @@ void Server::handleModeCommand(Client *client, const std::vector<std::string> &p
 		/* Mode "opérateur de canal" */
 		else if (modeChar == 'o')
 		{
-			if (params.size() <= paramIndex)
+			if (message.paramCount() <= paramIndex)
 			{
-        		std::string error = IrcMessageBuilder::buildNeedMoreParamsError(_serverName, "MODE");
-				send(client->getSocket(), error.c_str(), error.length(), 0);
+        		IrcReply error = IrcMessageBuilder::buildNeedMoreParamsError(_serverName, "MODE");
+				sendToClient(client, error);
 				return;
 			}
 			
-			std::string nick = params[paramIndex++];
-			Client *targetClient = NULL;
-			
-			/* Recherche du client par son pseudonyme dans la liste des clients */
-			for (size_t j = 0; j < _clients.size(); ++j)
-			{
-				if (_clients[j]->getNickname() == nick)
-				{
-					targetClient = _clients[j];
-					break;
-				}
-			}
+			std::string nick = message.param(paramIndex++).str();
+
+			/* Recherche du client par son pseudonyme dans l'index des pseudonymes, qu'il ne quitte pas avant la fin du bloc */
+			MutexGuard nickGuard(_nickLock);
+			Client *targetClient = getClientByNickname(nick);
 			
 			if (!targetClient || !channel->hasClient(targetClient))
 			{
-				std::string error = IrcMessageBuilder::buildUserNotInChannelError(_serverName, client->getNickname(), channelName);
-				send(client->getSocket(), error.c_str(), error.length(), 0);
+				IrcReply error = IrcMessageBuilder::buildUserNotInChannelError(_serverName, client->getNickname(), channelName);
+				sendToClient(client, error);
 				return;
 			}
 			
@@ -822,8 +2178,8 @@ void Server::handleModeCommand(Client *client, const std::vector<std::string> &p
 		
 		else
 		{
-			std::string error = IrcMessageBuilder::buildUnknownModeError(_serverName, client->getNickname(), modeChar);
-			send(client->getSocket(), error.c_str(), error.length(), 0);
+			IrcReply error = IrcMessageBuilder::buildUnknownModeError(_serverName, client->getNickname(), modeChar);
+			sendToClient(client, error);
 			return;
 		}
 	}
@@ -831,71 +2187,62 @@ void Server::handleModeCommand(Client *client, const std::vector<std::string> &p
     /**
      * Envoie une notification aux membres du canal indiquant les changements de mode.
      */
-	std::string modeChangeMsg = IrcMessageBuilder::buildModeChangeMessage(client->getNickname(), channelName, modeString);
-	for (size_t i = 3; i < paramIndex; ++i)
+	std::string modeArguments = modeString;
+	for (size_t i = 2; i < paramIndex; ++i)
 	{
-		modeChangeMsg += " " + params[i];
+		modeArguments += " " + message.param(i).str();
 	}
-	
-	modeChangeMsg += "\r\n";
 
-	const std::vector<Client*> &channelClients = channel->getClients();
-	for (size_t i = 0; i < channelClients.size(); ++i)
-	{
-		send(channelClients[i]->getSocket(), modeChangeMsg.c_str(), modeChangeMsg.length(), 0);
-	}
+	IrcReply modeChangeMsg = IrcMessageBuilder::buildModeChangeMessage(client->getPrefix(), channelName, modeArguments);
+	broadcastToChannel(channel, modeChangeMsg);
 }
 
 /**
  * Gère la commande INVITE permettant à un client d'inviter un autre client
  * dans un canal spécifique, en fonction des permissions et de l'état du canal.
  * @param client : le client qui envoie la commande INVITE
- * @param params : vecteur contenant les arguments de la commande INVITE
+ * @param message : la commande INVITE analysée et ses paramètres
  */
-void Server::handleInviteCommand(Client *client, const std::vector<std::string> &params)
+void Server::handleInviteCommand(Client *client, const IrcMessage &message)
 {
     /**
      * Vérifie si le nombre d'arguments est suffisant pour traiter l'invitation.
      * Si insuffisant, envoie une erreur 461 (ERR_NEEDMOREPARAMS).
      */
-	if (params.size() < THREE_ARGMNTS)
+	if (message.paramCount() < TWO_PARAMS)
 	{
-		std::string error = IrcMessageBuilder::buildNeedMoreParamsError(_serverName, "INVITE");
-		send(client->getSocket(), error.c_str(), error.length(), 0);
+		IrcReply error = IrcMessageBuilder::buildNeedMoreParamsError(_serverName, "INVITE");
+		sendToClient(client, error);
 		return;
 	}
 
     /**
      * Récupère le pseudonyme du client cible et le nom du canal à partir des arguments.
-     * `params[1]` contient le pseudo cible, et `params[2]` le nom du canal.
+     * Le premier paramètre contient le pseudo cible, le second le nom du canal.
      */
-	std::string targetNick = params[1];
-	std::string channelName = params[2];
+	std::string targetNick = message.param(0).str();
+	std::string channelName = message.param(1).str();
 
     /**
      * Vérifie si le canal spécifié existe dans la liste des canaux du serveur.
      * Si le canal n'existe pas, envoie une erreur 403 (ERR_NOSUCHCHANNEL).
      */
-	if (_channels.find(channelName) == _channels.end())
+	Channel *channel = findChannel(channelName);
+	if (channel == NULL)
 	{
-		std::string error = IrcMessageBuilder::buildNoSuchChannelError(_serverName, channelName);
-		send(client->getSocket(), error.c_str(), error.length(), 0);
+		IrcReply error = IrcMessageBuilder::buildNoSuchChannelError(_serverName, channelName);
+		sendToClient(client, error);
 		return;
 	}
 
-    /**
-     * Récupère un pointeur vers le canal existant pour faciliter l'accès à ses propriétés.
-     */
-	Channel *channel = _channels[channelName];
-
     /**
      * Vérifie si le client qui invite est lui-même membre du canal.
      * Si le client n'est pas membre, envoie une erreur 442 (ERR_NOTONCHANNEL).
      */
 	if (!channel->hasClient(client))
 	{
-		std::string error = IrcMessageBuilder::buildNotOnChannelError(_serverName, channelName);
-		send(client->getSocket(), error.c_str(), error.length(), 0);
+		IrcReply error = IrcMessageBuilder::buildNotOnChannelError(_serverName, channelName);
+		sendToClient(client, error);
 		return;
 	}
 
@@ -906,32 +2253,26 @@ void Server::handleInviteCommand(Client *client, const std::vector<std::string>
      */
 	if (channel->hasMode('i') && !channel->isOperator(client))
 	{
-		std::string error = IrcMessageBuilder::buildChannelOperatorNeededError(_serverName, client->getNickname(), channelName);
-		send(client->getSocket(), error.c_str(), error.length(), 0);
+		IrcReply error = IrcMessageBuilder::buildChannelOperatorNeededError(_serverName, client->getNickname(), channelName);
+		sendToClient(client, error);
 		return;
 	}
 
     /**
      * Recherche le client cible par son pseudonyme parmi tous les clients connectés.
      * Si le client cible n'est pas trouvé, envoie une erreur 401 (ERR_NOSUCHNICK).
+     * Il reste dans l'index, donc alloué, jusqu'à la fin de la commande.
      */
-	Client *targetClient = NULL;
-	for (size_t i = 0; i < _clients.size(); ++i)
-	{
-		if (_clients[i]->getNickname() == targetNick)
-		{
-			targetClient = _clients[i];
-			break;
-		}
-	}
+	MutexGuard nickGuard(_nickLock);
+	Client *targetClient = getClientByNickname(targetNick);
 
     /**
      * Si le client cible est introuvable, retourne une erreur.
      */
 	if (!targetClient)
 	{
-		std::string error = IrcMessageBuilder::buildNoSuchNickError(_serverName, targetNick);
-		send(client->getSocket(), error.c_str(), error.length(), 0);
+		IrcReply error = IrcMessageBuilder::buildNoSuchNickError(_serverName, targetNick);
+		sendToClient(client, error);
 		return;
 	}
 
@@ -941,8 +2282,8 @@ void Server::handleInviteCommand(Client *client, const std::vector<std::string>
      */
 	if (channel->hasClient(targetClient))
 	{
-		std::string error = IrcMessageBuilder::buildUserOnChannelError(_serverName, targetNick, channelName);
-		send(client->getSocket(), error.c_str(), error.length(), 0);
+		IrcReply error = IrcMessageBuilder::buildUserOnChannelError(_serverName, targetNick, channelName);
+		sendToClient(client, error);
 		return;
 	}
 
@@ -956,15 +2297,15 @@ void Server::handleInviteCommand(Client *client, const std::vector<std::string>
      * Envoie un message d'invitation au client cible pour l'informer de l'invitation.
      * Le client cible voit un message indiquant qu'il a été invité à rejoindre le canal.
      */
-	std::string inviteMsg = IrcMessageBuilder::buildInviteMessage(client->getNickname(), targetNick, channelName);
-	send(targetClient->getSocket(), inviteMsg.c_str(), inviteMsg.length(), 0);
+	IrcReply inviteMsg = IrcMessageBuilder::buildInviteMessage(client->getPrefix(), targetNick, channelName);
+	sendToClient(targetClient, inviteMsg);
 
     /**
      * Confirme au client qui a envoyé l'invitation que celle-ci a été envoyée avec succès.
      * Le client qui invite voit une réponse 341 confirmant l'envoi de l'invitation.
      */
-	std::string reply = IrcMessageBuilder::buildInvitingReply(_serverName, client->getNickname(), targetNick, channelName);
-	send(client->getSocket(), reply.c_str(), reply.length(), 0);
+	IrcReply reply = IrcMessageBuilder::buildInvitingReply(_serverName, client->getNickname(), targetNick, channelName);
+	sendToClient(client, reply);
 }
 
 /**
@@ -972,51 +2313,47 @@ void Server::handleInviteCommand(Client *client, const std::vector<std::string>
  * La commande permet de définir un nouveau sujet ou de consulter le sujet actuel
  * selon les permissions et le mode de configuration du canal.
  * @param client : le client qui envoie la commande TOPIC
- * @param params : vecteur contenant les arguments de la commande TOPIC
+ * @param message : la commande TOPIC analysée et ses paramètres
  */
-void Server::handleTopicCommand(Client *client, const std::vector<std::string> &params)
+void Server::handleTopicCommand(Client *client, const IrcMessage &message)
 {
     /**
      * Vérifie si le nombre d'arguments est suffisant pour la commande TOPIC.
      * Si insuffisant, envoie une erreur 461 (ERR_NEEDMOREPARAMS).
      */
-	if (params.size() < TWO_ARGMNTS)
+	if (message.paramCount() < ONE_PARAM)
 	{
-		std::string error = IrcMessageBuilder::buildNeedMoreParamsError(_serverName, "TOPIC");
-		send(client->getSocket(), error.c_str(), error.length(), 0);
+		IrcReply error = IrcMessageBuilder::buildNeedMoreParamsError(_serverName, "TOPIC");
+		sendToClient(client, error);
 		return;
 	}
 
     /**
      * Récupère le nom du canal cible de la commande.
-     * `params[1]` contient le nom du canal.
+     * Le premier paramètre contient le nom du canal.
      */
-	std::string channelName = params[1];
+	std::string channelName = message.param(0).str();
 
     /**
      * Vérifie si le canal spécifié existe dans la liste des canaux.
      * Si le canal n'existe pas, envoie une erreur 403 (ERR_NOSUCHCHANNEL).
      */
-	if (_channels.find(channelName) == _channels.end())
+	Channel *channel = findChannel(channelName);
+	if (channel == NULL)
 	{
-		std::string error = IrcMessageBuilder::buildNoSuchChannelError(_serverName, channelName);
-		send(client->getSocket(), error.c_str(), error.length(), 0);
+		IrcReply error = IrcMessageBuilder::buildNoSuchChannelError(_serverName, channelName);
+		sendToClient(client, error);
 		return;
 	}
 
-    /**
-     * Récupère un pointeur vers le canal existant pour faciliter l'accès à ses propriétés.
-     */
-	Channel *channel = _channels[channelName];
-
     /**
      * Vérifie si le client est un membre du canal.
      * Si non, envoie une erreur 442 (ERR_NOTONCHANNEL) indiquant que le client n'est pas dans le canal.
      */
 	if (!channel->hasClient(client))
 	{
-		std::string error = IrcMessageBuilder::buildNotOnChannelError(_serverName, channelName);
-		send(client->getSocket(), error.c_str(), error.length(), 0);
+		IrcReply error = IrcMessageBuilder::buildNotOnChannelError(_serverName, channelName);
+		sendToClient(client, error);
 		
 		return;
 	}
@@ -1026,18 +2363,18 @@ void Server::handleTopicCommand(Client *client, const std::vector<std::string> &
      * Si un sujet est défini, envoie une réponse 332 avec le sujet actuel ;
      * sinon, envoie une réponse 331 indiquant que le canal n'a pas de sujet.
      */
-	if (params.size() == TWO_ARGMNTS)
+	if (message.paramCount() == ONE_PARAM)
 	{
 		if (channel->hasTopic())
 		{
-			std::string response = IrcMessageBuilder::buildTopicReply(_serverName, client->getNickname(), channelName, channel->getTopic());
-			send(client->getSocket(), response.c_str(), response.length(), 0);
+			IrcReply response = IrcMessageBuilder::buildTopicReply(_serverName, client->getNickname(), channelName, channel->getTopic());
+			sendToClient(client, response);
 		}
 		
 		else
 		{
-			std::string response = IrcMessageBuilder::buildNoTopicReply(_serverName, client->getNickname(), channelName);
-			send(client->getSocket(), response.c_str(), response.length(), 0);
+			IrcReply response = IrcMessageBuilder::buildNoTopicReply(_serverName, client->getNickname(), channelName);
+			sendToClient(client, response);
 		}
 		return;
 	}
@@ -1048,22 +2385,16 @@ void Server::handleTopicCommand(Client *client, const std::vector<std::string> &
      */
 	if (channel->hasMode('t') && !channel->isOperator(client))
 	{
-		std::string error = IrcMessageBuilder::buildChannelOperatorNeededError(_serverName, client->getNickname(), channelName);
-		send(client->getSocket(), error.c_str(), error.length(), 0);
+		IrcReply error = IrcMessageBuilder::buildChannelOperatorNeededError(_serverName, client->getNickname(), channelName);
+		sendToClient(client, error);
 		return;
 	}
 
     /**
-     * Construit le nouveau sujet en combinant les paramètres, car le sujet
-     * peut inclure plusieurs mots. Supprime le caractère ':' s'il est présent.
+     * Le nouveau sujet est le second paramètre : en trailing, il peut
+     * contenir plusieurs mots, espaces conservés.
      */
-	std::string topic = params[2];
-	if (topic[0] == ':')
-		topic = topic.substr(1);
-	for (size_t i = 3; i < params.size(); ++i)
-	{
-		topic += " " + params[i];
-	}
+	std::string topic = message.param(1).str();
 
     /**
      * Définit le nouveau sujet du canal avec le texte assemblé.
@@ -1074,80 +2405,64 @@ void Server::handleTopicCommand(Client *client, const std::vector<std::string> &
      * Notifie tous les membres du canal que le sujet a été modifié.
      * Envoie un message indiquant le changement de sujet pour chaque membre.
      */
-	std::string topicMsg = IrcMessageBuilder::buildTopicMessage(client->getNickname(), channelName, topic);
-	const std::vector<Client*> &channelClients = channel->getClients();
-	for (size_t i = 0; i < channelClients.size(); ++i)
-	{
-		send(channelClients[i]->getSocket(), topicMsg.c_str(), topicMsg.length(), 0);
-	}
+	IrcReply topicMsg = IrcMessageBuilder::buildTopicMessage(client->getPrefix(), channelName, topic);
+	broadcastToChannel(channel, topicMsg);
 }
 
 /**
  * Gère la commande KICK pour expulser un membre d'un canal.
  * Un opérateur de canal peut utiliser cette commande pour retirer un membre spécifique du canal.
  * @param client : le client qui envoie la commande KICK
- * @param params : vecteur contenant les arguments de la commande KICK
+ * @param message : la commande KICK analysée et ses paramètres
  */
-void Server::handleKickCommand(Client *client, const std::vector<std::string> &params)
+void Server::handleKickCommand(Client *client, const IrcMessage &message)
 {
     /**
      * Vérifie si le nombre d'arguments est suffisant pour la commande KICK.
      * Si insuffisant, envoie une erreur 461 (ERR_NEEDMOREPARAMS).
      */
-	if (params.size() < THREE_ARGMNTS)
+	if (message.paramCount() < TWO_PARAMS)
 	{
-		std::string error = IrcMessageBuilder::buildNeedMoreParamsError(_serverName, "KICK");
-		send(client->getSocket(), error.c_str(), error.length(), 0);
+		IrcReply error = IrcMessageBuilder::buildNeedMoreParamsError(_serverName, "KICK");
+		sendToClient(client, error);
 		return;
 	}
 
     /**
      * Récupère le nom du canal cible et le pseudonyme du client à expulser.
-     * `params[1]` contient le nom du canal et `params[2]` le pseudonyme de la cible.
+     * Le premier paramètre contient le nom du canal, le second le pseudonyme de la cible.
      */
-	std::string channelName = params[1];
-	std::string targetNick = params[2];
+	std::string channelName = message.param(0).str();
+	std::string targetNick = message.param(1).str();
 
     /**
      * Construit le commentaire pour l'expulsion si fourni. 
      * Par défaut, le commentaire contient le pseudonyme de l'expéditeur.
      */
 	std::string comment = client->getNickname();
-	if (params.size() >= 4)
-	{
-		comment = params[3];
-		if (comment[0] == ':')
-			comment = comment.substr(1);
-		for (size_t i = 4; i < params.size(); ++i)
-		{
-			comment += " " + params[i];
-		}
-	}
+	if (message.paramCount() >= THREE_PARAMS)
+		comment = message.param(2).str();
 
     /**
      * Vérifie si le canal spécifié existe dans la liste des canaux.
      * Si le canal n'existe pas, envoie une erreur 403 (ERR_NOSUCHCHANNEL).
      */
-	if (_channels.find(channelName) == _channels.end())
+	Channel *channel = findChannel(channelName);
+	if (channel == NULL)
 	{
-		std::string error = IrcMessageBuilder::buildNoSuchChannelError(_serverName, channelName);
-		send(client->getSocket(), error.c_str(), error.length(), 0);
+		IrcReply error = IrcMessageBuilder::buildNoSuchChannelError(_serverName, channelName);
+		sendToClient(client, error);
 		return;
 	}
 
-    /**
-     * Récupère un pointeur vers le canal pour faciliter l'accès à ses propriétés.
-     */
-	Channel *channel = _channels[channelName];
-
     /**
      * Vérifie si le client qui envoie la commande est membre du canal.
      * Si le client n'est pas dans le canal, envoie une erreur 442 (ERR_NOTONCHANNEL).
      */
 	if (!channel->hasClient(client))
 	{
-		std::string error = IrcMessageBuilder::buildNotOnChannelError(_serverName, channelName);
-		send(client->getSocket(), error.c_str(), error.length(), 0);
+		IrcReply error = IrcMessageBuilder::buildNotOnChannelError(_serverName, channelName);
+		sendToClient(client, error);
 		return;
 	}
 
@@ -1158,32 +2473,26 @@ void Server::handleKickCommand(Client *client, const std::vector<std::string> &p
      */
 	if (!channel->isOperator(client))
 	{
-		std::string error = IrcMessageBuilder::buildChannelOperatorNeededError(_serverName, client->getNickname(), channelName);
-		send(client->getSocket(), error.c_str(), error.length(), 0);
+		IrcReply error = IrcMessageBuilder::buildChannelOperatorNeededError(_serverName, client->getNickname(), channelName);
+		sendToClient(client, error);
 		return;
 	}
 
     /**
      * Recherche le client cible par son pseudonyme parmi les clients connectés.
      * Si le client cible n'est pas trouvé, envoie une erreur 401 (ERR_NOSUCHNICK).
+     * Il reste dans l'index, donc alloué, jusqu'à la fin de la commande.
      */
-	Client *targetClient = NULL;
-	for (size_t i = 0; i < _clients.size(); ++i)
-	{
-		if (_clients[i]->getNickname() == targetNick)
-		{
-			targetClient = _clients[i];
-			break;
-		}
-	}
+	MutexGuard nickGuard(_nickLock);
+	Client *targetClient = getClientByNickname(targetNick);
 
     /**
      * Si le client cible est introuvable, retourne une erreur.
      */
 	if (!targetClient)
 	{
-		std::string error = IrcMessageBuilder::buildNoSuchNickError(_serverName, targetNick);
-		send(client->getSocket(), error.c_str(), error.length(), 0);
+		IrcReply error = IrcMessageBuilder::buildNoSuchNickError(_serverName, targetNick);
+		sendToClient(client, error);
 		return;
 	}
 
@@ -1193,8 +2502,8 @@ void Server::handleKickCommand(Client *client, const std::vector<std::string> &p
      */
 	if (!channel->hasClient(targetClient))
 	{
-		std::string error = IrcMessageBuilder::buildUserNotInChannelError(_serverName, client->getNickname(), channelName);
-		send(client->getSocket(), error.c_str(), error.length(), 0);
+		IrcReply error = IrcMessageBuilder::buildUserNotInChannelError(_serverName, client->getNickname(), channelName);
+		sendToClient(client, error);
 		return;
 	}
 
@@ -1202,12 +2511,8 @@ void Server::handleKickCommand(Client *client, const std::vector<std::string> &p
      * Notifie tous les membres du canal que le client cible est expulsé,
      * en envoyant un message indiquant l'auteur de l'expulsion et la raison.
      */
-	std::string kickMsg = IrcMessageBuilder::buildKickMessage(client->getNickname(), channelName, targetNick, comment);
-	const std::vector<Client*> &channelClients = channel->getClients();
-	for (size_t i = 0; i < channelClients.size(); ++i)
-	{
-		send(channelClients[i]->getSocket(), kickMsg.c_str(), kickMsg.length(), 0);
-	}
+	IrcReply kickMsg = IrcMessageBuilder::buildKickMessage(client->getPrefix(), channelName, targetNick, comment);
+	broadcastToChannel(channel, kickMsg);
 
     /**
      * Retire le client cible du canal et met à jour son état pour refléter son départ.
@@ -1219,10 +2524,7 @@ void Server::handleKickCommand(Client *client, const std::vector<std::string> &p
      * Si le canal devient vide après l'expulsion, il est automatiquement supprimé du serveur.
      */
 	if (channel->getClients().empty())
-	{
-		_channels.erase(channelName);
-		delete channel;
-	}
+		destroyChannel(channel);
 }
 
 /**
@@ -1230,29 +2532,29 @@ void Server::handleKickCommand(Client *client, const std::vector<std::string> &p
  * des fonctionnalités supplémentaires (capacités) avec le serveur IRC.
  * Cette fonction vérifie les sous-commandes et répond en fonction des capacités supportées.
  * @param client : le client qui envoie la commande CAP
- * @param params : vecteur contenant les arguments de la commande CAP
+ * @param message : la commande CAP analysée et ses paramètres
  */
-void Server::handleCapCommand(Client *client, const std::vector<std::string> &params)
+void Server::handleCapCommand(Client *client, const IrcMessage &message)
 {
     /**
      * Vérifie si le nombre d'arguments est suffisant pour traiter la commande CAP.
      * Si insuffisant, envoie une erreur 461 (ERR_NEEDMOREPARAMS) indiquant le manque d'arguments.
      */
-	if (params.size() < TWO_ARGMNTS)
+	if (message.paramCount() < ONE_PARAM)
 	{
 		/* Si le client est enregistré, utilise son pseudonyme ; sinon, utilise "*" */
 		std::string nick = client->isRegistered() ? client->getNickname() : "*";
-		std::string error = IrcMessageBuilder::buildNeedMoreParamsError(_serverName, "CAP");
+		IrcReply error = IrcMessageBuilder::buildNeedMoreParamsError(_serverName, "CAP");
 		
-		send(client->getSocket(), error.c_str(), error.length(), 0);
+		sendToClient(client, error);
 		return;
 	}
 
     /**
      * Récupère la sous-commande CAP fournie dans les arguments.
-     * `params[1]` contient la sous-commande de la commande CAP, comme "LS" ou "END".
+     * Le premier paramètre contient la sous-commande de la commande CAP, comme "LS" ou "END".
      */
-	std::string subCommand = params[1];
+	std::string subCommand = message.param(0).str();
 
     /**
      * Traite la sous-commande "LS" qui liste les capacités supportées par le serveur.
@@ -1267,7 +2569,7 @@ void Server::handleCapCommand(Client *client, const std::vector<std::string> &pa
          * Gère les capacités multi-lignes si le client le demande (version 302),
          * permettant d'envoyer de longues listes de capacités en plusieurs messages.
          */
-		if (params.size() >= 3 && params[2] == "302")
+		if (message.param(1).equals("302"))
 		{
 			/* Gérer les capacités multi-lignes si nécessaire */
 		}
@@ -1276,8 +2578,8 @@ void Server::handleCapCommand(Client *client, const std::vector<std::string> &pa
 		std::string nick = client->isRegistered() ? client->getNickname() : "*";
 
 		/* Forme et envoie la réponse avec la liste des capacités supportées (ici vide) */
-		std::string response = IrcMessageBuilder::buildCapabilityListMessage(_serverName, nick, capabilities);
-		send(client->getSocket(), response.c_str(), response.length(), 0);
+		IrcReply response = IrcMessageBuilder::buildCapabilityListMessage(_serverName, nick, capabilities);
+		sendToClient(client, response);
 	}
 
     /**
@@ -1297,19 +2599,153 @@ void Server::handleCapCommand(Client *client, const std::vector<std::string> &pa
 	{
 		/* Utilise le pseudonyme enregistré ou "*" pour identifier le client dans l'erreur */
 		std::string nick = client->isRegistered() ? client->getNickname() : "*";
-		std::string error = IrcMessageBuilder::buildInvalidCapSubcommandError(_serverName, nick, subCommand);
-		send(client->getSocket(), error.c_str(), error.length(), 0);
+		IrcReply error = IrcMessageBuilder::buildInvalidCapSubcommandError(_serverName, nick, subCommand);
+		sendToClient(client, error);
+	}
+}
+
+/**
+ * Gère la commande STATS. La lettre `m` rapporte le nombre d'appels de
+ * chaque commande. La lettre `z` rapporte les compteurs d'appels
+ * système de la boucle d'événements et leur moyenne par commande traitée,
+ * ce qui permet de mesurer l'effet du regroupement des réponses, ainsi que
+ * l'occupation des réserves de clients et de canaux.
+ * @param client : le client qui envoie la commande STATS
+ * @param message : la commande analysée, la lettre demandée en premier paramètre
+ */
+void Server::handleStatsCommand(Client *client, const IrcMessage &message)
+{
+	std::string letter = message.paramCount() >= ONE_PARAM ? message.param(0).str().substr(0, 1) : "*";
+
+	/* Nombre d'appels de chaque commande, relevé dans la table de dispatch */
+	if (letter == "m")
+	{
+		for (size_t i = 0; i < _commands.count(); ++i)
+		{
+			const CommandEntry &entry = _commands.entry(i);
+			sendToClient(client, IrcMessageBuilder::buildStatsCommandsReply(_serverName, client->getNickname(), entry.name, entry.hits));
+		}
+	}
+
+	else if (letter == "z")
+	{
+		/* Compteurs cumulés sur toutes les boucles d'événements */
+		IoStats stats;
+		size_t clientsInUse = 0;
+		size_t clientsHigh = 0;
+		size_t clientSlots = 0;
+		for (size_t i = 0; i < _loops.size(); ++i)
+		{
+			/* Les autres boucles incrémentent leurs compteurs pendant cette lecture */
+			IoStats &counters = _loops[i]->ioStats;
+			stats.waits += IoStats::load(counters.waits);
+			stats.accepts += IoStats::load(counters.accepts);
+			stats.reads += IoStats::load(counters.reads);
+			stats.writes += IoStats::load(counters.writes);
+			stats.commands += IoStats::load(counters.commands);
+			clientsInUse += IoStats::load(counters.clients);
+			clientsHigh += IoStats::load(counters.clientsHigh);
+			clientSlots += IoStats::load(counters.clientSlots);
+		}
+		unsigned long syscalls = stats.waits + stats.accepts + stats.reads + stats.writes;
+
+		std::ostringstream counters;
+		counters << "syscalls wait=" << stats.waits << " accept=" << stats.accepts
+				 << " recv=" << stats.reads << " writev=" << stats.writes
+				 << " reactors=" << _loops.size() << " shards=" << _shards.size()
+				 << " pipeline=" << (_pipeline != NULL ? "on" : "off");
+		sendToClient(client, IrcMessageBuilder::buildStatsDebugReply(_serverName, client->getNickname(), counters.str()));
+
+		std::ostringstream ratio;
+		ratio.setf(std::ios::fixed);
+		ratio.precision(2);
+		ratio << "commands=" << stats.commands << " syscalls/command="
+			  << (stats.commands ? static_cast<double>(syscalls) / stats.commands : 0.0);
+		sendToClient(client, IrcMessageBuilder::buildStatsDebugReply(_serverName, client->getNickname(), ratio.str()));
+
+		/* Occupation des réserves d'objets : vivants, plus haut niveau atteint, emplacements alloués */
+		std::ostringstream pools;
+		pools << "pool clients=" << clientsInUse << " high=" << clientsHigh
+			  << " slots=" << clientSlots << " limit=" << _config.maxClients;
+		{
+			MutexGuard indexGuard(_channelIndexLock);
+			pools << " channels=" << _channelPool.inUse() << " high=" << _channelPool.highWater()
+				  << " slots=" << _channelPool.capacity();
+		}
+		sendToClient(client, IrcMessageBuilder::buildStatsDebugReply(_serverName, client->getNickname(), pools.str()));
+
+		/* Diffusions confiées aux travailleurs, blocs déposés et latence du dépôt au dernier bloc */
+		std::ostringstream fanout;
+		fanout << "fanout workers=" << _fanout.workerCount() << " threshold=" << _config.fanoutThreshold
+			   << " batches=" << _fanout.batches() << " deliveries=" << _fanout.deliveries()
+			   << " p50_us=" << _fanout.latencyPercentile(50) << " p99_us=" << _fanout.latencyPercentile(99);
+		sendToClient(client, IrcMessageBuilder::buildStatsDebugReply(_serverName, client->getNickname(), fanout.str()));
+	}
+
+	sendToClient(client, IrcMessageBuilder::buildEndOfStatsReply(_serverName, client->getNickname(), letter));
+}
+
+/**
+ * Gère la commande OPER <nom> <mot de passe>. Le nom n'est pas vérifié :
+ * le mot de passe passé par --oper-password suffit à devenir opérateur IRC.
+ * @param client : le client qui envoie la commande OPER
+ * @param message : la commande analysée
+ */
+void Server::handleOperCommand(Client *client, const IrcMessage &message)
+{
+	if (message.paramCount() < TWO_PARAMS)
+	{
+		sendToClient(client, IrcMessageBuilder::buildNeedMoreParamsError(_serverName, "OPER"));
+		return;
+	}
+
+	/* Sans mot de passe configuré, personne ne peut devenir opérateur */
+	if (_config.operPassword.empty())
+	{
+		sendToClient(client, IrcMessageBuilder::buildNoOperHostError(_serverName, client->getNickname()));
+		return;
+	}
+
+	if (!message.param(1).equals(_config.operPassword))
+	{
+		sendToClient(client, IrcMessageBuilder::buildPasswordMismatchError(_serverName));
+		return;
+	}
+
+	client->setOperator(true);
+	sendToClient(client, IrcMessageBuilder::buildYoureOperReply(_serverName, client->getNickname()));
+}
+
+/**
+ * Gère la commande REHASH : recharge les règles du bot et le MOTD comme SIGHUP.
+ * La compilation se fait hors de la boucle d'événements ; les nouvelles
+ * règles s'appliquent dès qu'elles sont prêtes.
+ * @param client : l'opérateur qui envoie la commande REHASH
+ * @param message : la commande analysée, sans paramètre
+ */
+void Server::handleRehashCommand(Client *client, const IrcMessage &message)
+{
+	(void)message;
+
+	if (!client->isOperator())
+	{
+		sendToClient(client, IrcMessageBuilder::buildNoPrivilegesError(_serverName, client->getNickname()));
+		return;
 	}
+
+	const std::string &path = _bot.getRulesPath();
+	sendToClient(client, IrcMessageBuilder::buildRehashingReply(_serverName, client->getNickname(), path.empty() ? "*" : path));
+	rehash();
 }
 
 /**
- * Envoie un message à un client via le descripteur de fichier donné, avec une limite de longueur.
+ * Envoie un message à un client, avec une limite de longueur.
  * Tronque les messages trop longs et ajoute une terminaison CRLF (Carriage Return Line Feed) avant envoi.
  * @param message : le message à envoyer
- * @param sender_fd : le descripteur de fichier du client destinataire
- * @return bool : retourne true si le message a été envoyé
+ * @param client : le client destinataire
+ * @return bool : retourne true si le message a été placé dans la file d'envoi
  */
-bool Server::send_message(const std::string &message, int sender_fd)
+bool Server::send_message(const std::string &message, Client *client)
 {
     /**
      * Crée une copie temporaire du message pour ajuster sa longueur si nécessaire.
@@ -1326,10 +2762,9 @@ bool Server::send_message(const std::string &message, int sender_fd)
 		tmp = tmp.substr(0, 510) + "\r\n";
 
     /**
-     * Envoie le message (ou sa version tronquée) au client via le descripteur de fichier `sender_fd`.
-     * La valeur 0 indique l'envoi sans options supplémentaires (voir `send()` pour plus de détails).
+     * Place le message (ou sa version tronquée) dans la file d'envoi du client.
      */
-	send(sender_fd, tmp.c_str(), tmp.size(), 0);
+	sendToClient(client, tmp);
 
     /**
      * Affiche une confirmation dans la console du serveur pour indiquer que le message a été envoyé,
@@ -1351,16 +2786,23 @@ std::string Server::formatPingPongMessage(const std::string& client_id, const st
 /**
  * Gère la commande PING/PONG pour vérifier ou répondre à la disponibilité d'un client.
  */
-bool Server::handlePingPongCommand(Client* client, const std::string& args)
+void Server::handlePingPongCommand(Client* client, const IrcMessage &message)
 {
-    /* Création de l'ID client */
-    std::string client_id = client->getNickname() + "!" + client->getUsername() + "@" + _serverIp;
+    /* Un PONG répond au PING du serveur : l'activité est déjà notée, rien à renvoyer */
+    if (message.command().iequals("PONG"))
+    {
+        client->setLastPongTime(now());
+        return;
+    }
+
+    /* Identifiant du client : son préfixe, sans le ':' initial */
+    std::string client_id = client->getPrefix().substr(1);
 
     /* Détermination de la commande (PING ou PONG) */
     std::string command = client->isRegistered() ? "PONG" : "PING";
 
-    /* Paramètre à envoyer (utilise args si non vide) */
-    std::string param = args.empty() ? "" : args;
+    /* Paramètre à renvoyer : le premier paramètre reçu, vide s'il est absent */
+    std::string param = message.param(0).str();
 
     /* Formattage du message */
     std::string response = formatPingPongMessage(client_id, command, param);
@@ -1369,14 +2811,39 @@ bool Server::handlePingPongCommand(Client* client, const std::string& args)
      * Envoie le message PING ou PONG construit au client via `send_message`.
      * La réponse varie selon que le client est en cours d'enregistrement ou déjà enregistré.
      */
-    send_message(response, client->getSocket());
+    send_message(response, client);
+}
+
+/**
+ * Gère la commande QUIT : le client est retiré du serveur.
+ */
+void Server::handleQuitCommand(Client *client, const IrcMessage &message)
+{
+	(void)message;
+	removeClient(client);
+}
+
+/**
+ * Retire le pseudonyme du client de l'index, s'il lui appartient encore.
+ * @param client : le client dont le pseudonyme est libéré
+ */
+void Server::unindexNickname(Client *client)
+{
+	/* Le fil d'état peut changer ce pseudonyme pendant que la boucle retire le client */
+	MutexGuard guard(_nickLock);
+	if (client->getNickname().empty())
+		return;
 
-	/* Retourne true pour indiquer que le message a bien été envoyé */
-    return true;
+	Client **owner = _nicknames.find(client->getFoldedNickname());
+	if (owner && *owner == client)
+		_nicknames.erase(client->getFoldedNickname());
 }
 
 /**
  * Recherche et retourne un client en fonction de son pseudonyme (nickname).
+ * L'appelant tient _nickLock : un client retiré quitte l'index sous ce
+ * verrou avant d'être détruit, le pointeur reste donc valide jusqu'à ce
+ * qu'il le rende.
  * @param nickname : le pseudonyme du client à rechercher
  * @return Client* : pointeur vers l'objet Client correspondant au pseudonyme donné,
  *                   ou NULL si aucun client n'est trouvé.
@@ -1384,96 +2851,55 @@ bool Server::handlePingPongCommand(Client* client, const std::string& args)
 Client* Server::getClientByNickname(const std::string &nickname)
 {
     /**
-     * Parcourt la liste des clients connectés (_clients) pour trouver une correspondance.
-     * `_clients` est un vecteur contenant les pointeurs vers tous les objets Client actifs.
+     * Cherche le pseudonyme replié (rfc1459) dans l'index `_nicknames`, tenu à jour par NICK
+     * et par le retrait des clients : coût constant en moyenne, quel que soit
+     * le nombre de clients connectés.
      */
-	for (size_t i = 0; i < _clients.size(); ++i)
-	{
-        /**
-         * Vérifie si le pseudonyme du client courant correspond au pseudonyme recherché.
-         * Utilise la fonction `getNickname()` de l'objet Client pour accéder à son pseudonyme.
-         */
-		if (_clients[i]->getNickname() == nickname)
-			return _clients[i];
-	}
-	
+	Client **found = _nicknames.find(Casemap::fold(nickname));
+
     /**
      * Si aucun client n'est trouvé avec le pseudonyme donné, retourne NULL.
      * Cela signifie que le pseudonyme recherché n'est pas actuellement utilisé par un client actif.
      */
-	return NULL;
+	return found ? *found : NULL;
 }
 
 /**
  * Traite une commande envoyée par un client, en fonction du message reçu.
  * Cette fonction interprète et route les commandes IRC standard (JOIN, NICK, PRIVMSG, etc.) vers les gestionnaires correspondants.
+ * L'entrée de la table est cherchée par l'appelant : une empreinte calculée
+ * sur la ligne reçue, sans copie ni conversion en majuscules.
  * @param client : le client qui envoie la commande
  * @param message : le message contenant la commande et ses arguments
+ * @param entry : l'entrée de la commande, NULL si elle est inconnue
  */
-void Server::processCommand(Client *client, const std::string &message)
+void Server::processCommand(Client *client, const IrcMessage &message, CommandEntry *entry)
 {
     /**
-     * Découpe le message en mots, séparant la commande des paramètres.
-     * `split` retourne un vecteur (`tokens`) contenant la commande et ses arguments.
-     */
-	std::vector<std::string> tokens = split(message, " ");
-
-	/* Si le message est vide, arrête le traitement */
-	if (tokens.empty())
-		return;
-
-    /**
-     * La première partie du message est la commande, en majuscules pour simplifier la comparaison.
-     * Cela permet de traiter les commandes sans tenir compte de la casse.
+     * Si la commande n'est pas reconnue, envoie une erreur 421 indiquant une commande inconnue.
      */
-	std::string command = tokens[0];
-	std::transform(command.begin(), command.end(), command.begin(), ::toupper);
-
-	if (command == "CAP")
-		handleCapCommand(client, tokens);
-	else if (command == "PASS")
-		handlePassCommand(client, tokens);
-	else if (command == "NICK")
-		handleNickCommand(client, tokens);
-	else if (command == "QUIT")
-		removeClient(client);
-	else if (command == "USER")
-		handleUserCommand(client, tokens);
-	else if (command == "PING")
-		handlePingPongCommand(client, tokens.size() > 1 ? tokens[1] : "");
-	else if (command == "PONG")
-		handlePingPongCommand(client, tokens.size() > 1 ? tokens[1] : "");
+	if (entry == NULL && client->isRegistered())
+	{
+		std::string name = message.command().str();
+		std::transform(name.begin(), name.end(), name.begin(), ::toupper);
+		IrcReply error = IrcMessageBuilder::buildUnknownCommandError(_serverName, name);
+		sendToClient(client, error);
+	}
 
     /**
      * Si le client n'est pas encore enregistré et tente une autre commande, envoie une erreur 451.
      */
-	else if (!client->isRegistered())
+	else if (entry == NULL || (entry->needsRegistration && !client->isRegistered()))
 	{
-		std::string error = IrcMessageBuilder::buildNotRegisteredError(_serverName);
-		send(client->getSocket(), error.c_str(), error.length(), 0);
+		IrcReply error = IrcMessageBuilder::buildNotRegisteredError(_serverName);
+		sendToClient(client, error);
 	}
-	else if (command == "JOIN")
-		handleJoinCommand(client, tokens);
-	else if (command == "PART")
-		handlePartCommand(client, tokens);
-	else if (command == "PRIVMSG")
-		handlePrivmsgCommand(client, tokens);
-	else if (command == "MODE")
-		handleModeCommand(client, tokens);
-	else if (command == "INVITE")
-		handleInviteCommand(client, tokens);
-	else if (command == "TOPIC")
-		handleTopicCommand(client, tokens);
-	else if (command == "KICK")
-		handleKickCommand(client, tokens);
 
-    /**
-     * Si la commande n'est pas reconnue, envoie une erreur 421 indiquant une commande inconnue.
-     */
+	/* Appelle le gestionnaire de la commande */
 	else
 	{
-		std::string error = IrcMessageBuilder::buildUnknownCommandError(_serverName, command);
-		send(client->getSocket(), error.c_str(), error.length(), 0);
+		IoStats::count(entry->hits);
+		(this->*entry->handler)(client, message);
 	}
 
     /**
@@ -1483,6 +2909,33 @@ void Server::processCommand(Client *client, const std::string &message)
 	registerClient(client);
 }
 
+/**
+ * Enregistre les commandes supportées dans la table de dispatch.
+ * Les commandes d'enregistrement sont accessibles avant l'authentification,
+ * les autres exigent un client enregistré. Les commandes de canal sont
+ * exécutées par le shard du canal quand --shards est donné.
+ */
+void Server::registerCommands()
+{
+	_commands.add("CAP", false, &Server::handleCapCommand);
+	_commands.add("PASS", false, &Server::handlePassCommand);
+	_commands.add("NICK", false, &Server::handleNickCommand);
+	_commands.add("USER", false, &Server::handleUserCommand);
+	_commands.add("QUIT", false, &Server::handleQuitCommand);
+	_commands.add("PING", false, &Server::handlePingPongCommand);
+	_commands.add("PONG", false, &Server::handlePingPongCommand);
+	_commands.add("JOIN", true, &Server::handleJoinCommand, true, true);
+	_commands.add("PART", true, &Server::handlePartCommand, true, true);
+	_commands.add("PRIVMSG", true, &Server::handlePrivmsgCommand, true);
+	_commands.add("MODE", true, &Server::handleModeCommand, true);
+	_commands.add("INVITE", true, &Server::handleInviteCommand, true, false, 1);
+	_commands.add("TOPIC", true, &Server::handleTopicCommand, true);
+	_commands.add("KICK", true, &Server::handleKickCommand, true);
+	_commands.add("STATS", true, &Server::handleStatsCommand);
+	_commands.add("OPER", true, &Server::handleOperCommand);
+	_commands.add("REHASH", true, &Server::handleRehashCommand);
+}
+
 /**
  * Vérifie si un client remplit toutes les conditions pour être enregistré sur le serveur IRC.
  * Si les conditions sont remplies, marque le client comme enregistré et envoie le message du jour (MOTD).
@@ -1503,7 +2956,11 @@ void Server::registerClient(Client *client)
          * Marque le client comme enregistré en définissant son état interne à "registered".
          * Cela permet au serveur de traiter ses commandes IRC au-delà de l'authentification.
          */
-		client->setRegistered(true);
+		{
+			/* NICK lit l'état des autres clients sous ce verrou */
+			MutexGuard guard(_nickLock);
+			client->setRegistered(true);
+		}
 
         /**
          * Envoie le Message Of The Day (MOTD) au client enregistré, contenant des informations
@@ -1518,9 +2975,9 @@ void Server::registerClient(Client *client)
  * Valide le mot de passe fourni, envoie des erreurs appropriées en cas d'échec,
  * et marque le client comme ayant envoyé un mot de passe valide.
  * @param client : le client qui envoie la commande PASS
- * @param params : vecteur contenant la commande et ses paramètres
+ * @param message : la commande analysée et ses paramètres
  */
-void Server::handlePassCommand(Client *client, const std::vector<std::string> &params)
+void Server::handlePassCommand(Client *client, const IrcMessage &message)
 {
     /**
      * Vérifie si le client a déjà envoyé un mot de passe valide.
@@ -1528,8 +2985,8 @@ void Server::handlePassCommand(Client *client, const std::vector<std::string> &p
      */
 	if (client->hasSentPass())
 	{
-		std::string error = IrcMessageBuilder::buildAlreadyRegisteredError(_serverName);
-		send(client->getSocket(), error.c_str(), error.length(), 0);
+		IrcReply error = IrcMessageBuilder::buildAlreadyRegisteredError(_serverName);
+		sendToClient(client, error);
 		return;
 	}
 
@@ -1537,27 +2994,21 @@ void Server::handlePassCommand(Client *client, const std::vector<std::string> &p
      * Vérifie si suffisamment de paramètres ont été fournis avec la commande PASS.
      * Si non, envoie une erreur 461 indiquant un manque de paramètres.
      */
-	if (params.size() < TWO_ARGMNTS)
+	if (message.paramCount() < ONE_PARAM)
 	{
-		std::string error = IrcMessageBuilder::buildNeedMoreParamsError(_serverName, "PASS");
-		send(client->getSocket(), error.c_str(), error.length(), 0);
+		IrcReply error = IrcMessageBuilder::buildNeedMoreParamsError(_serverName, "PASS");
+		sendToClient(client, error);
 		return;
 	}
 
     /**
-     * Récupère le mot de passe fourni dans les paramètres.
-     * `params[1]` correspond au deuxième élément (après "PASS").
-     */
-	std::string password = params[1];
-
-    /**
-     * Vérifie si le mot de passe fourni correspond au mot de passe attendu par le serveur.
+     * Vérifie si le mot de passe fourni (premier paramètre) correspond au mot de passe attendu par le serveur.
      * Si non, envoie une erreur 464 indiquant un mot de passe incorrect et déconnecte le client.
      */
-	if (password != _password)
+	if (!message.param(0).equals(_password))
 	{
-		std::string error = IrcMessageBuilder::buildPasswordMismatchError(_serverName);
-		send(client->getSocket(), error.c_str(), error.length(), 0);
+		IrcReply error = IrcMessageBuilder::buildPasswordMismatchError(_serverName);
+		sendToClient(client, error);
 		removeClient(client);
 		return;
 	}
@@ -1626,26 +3077,26 @@ bool Server::isValidNickname(const std::string &nickname)
  * Gère la commande NICK envoyée par un client pour définir ou changer son pseudonyme.
  * La fonction valide le pseudonyme, vérifie qu'il n'est pas utilisé, et met à jour le pseudonyme du client.
  * @param client : le client qui envoie la commande NICK
- * @param params : vecteur contenant la commande et ses paramètres
+ * @param message : la commande analysée et ses paramètres
  */
-void Server::handleNickCommand(Client *client, const std::vector<std::string> &params)
+void Server::handleNickCommand(Client *client, const IrcMessage &message)
 {
     /**
      * Vérifie si suffisamment de paramètres ont été fournis avec la commande NICK.
      * Si aucun pseudonyme n'est donné, envoie une erreur 431 indiquant "No nickname given".
      */
-	if (params.size() < TWO_ARGMNTS)
+	if (message.paramCount() < ONE_PARAM)
 	{
-		std::string error = IrcMessageBuilder::buildNoNicknameGivenError(_serverName);
-		send(client->getSocket(), error.c_str(), error.length(), 0);
+		IrcReply error = IrcMessageBuilder::buildNoNicknameGivenError(_serverName);
+		sendToClient(client, error);
 		return;
 	}
 
     /**
      * Récupère le nouveau pseudonyme proposé par le client.
-     * `params[1]` contient le pseudonyme fourni après la commande NICK.
+     * Le premier paramètre contient le pseudonyme fourni après la commande NICK.
      */
-	std::string newNickname = params[1];
+	std::string newNickname = message.param(0).str();
 
     /**
      * Valide le pseudonyme en vérifiant qu'il respecte les règles IRC (longueur, caractères valides, etc.).
@@ -1653,23 +3104,31 @@ void Server::handleNickCommand(Client *client, const std::vector<std::string> &p
      */
 	if (!isValidNickname(newNickname))
 	{
-		std::string error = IrcMessageBuilder::buildErroneousNicknameError(_serverName, newNickname);
-		send(client->getSocket(), error.c_str(), error.length(), 0);
+		IrcReply error = IrcMessageBuilder::buildErroneousNicknameError(_serverName, newNickname);
+		sendToClient(client, error);
 		return;
 	}
 
+	/* Index et pseudonymes lus par les autres boucles : la vérification et le changement sont indivisibles */
+	MutexGuard guard(_nickLock);
+
+    /**
+     * Un client retiré pendant la commande (erreur d'écriture sur sa boucle)
+     * a déjà quitté l'index : il ne doit pas y revenir.
+     */
+	if (client->isClosing() || client->isCloseRequested())
+		return;
+
     /**
      * Vérifie si le pseudonyme est déjà utilisé par un autre client enregistré sur le serveur.
      * Si le pseudonyme est en cours d'utilisation, envoie une erreur 433 indiquant "Nickname is already in use".
      */
-	for (std::vector<Client*>::iterator it = _clients.begin(); it != _clients.end(); ++it)
+	Client *owner = getClientByNickname(newNickname);
+	if (owner && owner != client)
 	{
-		if ((*it)->getNickname() == newNickname && *it != client)
-		{
-			std::string error = IrcMessageBuilder::buildNicknameInUseError(_serverName, newNickname);
-			send(client->getSocket(), error.c_str(), error.length(), 0);
-			return;
-		}
+		IrcReply error = IrcMessageBuilder::buildNicknameInUseError(_serverName, newNickname);
+		sendToClient(client, error);
+		return;
 	}
 
     /**
@@ -1678,11 +3137,14 @@ void Server::handleNickCommand(Client *client, const std::vector<std::string> &p
      */
 	if (client->isRegistered())
 	{
-		std::string nickChangeMsg = IrcMessageBuilder::buildNickChangeMessage(client->getNickname(), newNickname);
-		for (std::vector<Client*>::iterator it = _clients.begin(); it != _clients.end(); ++it)
+		IrcReply nickChangeMsg = IrcMessageBuilder::buildNickChangeMessage(client->getPrefix(), newNickname);
+		for (size_t i = 0; i < _nicknames.capacity(); ++i)
 		{
-			if (*it != client && (*it)->isRegistered())
-				send((*it)->getSocket(), nickChangeMsg.c_str(), nickChangeMsg.length(), 0);
+			if (!_nicknames.occupied(i))
+				continue;
+			Client *other = _nicknames.valueAt(i);
+			if (other != client && other->isRegistered())
+				sendToClient(other, nickChangeMsg);
 		}
 	}
 
@@ -1690,7 +3152,9 @@ void Server::handleNickCommand(Client *client, const std::vector<std::string> &p
      * Met à jour le pseudonyme du client avec le nouveau pseudonyme validé.
      * Le pseudonyme est stocké dans l'objet Client et mis à jour pour les interactions futures.
      */
+	unindexNickname(client);
 	client->setNickname(newNickname);
+	_nicknames.set(client->getFoldedNickname(), client);
 	std::cout << getBackgroundColorCode(client->getSocket()) 
 			<< "\nClient " << client->getSocket() 
 			<< " changed nickname to " << newNickname 
@@ -1747,9 +3211,9 @@ bool Server::isValidUsername(const std::string &username)
  * Valide et enregistre les informations fournies (username, hostname, servername, realname),
  * tout en vérifiant que le client n'est pas déjà enregistré.
  * @param client : le client qui envoie la commande USER
- * @param params : vecteur contenant la commande et ses paramètres
+ * @param message : la commande analysée et ses paramètres
  */
-void Server::handleUserCommand(Client *client, const std::vector<std::string> &params)
+void Server::handleUserCommand(Client *client, const IrcMessage &message)
 {
     /**
      * Vérifie si le client a déjà envoyé une commande USER.
@@ -1757,8 +3221,8 @@ void Server::handleUserCommand(Client *client, const std::vector<std::string> &p
      */
 	if (client->hasSentUser())
 	{
-		std::string error = IrcMessageBuilder::buildAlreadyRegisteredError(_serverName);
-		send(client->getSocket(), error.c_str(), error.length(), 0);
+		IrcReply error = IrcMessageBuilder::buildAlreadyRegisteredError(_serverName);
+		sendToClient(client, error);
 		return;
 	}
 
@@ -1767,38 +3231,28 @@ void Server::handleUserCommand(Client *client, const std::vector<std::string> &p
      * La commande USER nécessite au moins 4 paramètres après le mot-clé "USER".
      * Si ce n'est pas le cas, envoie une erreur 461 indiquant un manque de paramètres.
      */
-	if (params.size() < FIVE_ARGMNTS)
+	if (message.paramCount() < FOUR_PARAMS)
 	{
-		std::string error = IrcMessageBuilder::buildNeedMoreParamsError(_serverName, "USER");
-		send(client->getSocket(), error.c_str(), error.length(), 0);
+		IrcReply error = IrcMessageBuilder::buildNeedMoreParamsError(_serverName, "USER");
+		sendToClient(client, error);
 		return;
 	}
 
     /**
      * Récupère les paramètres requis de la commande USER :
      * - username : Identifiant unique de l'utilisateur.
-     * - hostname : Nom d'hôte de la machine utilisée par l'utilisateur.
+     * - hostname : ignoré, voir plus bas.
      * - servername : Nom du serveur auquel l'utilisateur est connecté.
      * - realname : Nom complet ou description de l'utilisateur.
      */
-	std::string username = params[1];
-	std::string hostname = params[2];
-	std::string servername = params[3];
-	std::string realname = params[4];
+	std::string username = message.param(0).str();
+	std::string servername = message.param(2).str();
 
     /**
-     * Si le realname commence par ':', supprime ce préfixe et concatène les
-     * paramètres restants pour former le nom complet. Cela permet de gérer
-     * les realnames contenant des espaces.
+     * Le realname est le quatrième paramètre ; envoyé en trailing, il peut
+     * contenir des espaces, conservés tels quels.
      */
-	if (realname[0] == ':')
-	{
-		realname = realname.substr(1);
-		for (size_t i = 5; i < params.size(); ++i)
-		{
-			realname += " " + params[i];
-		}
-	}
+	std::string realname = message.param(3).str();
 
     /**
      * Valide le username pour s'assurer qu'il respecte les règles définies (longueur, caractères valides, etc.).
@@ -1806,30 +3260,20 @@ void Server::handleUserCommand(Client *client, const std::vector<std::string> &p
      */
 	if (!isValidUsername(username))
 	{
-		std::string error = IrcMessageBuilder::buildErroneousUsernameError(_serverName, username);
-		send(client->getSocket(), error.c_str(), error.length(), 0);
+		IrcReply error = IrcMessageBuilder::buildErroneousUsernameError(_serverName, username);
+		sendToClient(client, error);
 		return;
 	}
 
-    /**
-     * Si le hostname n'est pas fourni ou est vide, utilise une valeur par défaut.
-     * Cela garantit que chaque client a un hostname, même s'il n'en a pas spécifié.
-     */
-	if (hostname.empty())
-	{
-		/* Valeur par défaut si le nom d'hôte n'est pas fourni */
-		hostname = "unknown";
-	}
-
     /**
      * Met à jour les informations utilisateur du client dans son objet :
      * - username : Identifiant unique de l'utilisateur.
-     * - hostname : Nom d'hôte (valeur par défaut utilisée si non fourni).
      * - servername : Nom du serveur auquel l'utilisateur est connecté.
      * - realname : Nom complet ou description de l'utilisateur.
+     * Le hostname annoncé n'est pas repris : l'hôte du préfixe reste l'adresse
+     * relevée à la connexion, qu'un client ne peut pas choisir.
      */
 	client->setUsername(username);
-	client->setHostname(hostname);
 	client->setServername(servername);
 	client->setRealname(realname);
 
@@ -1847,94 +3291,140 @@ void Server::handleUserCommand(Client *client, const std::vector<std::string> &p
  */
 void Server::sendMotd(Client *client)
 {
-    /**
-     * Récupère les informations du client :
-     * - nick : Pseudonyme du client.
-     * - username : Identifiant fourni par le client lors de la commande USER.
-     */
 	std::string nick = client->getNickname();
-	std::string username = client->getUsername();
 
     /**
      * Envoie le message d'accueil 001 (RPL_WELCOME) au client.
-     * Ce message souhaite la bienvenue et affiche des informations de connexion.
+     * Il contient le nom réel et l'hôte du client : c'est la seule réponse rendue à chaque fois.
      */
-	std::string welcome = IrcMessageBuilder::buildWelcomeMessage(_serverName, nick, client->getRealname(), getServerIp());
-	send(client->getSocket(), welcome.c_str(), welcome.length(), 0);
+	IrcReply welcome = IrcMessageBuilder::buildWelcomeMessage(_serverName, nick, client->getRealname(), client->getHostname());
+	sendToClient(client, welcome);
 
     /**
-     * Envoie le message 002 (RPL_YOURHOST), qui informe le client de l'hôte du serveur
-     * et de la version du logiciel qu'il exécute.
+     * Envoie les réponses 002 à 005 et le MOTD depuis le cache :
+     * chaque ligne est déjà rendue, seul le pseudonyme y est recopié.
      */
-	std::string yourHost = IrcMessageBuilder::buildYourHostMessage(_serverName, nick, "1.0");
-	send(client->getSocket(), yourHost.c_str(), yourHost.length(), 0);
+	MutexGuard guard(_welcomeLock);
+	for (size_t i = 0; i < _welcome.size(); ++i)
+	{
+		IrcReply line;
+		_welcome.write(i, nick, line);
+		sendToClient(client, line);
+	}
+}
 
-    /**
-     * Envoie le message 003 (RPL_CREATED), indiquant la date de création du serveur.
-     * Ici, une date fictive est utilisée, mais cela pourrait être dynamique.
-     */
-	std::string created = IrcMessageBuilder::buildServerCreatedMessage(_serverName, nick, "at some point in the past");
-	send(client->getSocket(), created.c_str(), created.length(), 0);
+/**
+ * Rend les réponses d'accueil qui ne dépendent que du serveur, avec un pseudonyme vide.
+ * Le pseudonyme suit toujours ":<serveur> <code> ", l'en-tête a donc une longueur fixe.
+ * Le cache n'est remplacé que si le MOTD a pu être lu.
+ * @param error : la raison de l'échec, si le fichier MOTD est illisible
+ * @return bool : true si le cache a été rendu
+ */
+bool Server::renderWelcome(std::string &error)
+{
+	std::vector<std::string> motdLines;
+	if (_config.motdFile.empty())
+		motdLines.push_back("Welcome to our IRC server!");
+	else if (!WelcomeCache::readMotd(_config.motdFile, motdLines, error))
+		return false;
 
     /**
-     * Envoie le message 004 (RPL_MYINFO), qui fournit des informations
-     * supplémentaires sur le serveur, telles que les options et modes activés.
+     * Longueur de ":<serveur> 002 " : deux-points, nom du serveur, code numérique entouré d'espaces.
      */
-	std::string myInfo = IrcMessageBuilder::buildMyInfoMessage(_serverName, nick, "1.0", "o", "o");
-	send(client->getSocket(), myInfo.c_str(), myInfo.length(), 0);
+	size_t head = 1 + _serverName.size() + RPL_YOURHOST.size();
+	WelcomeCache cache;
 
-    /**
-     * Envoie le message 375 (RPL_MOTDSTART), indiquant le début du Message of the Day.
-     */
-	std::string motdStart = IrcMessageBuilder::buildMotdStartMessage(_serverName, nick);
-	send(client->getSocket(), motdStart.c_str(), motdStart.length(), 0);
+	cache.add(IrcMessageBuilder::buildYourHostMessage(_serverName, "", "1.0"), head);
+	cache.add(IrcMessageBuilder::buildServerCreatedMessage(_serverName, "", "at some point in the past"), head);
+	cache.add(IrcMessageBuilder::buildMyInfoMessage(_serverName, "", "1.0", "o", "o"), head);
+	cache.add(IrcMessageBuilder::buildISupportMessage(_serverName, "",
+		"CASEMAPPING=" CASEMAPPING_NAME " CHANTYPES=#& PREFIX=(o)@ CHANMODES=,k,l,it NICKLEN=9"), head);
+	cache.add(IrcMessageBuilder::buildMotdStartMessage(_serverName, ""), head);
+	for (size_t i = 0; i < motdLines.size(); ++i)
+		cache.add(IrcMessageBuilder::buildMotdMessage(_serverName, "", motdLines[i]), head);
+	cache.add(IrcMessageBuilder::buildMotdEndMessage(_serverName, ""), head);
 
-    /**
-     * Envoie le message 372 (RPL_MOTD), contenant le contenu principal du Message of the Day.
-     * Ce message peut être étendu pour inclure plusieurs lignes.
-     */
-	std::string motd = IrcMessageBuilder::buildMotdMessage(_serverName, nick, "Welcome to our IRC server!");
-	send(client->getSocket(), motd.c_str(), motd.length(), 0);
+	/* Rendu hors du verrou : l'échange ne bloque pas les enregistrements en cours */
+	MutexGuard guard(_welcomeLock);
+	_welcome.swap(cache);
+	return true;
+}
 
-    /**
-     * Envoie le message 376 (RPL_ENDOFMOTD), indiquant la fin du Message of the Day.
-     */
-	std::string motdEnd = IrcMessageBuilder::buildMotdEndMessage(_serverName, nick);
-	send(client->getSocket(), motdEnd.c_str(), motdEnd.length(), 0);
+/**
+ * Recharge la configuration modifiable à chaud : les règles du bot, compilées
+ * dans un thread, et le MOTD, relu tout de suite car il est court.
+ * Un MOTD illisible laisse l'ancien en place.
+ */
+void Server::rehash()
+{
+	_bot.requestReload();
+
+	std::string error;
+	if (!renderWelcome(error))
+		std::cerr << "MOTD conservé : " << error << std::endl;
 }
 
 /**
  * Supprime un client du serveur en fermant son socket, en le retirant des structures internes,
  * et en le marquant pour une suppression différée.
+ * Exécutée par la boucle propriétaire du client ; un fil d'état la lui demande.
  * @param client : le client à supprimer
  */
 void Server::removeClient(Client *client)
 {
     /**
-     * Ferme le socket associé au client pour libérer les ressources réseau.
-     * Cela met fin à la connexion entre le serveur et ce client.
+     * Appelée par le fil d'état du pipeline (QUIT, mot de passe incorrect) :
+     * la boucle propriétaire fermera le client à la livraison de la demande,
+     * après les réponses déjà produites. Le pseudonyme est libéré dès maintenant.
+     */
+	if (ReplyOutbox::current() != NULL)
+	{
+		if (!client->isClosing() && !client->isCloseRequested())
+		{
+			client->setCloseRequested(true);
+			unindexNickname(client);
+			ReplyOutbox::current()->deferClose(client);
+		}
+		return;
+	}
+
+    /**
+     * Un client déjà retiré (QUIT suivi d'une erreur de lecture, par exemple)
+     * ne doit pas être ajouté deux fois à la suppression différée.
      */
-	close(client->getSocket());
+	if (client->isClosing())
+		return;
+	client->setClosing(true);
 
     /**
-     * Supprime le descripteur du client du _masterSet utilisé pour surveiller les sockets avec `select`.
-     * FD_CLR (File Descriptor Clear) retire le socket du set.
+     * Retire le descripteur du client de la boucle d'événements.
+     * Le socket lui-même est fermé par le destructeur de Client lors de la
+     * suppression différée : fermer ici permettrait à accept() de réutiliser
+     * le même numéro de fd avant la fin de l'itération.
      */
-	FD_CLR(client->getSocket(), &_masterSet);
+	ReactorLoop &loop = *client->getLoop();
+	loop.reactor->remove(client->getSocket());
 
     /**
-     * Supprime le client de la liste des clients (_clients).
-     * - std::remove réorganise la liste en déplaçant le client à la fin.
-     * - erase supprime effectivement le client de la liste.
+     * Libère l'entrée de la table indexée par fd : les événements restants
+     * de cette itération pour ce fd ne trouveront plus de client.
      */
-	_clients.erase(std::remove(_clients.begin(), _clients.end(), client), _clients.end());
+	loop.clientsByFd[client->getSocket()] = NULL;
+
+	/* Plus aucune échéance pour ce client */
+	loop.timers.cancel(&client->getKeepaliveTimer());
+
+	/* Le pseudonyme redevient disponible immédiatement */
+	unindexNickname(client);
 
     /**
-     * Ajoute le client à la liste _clientsToRemove pour une suppression différée.
-     * Cela permet de différer la destruction du client jusqu'à ce que toutes les opérations
-     * en cours soient terminées, évitant ainsi des comportements indéterminés.
+     * Ajoute le client à la liste clientsToRemove de sa boucle pour une suppression
+     * différée. Cela permet de différer la destruction du client, et son retrait de
+     * clients, jusqu'à ce que toutes les opérations en cours soient terminées, évitant
+     * ainsi des comportements indéterminés (un envoi qui échoue pendant un parcours de
+     * clients, par exemple).
      */
-	_clientsToRemove.push_back(client);
+	loop.clientsToRemove.push_back(client);
 }
 
 /**
@@ -2011,8 +3501,10 @@ void Server::sendNamesReply(Client *client, Channel *channel)
 	std::string nickList;
 
     /**
-     * Récupère la liste des clients connectés à ce canal.
+     * Récupère la liste des clients connectés à ce canal. Leurs pseudonymes
+     * peuvent changer sur leurs boucles (NICK) : ils sont lus sous _nickLock.
      */
+	MutexGuard nickGuard(_nickLock);
 	const std::vector<Client*> &clients = channel->getClients();
 
     /**
@@ -2036,15 +3528,15 @@ void Server::sendNamesReply(Client *client, Channel *channel)
      * RPL_NAMREPLY (353) :
      * Envoie une réponse avec la liste des noms des utilisateurs connectés au canal.
      */
-	std::string namesReply = IrcMessageBuilder::buildNamesReply(_serverName, client->getNickname(), channel->getName(), nickList);
-	send(client->getSocket(), namesReply.c_str(), namesReply.length(), 0);
+	IrcReply namesReply = IrcMessageBuilder::buildNamesReply(_serverName, client->getNickname(), channel->getName(), nickList);
+	sendToClient(client, namesReply);
 
     /**
      * RPL_ENDOFNAMES (366) :
      * Informe que la liste des noms est complète.
      */
-	std::string endOfNames = IrcMessageBuilder::buildEndOfNamesMessage(_serverName, client->getNickname(), channel->getName());
-	send(client->getSocket(), endOfNames.c_str(), endOfNames.length(), 0);
+	IrcReply endOfNames = IrcMessageBuilder::buildEndOfNamesMessage(_serverName, client->getNickname(), channel->getName());
+	sendToClient(client, endOfNames);
 }
 
 std::vector<std::string> splitArg(const std::string &s, char delimiter)
@@ -2065,24 +3557,23 @@ std::vector<std::string> splitArg(const std::string &s, char delimiter)
  * Si le canal n'existe pas, il est créé. Le client doit respecter les règles
  * de mode du canal (`+i`, `+k`, `+l`) pour y accéder.
  * @param client : Le client envoyant la commande JOIN.
- * @param params : Les paramètres de la commande JOIN, comprenant le nom du canal
- *                 et, éventuellement, une clé.
+ * @param message : La commande JOIN analysée, comprenant le nom du canal
+ *                  et, éventuellement, une clé.
  */
-void Server::handleJoinCommand(Client *client, const std::vector<std::string> &params)
+void Server::handleJoinCommand(Client *client, const IrcMessage &message)
 {
-	/* Assurez-vous que TWO_ARGMNTS = 2 */
-    if (params.size() < 2)
+    if (message.paramCount() < ONE_PARAM)
     {
-		std::string error = IrcMessageBuilder::buildNeedMoreParamsError(_serverName, "JOIN");
-        send(client->getSocket(), error.c_str(), error.length(), 0);
+		IrcReply error = IrcMessageBuilder::buildNeedMoreParamsError(_serverName, "JOIN");
+        sendToClient(client, error);
         return;
     }
 
     /* Séparer les canaux et les clés par des virgules */
-    std::vector<std::string> channelNames = splitArg(params[1], ',');
+    std::vector<std::string> channelNames = splitArg(message.param(0).str(), ',');
     std::vector<std::string> keys;
-    if (params.size() >= 3)
-        keys = splitArg(params[2], ',');
+    if (message.paramCount() >= TWO_PARAMS)
+        keys = splitArg(message.param(1).str(), ',');
 
     for (size_t i = 0; i < channelNames.size(); ++i)
     {
@@ -2094,36 +3585,32 @@ void Server::handleJoinCommand(Client *client, const std::vector<std::string> &p
         /* Valider le nom du canal */
         if (channelName.empty() || (channelName[0] != '#' && channelName[0] != '&'))
         {
-			std::string error = IrcMessageBuilder::buildBadChannelMaskError(_serverName, channelName);
-            send(client->getSocket(), error.c_str(), error.length(), 0);
+			IrcReply error = IrcMessageBuilder::buildBadChannelMaskError(_serverName, channelName);
+            sendToClient(client, error);
 			/* Passe au canal suivant */
             continue;
         }
 
         /* Initialiser le canal */
-        Channel *channel = NULL;
+        Channel *channel = findChannel(channelName);
 
-        if (_channels.find(channelName) == _channels.end())
+        if (channel == NULL)
         {
-            channel = new (std::nothrow) Channel(channelName);
+            channel = createChannel(channelName);
             if (channel == NULL)
             {
                 std::cerr << "Échec de l'allocation mémoire pour le canal " << channelName << "." << std::endl;
                 /* Passe au canal suivant */
 				continue;
             }
-            _channels[channelName] = channel;
-            channel->addOperator(client);
         }
         else
         {
-            channel = _channels[channelName];
-
             /* Vérifier le mode 'i' (invitation uniquement) */
             if (channel->hasMode('i') && !channel->isInvited(client))
             {
-				std::string error = IrcMessageBuilder::buildInviteOnlyChannelError(_serverName, channelName);
-                send(client->getSocket(), error.c_str(), error.length(), 0);
+				IrcReply error = IrcMessageBuilder::buildInviteOnlyChannelError(_serverName, channelName);
+                sendToClient(client, error);
                 /* Passe au canal suivant */
 				continue;
             }
@@ -2131,28 +3618,33 @@ void Server::handleJoinCommand(Client *client, const std::vector<std::string> &p
             /* Vérifier le mode 'k' (clé du canal) */
             if (channel->hasMode('k') && !channel->checkKey(key))
             {
-				std::string error = IrcMessageBuilder::buildBadChannelKeyError(_serverName, channelName);
-                send(client->getSocket(), error.c_str(), error.length(), 0);
+				IrcReply error = IrcMessageBuilder::buildBadChannelKeyError(_serverName, channelName);
+                sendToClient(client, error);
                 continue; /* Passe au canal suivant */
             }
 
             /* Vérifier le mode 'l' (limite d'utilisateurs) */
             if (channel->isFull())
             {
-				std::string error = IrcMessageBuilder::buildChannelIsFullError(_serverName, channelName);
-                send(client->getSocket(), error.c_str(), error.length(), 0);
+				IrcReply error = IrcMessageBuilder::buildChannelIsFullError(_serverName, channelName);
+                sendToClient(client, error);
                 /* Passe au canal suivant */
 				continue; 
             }
         }
 
-        /* Ajouter le client au canal */
+        /* Les réponses reprennent le nom du canal tel qu'il a été créé */
+        channelName = channel->getName();
+
+        /* Ajouter le client au canal ; le premier membre en devient opérateur */
         channel->addClient(client);
+        if (channel->getClients().size() == 1)
+            channel->addOperator(client);
         client->joinChannel(channel);
         channel->removeInvitation(client);
 
         /* Notifier les autres clients dans le canal */
-		std::string joinMsg = IrcMessageBuilder::buildJoinMessage(client->getNickname(), client->getRealname(), getServerIp(), channelName);
+		IrcReply joinMsg = IrcMessageBuilder::buildJoinMessage(client->getPrefix(), channelName);
 
 
         /*   -'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-',-'   */
@@ -2162,22 +3654,19 @@ void Server::handleJoinCommand(Client *client, const std::vector<std::string> &p
         std::cout << "\nCmd Join send by " << getBackgroundColorCode(client->getSocket()) << joinMsg << "\033[0m\033[K";
 
 
-        const std::vector<Client*> &channelClients = channel->getClients();
-        for (size_t j = 0; j < channelClients.size(); ++j)
-        {
-            send(channelClients[j]->getSocket(), joinMsg.c_str(), joinMsg.length(), 0);
-        }
+        /* L'auteur reçoit son JOIN en ligne, avant le sujet et la liste des membres */
+        broadcastToChannel(channel, joinMsg);
 
         /* Envoyer le sujet du canal (RPL_TOPIC ou RPL_NOTOPIC) au client */
         if (channel->hasTopic())
         {
-            std::string topicMsg = IrcMessageBuilder::buildTopicReply(_serverName, client->getNickname(), channelName, channel->getTopic());
-			send(client->getSocket(), topicMsg.c_str(), topicMsg.length(), 0);
+            IrcReply topicMsg = IrcMessageBuilder::buildTopicReply(_serverName, client->getNickname(), channelName, channel->getTopic());
+			sendToClient(client, topicMsg);
         }
         else
         {
-            std::string noTopicMsg = IrcMessageBuilder::buildNoTopicReply(_serverName, client->getNickname(), channelName);
-            send(client->getSocket(), noTopicMsg.c_str(), noTopicMsg.length(), 0);
+            IrcReply noTopicMsg = IrcMessageBuilder::buildNoTopicReply(_serverName, client->getNickname(), channelName);
+            sendToClient(client, noTopicMsg);
         }
 
         /* Envoyer la liste des membres du canal (commande NAMES) */
@@ -2190,45 +3679,44 @@ void Server::handleJoinCommand(Client *client, const std::vector<std::string> &p
  * Notifie les autres membres du canal du départ du client. Supprime le canal
  * si aucun client n’y reste après le départ.
  * @param client : Le client envoyant la commande PART.
- * @param params : Les paramètres de la commande PART, comprenant le nom du canal.
+ * @param message : La commande PART analysée, comprenant le nom du canal.
  */
-void Server::handlePartCommand(Client *client, const std::vector<std::string> &params)
+void Server::handlePartCommand(Client *client, const IrcMessage &message)
 {
     /* Vérification du nombre minimum de paramètres */
-    if (params.size() < TWO_ARGMNTS)
+    if (message.paramCount() < ONE_PARAM)
     {
-		std::string error = IrcMessageBuilder::buildNeedMoreParamsError(_serverName, "PART");
-        send(client->getSocket(), error.c_str(), error.length(), 0);
+		IrcReply error = IrcMessageBuilder::buildNeedMoreParamsError(_serverName, "PART");
+        sendToClient(client, error);
         return;
     }
 
     /* Récupération de la liste des canaux séparés par des virgules */
-    std::vector<std::string> channelNames = splitArg(params[1], ',');
+    std::vector<std::string> channelNames = splitArg(message.param(0).str(), ',');
 
     for (size_t i = 0; i < channelNames.size(); ++i)
     {
         std::string channelName = channelNames[i];
 
         /* Vérifie que le canal existe */
-        if (_channels.find(channelName) == _channels.end())
+        Channel *channel = findChannel(channelName);
+        if (channel == NULL)
         {
-            std::string error = IrcMessageBuilder::buildNoSuchChannelError(_serverName, channelName);
-            send(client->getSocket(), error.c_str(), error.length(), 0);
+            IrcReply error = IrcMessageBuilder::buildNoSuchChannelError(_serverName, channelName);
+            sendToClient(client, error);
             continue;
         }
 
-        Channel *channel = _channels[channelName];
-
         /* Vérifie que le client est membre du canal */
         if (!channel->hasClient(client))
         {
-            std::string error = IrcMessageBuilder::buildNotOnChannelError(_serverName, channelName);
-            send(client->getSocket(), error.c_str(), error.length(), 0);
+            IrcReply error = IrcMessageBuilder::buildNotOnChannelError(_serverName, channelName);
+            sendToClient(client, error);
             continue;
         }
 
         /* Prépare et envoie le message PART à tous les membres du canal */
-		std::string partMsg = IrcMessageBuilder::buildPartMessage(client->getNickname(), client->getUsername(), getServerIp(), channelName);
+		IrcReply partMsg = IrcMessageBuilder::buildPartMessage(client->getPrefix(), channelName);
 
 
         /*   -'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-'-,-',-'   */
@@ -2238,11 +3726,7 @@ void Server::handlePartCommand(Client *client, const std::vector<std::string> &p
         std::cout << "\033[0m\nCmd PART send by " << getBackgroundColorCode(client->getSocket()) << ":" << partMsg << "\033[0m\033[K";
 
 
-        const std::vector<Client*> &channelClients = channel->getClients();
-        for (size_t j = 0; j < channelClients.size(); ++j)
-        {
-            send(channelClients[j]->getSocket(), partMsg.c_str(), partMsg.length(), 0);
-        }
+        broadcastToChannel(channel, partMsg);
 
         /* Retire le client du canal */
         channel->removeClient(client);
@@ -2250,10 +3734,7 @@ void Server::handlePartCommand(Client *client, const std::vector<std::string> &p
 
         /* Supprime le canal si vide */
         if (channel->getClients().empty())
-        {
-            _channels.erase(channelName);
-            delete channel;
-        }
+            destroyChannel(channel);
     }
 }
 
@@ -2261,50 +3742,38 @@ void Server::handlePartCommand(Client *client, const std::vector<std::string> &p
  * Gère la commande PRIVMSG envoyée par un client pour transmettre un message.
  * La commande peut cibler un canal ou un utilisateur spécifique.
  * @param client : Le client qui envoie le message.
- * @param params : Les paramètres de la commande PRIVMSG.
+ * @param message : La commande PRIVMSG analysée.
  */
-void Server::handlePrivmsgCommand(Client *client, const std::vector<std::string> &params)
+void Server::handlePrivmsgCommand(Client *client, const IrcMessage &message)
 {
     /**
      * Vérifie si le client a fourni suffisamment de paramètres (au moins une cible et un message).
      * Renvoie une erreur si les paramètres sont insuffisants.
      */
-	if (params.size() < THREE_ARGMNTS)
+	if (message.paramCount() < TWO_PARAMS)
 	{
-		std::string error = IrcMessageBuilder::buildNeedMoreParamsError(_serverName, "PRIVMSG");
-		send(client->getSocket(), error.c_str(), error.length(), 0);
+		IrcReply error = IrcMessageBuilder::buildNeedMoreParamsError(_serverName, "PRIVMSG");
+		sendToClient(client, error);
 		return;
 	}
 
     /** 
      * Récupère la cible (canal ou utilisateur) et le message depuis les paramètres.
      */
-	std::string target = params[1];
-	std::string message = params[2];
-
-    /**
-     * Si le message commence par ':', combine les paramètres restants pour former le message complet.
-     */
-	if (message[0] == ':')
-	{
-		message = message.substr(1);
-		for (size_t i = 3; i < params.size(); ++i)
-		{
-			message += " " + params[i];
-		}
-	}
+	std::string target = message.param(0).str();
+	std::string text = message.param(1).str();
 
     /**
      * Vérifie si le message est un message CTCP (Client-to-Client Protocol).
      * Les messages CTCP commencent et se terminent par le caractère '\x01'.
      */
 	bool isCTCP = false;
-	if (!message.empty() && message[0] == '\x01' && message[message.size() - 1] == '\x01')
+	if (text.size() >= 2 && text[0] == '\x01' && text[text.size() - 1] == '\x01')
 	{
 		isCTCP = true;
-		std::string ctcpMessage = message.substr(1, message.size() - 2);
+		std::string ctcpMessage = text.substr(1, text.size() - 2);
 		std::vector<std::string> ctcpParams = split(ctcpMessage, " ");
-		std::string ctcpCommand = ctcpParams[0];
+		std::string ctcpCommand = ctcpParams.empty() ? "" : ctcpParams[0];
 
         /**
          * Gère la commande CTCP PING, en répondant au client avec un message PING.
@@ -2312,7 +3781,7 @@ void Server::handlePrivmsgCommand(Client *client, const std::vector<std::string>
 		if (ctcpCommand == "PING")
 		{
 			/* Répondre au CTCP PING */
-			std::string response = ":" + client->getNickname() + " NOTICE " + target + " :\x01PING";
+			std::string response = client->getPrefix() + " NOTICE " + target + " :\x01PING";
 			if (ctcpParams.size() > 1)
 			{
 				/* Inclure le timestamp */
@@ -2321,7 +3790,7 @@ void Server::handlePrivmsgCommand(Client *client, const std::vector<std::string>
 			response += "\x01\r\n";
 
 			/* Envoyer la réponse au client */
-			send(client->getSocket(), response.c_str(), response.length(), 0);
+			sendToClient(client, response);
 			return;
 		}
 		/* Gérer d'autres commandes CTCP si nécessaire */
@@ -2329,8 +3798,9 @@ void Server::handlePrivmsgCommand(Client *client, const std::vector<std::string>
 
     /**
      * Prépare le message complet avec le format :[expéditeur] PRIVMSG [cible] :[message].
+     * L'expéditeur est le préfixe tenu à jour par le client, copié tel quel.
      */
-	std::string fullMsg = ":" + client->getNickname() + " PRIVMSG " + target + " :" + message + "\r\n";
+	IrcReply fullMsg = IrcMessageBuilder::buildPrivmsgMessage(client->getPrefix(), target, text);
 
     /**
      * Si la cible est un canal (nom commençant par '#' ou '&'), envoie le message à tous les membres du canal.
@@ -2338,65 +3808,53 @@ void Server::handlePrivmsgCommand(Client *client, const std::vector<std::string>
 	if (target[0] == '#' || target[0] == '&')
 	{
 		/* Cible est un canal */
-		if (_channels.find(target) == _channels.end())
+		Channel *channel = findChannel(target);
+		if (channel == NULL)
 		{
-			std::string error = IrcMessageBuilder::buildNoSuchChannelError(_serverName, target);
-			send(client->getSocket(), error.c_str(), error.length(), 0);
+			IrcReply error = IrcMessageBuilder::buildNoSuchChannelError(_serverName, target);
+			sendToClient(client, error);
 			return;
 		}
 
-		Channel *channel = _channels[target];
-
         /**
          * Vérifie si le client est membre du canal.
          * Renvoie une erreur si le client n'est pas autorisé à envoyer un message au canal.
          */
 		if (!channel->hasClient(client))
 		{
-			std::string error = IrcMessageBuilder::buildCannotSendToChannelError(_serverName, client->getNickname(), target);
-			send(client->getSocket(), error.c_str(), error.length(), 0);
+			IrcReply error = IrcMessageBuilder::buildCannotSendToChannelError(_serverName, client->getNickname(), target);
+			sendToClient(client, error);
 			return;
 		}
 
         /**
          * Envoie le message à tous les membres du canal, sauf à l'expéditeur.
          */
-		const std::vector<Client*> &channelClients = channel->getClients();
-		for (size_t i = 0; i < channelClients.size(); ++i)
-		{
-			if (channelClients[i] != client)
-				send(channelClients[i]->getSocket(), fullMsg.c_str(), fullMsg.length(), 0);
-		}
+		broadcastToChannel(channel, fullMsg, client);
 	}
 	
 	else
 	{
         /**
          * Si la cible est un utilisateur, cherche le client correspondant au pseudonyme cible.
+         * Il reste dans l'index, donc alloué, tant que le verrou est tenu.
          */
-		Client *targetClient = NULL;
-		for (size_t i = 0; i < _clients.size(); ++i)
-		{
-			if (_clients[i]->getNickname() == target)
-			{
-				targetClient = _clients[i];
-				break;
-			}
-		}
+		MutexGuard nickGuard(_nickLock);
+		Client *targetClient = getClientByNickname(target);
 
         /**
          * Vérifie si le client cible existe. Renvoie une erreur si le pseudonyme est invalide.
          */
 		if (!targetClient)
 		{
-			std::string error = IrcMessageBuilder::buildNoSuchNickError(_serverName, target);
-			send(client->getSocket(), error.c_str(), error.length(), 0);
+			IrcReply error = IrcMessageBuilder::buildNoSuchNickError(_serverName, target);
+			sendToClient(client, error);
 			return;
 		}
 
 		/* Si c'est un CTCP, n'envoyer le message qu'au destinataire */
 		if (isCTCP)
-			send(targetClient->getSocket(), fullMsg.c_str(), fullMsg.length(), 0);
+			sendToClient(targetClient, fullMsg);
 		
 		else
 		{
@@ -2404,41 +3862,11 @@ void Server::handlePrivmsgCommand(Client *client, const std::vector<std::string>
 			 * Envoie le message directement au client cible.
 			 * Si le message est un CTCP, le message est envoyé uniquement au destinataire.
 			 */
-			send(targetClient->getSocket(), fullMsg.c_str(), fullMsg.length(), 0);
+			sendToClient(targetClient, fullMsg);
 		}
 	}
 }
 
-/**
- * Accède au master set de descripteurs de fichiers.
- * Le master set contient tous les descripteurs actuellement surveillés par le serveur,
- * incluant le socket d'écoute et les sockets des clients connectés.
- * @return Référence à _masterSet, la structure contenant les descripteurs surveillés.
- */
-fd_set& Server::getMasterSet()
-{
-    /**
-     * Renvoie une référence à _masterSet pour permettre son utilisation ou modification
-     * à l'extérieur de la classe Server.
-     */
-	return _masterSet;
-}
-
-/**
- * Accède à la valeur maximale des descripteurs de fichiers surveillés par le serveur.
- * Cette valeur est nécessaire pour la fonction `select()`, qui parcourt tous les
- * descripteurs de fichiers actifs jusqu'à ce nombre.
- * @return La valeur maximale des descripteurs de fichiers (_fdMax).
- */
-int Server::getFdMax() const
-{
-    /**
-     * Retourne _fdMax, le plus grand descripteur de fichier utilisé dans le serveur.
-     * _fdMax est mis à jour chaque fois qu'un nouveau descripteur est ajouté.
-     */
-	return _fdMax;
-}
-
 /**
  * Récupère le nom du serveur IRC.
  * @return Une référence constante à la chaîne contenant le nom du serveur (_serverName).
@@ -2453,21 +3881,6 @@ const std::string& Server::getServerName() const
 	return _serverName;
 }
 
-/**
- * Met à jour le descripteur de fichier maximal suivi par le serveur.
- * @param fd Descripteur de fichier à comparer avec _fdMax.
- */
-void Server::setFdMax(int fd)
-{
-    /**
-     * Si le nouveau descripteur (fd) est supérieur au _fdMax actuel,
-     * met à jour _fdMax avec la valeur de fd.
-     * _fdMax représente le plus grand descripteur de fichier que le serveur doit surveiller.
-     */
-	if (fd > _fdMax)
-		_fdMax = fd;
-}
-
 /**
  * Retourne l'adresse IP du serveur.
  * @return Une référence à la chaîne contenant l'adresse IP (_serverIp).
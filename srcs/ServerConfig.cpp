@@ -0,0 +1,140 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   ServerConfig.cpp                                   :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: raveriss <raveriss@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/11/20 15:09:52 by raveriss          #+#    #+#             */
+/*   Updated: 2024/11/20 15:09:52 by raveriss         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../incs/ServerConfig.hpp"
+
+/* For IRC_LINE_MAX */
+#include "../incs/LineFramer.hpp"
+
+/* For CpuTopology::parseList() */
+#include "../incs/CpuTopology.hpp"
+
+/* For strtoul() */
+#include <cstdlib>
+
+/**
+ * Convertit une valeur numérique d'option, bornée par `minimum`
+ */
+static bool parseSize(const std::string &value, size_t minimum, size_t &out)
+{
+    if (value.empty() || value.find_first_not_of("0123456789") != std::string::npos)
+        return false;
+
+    unsigned long parsed = std::strtoul(value.c_str(), NULL, 10);
+    if (parsed < minimum)
+        return false;
+    out = parsed;
+    return true;
+}
+
+/**
+ * Constructor
+ * epoll est le backend par défaut là où il existe.
+ */
+ServerConfig::ServerConfig()
+#ifdef __linux__
+: reactorBackend("epoll"),
+#else
+: reactorBackend("select"),
+#endif
+  recvBufferSize(DEFAULT_RECV_BUFFER_SIZE), readBudget(DEFAULT_READ_BUDGET), maxClients(0), reactors(1), shards(0),
+  fanoutThreshold(0), fanoutWorkers(DEFAULT_FANOUT_WORKERS), pipeline(false)
+{}
+
+/**
+ * Sépare "--nom=valeur" et affecte le champ correspondant
+ */
+bool ServerConfig::parseArgument(const std::string &arg)
+{
+    if (arg.compare(0, 2, "--") != 0)
+        return false;
+
+    std::string::size_type eq = arg.find('=');
+    if (eq == std::string::npos)
+        return false;
+
+    std::string name = arg.substr(2, eq - 2);
+    std::string value = arg.substr(eq + 1);
+
+    if (name == "reactor")
+    {
+        if (value != "epoll" && value != "select")
+            return false;
+        reactorBackend = value;
+        return true;
+    }
+    if (name == "recv-buffer")
+        return parseSize(value, IRC_LINE_MAX, recvBufferSize);
+    if (name == "read-budget")
+        return parseSize(value, 1, readBudget);
+    if (name == "rules")
+    {
+        rulesFile = value;
+        return !value.empty();
+    }
+    if (name == "oper-password")
+    {
+        operPassword = value;
+        return !value.empty();
+    }
+    if (name == "max-clients")
+        return parseSize(value, 1, maxClients);
+    if (name == "reactors")
+        return parseSize(value, 1, reactors);
+    if (name == "shards")
+        return parseSize(value, 1, shards);
+    if (name == "fanout-threshold")
+        return parseSize(value, 1, fanoutThreshold);
+    if (name == "fanout-workers")
+        return parseSize(value, 1, fanoutWorkers);
+    if (name == "pipeline")
+    {
+        if (value != "on" && value != "off")
+            return false;
+        pipeline = (value == "on");
+        return true;
+    }
+    if (name == "reactor-cpus")
+        return CpuTopology::parseList(value, reactorCpus) && !reactorCpus.empty();
+    if (name == "shard-cpus")
+        return CpuTopology::parseList(value, shardCpus) && !shardCpus.empty();
+    if (name == "worker-cpus")
+        return CpuTopology::parseList(value, workerCpus) && !workerCpus.empty();
+    if (name == "motd")
+    {
+        motdFile = value;
+        return !value.empty();
+    }
+    return false;
+}
+
+/**
+ * @return the list of supported options
+ */
+const char *ServerConfig::usage()
+{
+    return "  --reactor=epoll|select   backend de la boucle d'événements\n"
+           "  --recv-buffer=OCTETS     taille du tampon de réception partagé (16384)\n"
+           "  --read-budget=OCTETS     octets lus par client et par tour de boucle (65536)\n"
+           "  --rules=FICHIER          règles du bot, rechargées par SIGHUP ou REHASH\n"
+           "  --oper-password=MOT      mot de passe de la commande OPER\n"
+           "  --motd=FICHIER           message du jour, relu par SIGHUP ou REHASH\n"
+           "  --max-clients=N          clients simultanés au plus, préalloués au démarrage\n"
+           "  --reactors=N             boucles d'événements, une par thread (1)\n"
+           "  --shards=N               threads propriétaires des canaux, aucun par défaut\n"
+           "  --fanout-threshold=N     membres à partir desquels un canal diffuse en parallèle\n"
+           "  --fanout-workers=N       travailleurs de diffusion (4)\n"
+           "  --pipeline=on|off        commandes exécutées par un fil d'état unique (off)\n"
+           "  --reactor-cpus=LISTE     processeurs des boucles, un par thread (ex. 0-3,8)\n"
+           "  --shard-cpus=LISTE       processeurs des shards ou du fil d'état du pipeline\n"
+           "  --worker-cpus=LISTE      processeurs des travailleurs de diffusion\n";
+}
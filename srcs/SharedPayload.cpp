@@ -0,0 +1,164 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   SharedPayload.cpp                                  :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: raveriss <raveriss@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/11/23 10:14:52 by raveriss          #+#    #+#             */
+/*   Updated: 2024/11/23 10:14:52 by raveriss         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../incs/SharedPayload.hpp"
+
+/* For std::memcpy */
+#include <cstring>
+
+/* For operator new / operator delete */
+#include <new>
+
+/**
+ * Constructor of an empty payload
+ */
+SharedPayload::SharedPayload()
+: _block(NULL)
+{}
+
+/**
+ * Constructor, copies `data` once into a block holding its header and bytes
+ */
+SharedPayload::SharedPayload(const std::string &data)
+: _block(NULL)
+{
+    if (data.empty())
+        return;
+
+    _block = allocate(data.size());
+    append(data.data(), data.size());
+}
+
+/**
+ * Constructor, copies `length` bytes once into a new block
+ */
+SharedPayload::SharedPayload(const char *data, size_t length)
+: _block(NULL)
+{
+    if (length == 0)
+        return;
+
+    _block = allocate(length);
+    append(data, length);
+}
+
+/**
+ * @return an empty block able to take `capacity` bytes through append()
+ */
+SharedPayload SharedPayload::withCapacity(size_t capacity)
+{
+    SharedPayload payload;
+    payload._block = allocate(capacity);
+    return payload;
+}
+
+/**
+ * Copy constructor, shares the block of `other`
+ */
+SharedPayload::SharedPayload(const SharedPayload &other)
+: _block(other._block)
+{
+    if (_block != NULL)
+        __sync_add_and_fetch(&_block->refs, 1);
+}
+
+/**
+ * Assignment operator, shares the block of `other`
+ */
+SharedPayload &SharedPayload::operator=(const SharedPayload &other)
+{
+    if (_block != other._block)
+    {
+        release();
+        _block = other._block;
+        if (_block != NULL)
+            __sync_add_and_fetch(&_block->refs, 1);
+    }
+    return *this;
+}
+
+/**
+ * Destructor
+ */
+SharedPayload::~SharedPayload()
+{
+    release();
+}
+
+/**
+ * @return the bytes of the message
+ */
+const char *SharedPayload::data() const
+{
+    return _block ? reinterpret_cast<const char *>(_block + 1) : "";
+}
+
+/**
+ * @return the size of the message
+ */
+size_t SharedPayload::size() const
+{
+    return _block ? _block->size : 0;
+}
+
+/**
+ * @return true if the message is empty
+ */
+bool SharedPayload::empty() const
+{
+    return _block == NULL || _block->size == 0;
+}
+
+/**
+ * @return the number of holders of the block
+ */
+size_t SharedPayload::useCount() const
+{
+    return _block ? _block->refs : 0;
+}
+
+/**
+ * Append bytes at the end of the block. A block seen by other holders is
+ * immutable, so this only succeeds for a sole holder with enough room.
+ * @return false if nothing was appended
+ */
+bool SharedPayload::append(const char *data, size_t length)
+{
+    if (_block == NULL || _block->refs != 1 || _block->capacity - _block->size < length)
+        return false;
+
+    std::memcpy(reinterpret_cast<char *>(_block + 1) + _block->size, data, length);
+    _block->size += length;
+    return true;
+}
+
+/**
+ * @return a new block of `capacity` bytes, held once and empty
+ */
+SharedPayload::Block *SharedPayload::allocate(size_t capacity)
+{
+    Block *block = static_cast<Block *>(::operator new(sizeof(Block) + capacity));
+    block->refs = 1;
+    block->size = 0;
+    block->capacity = capacity;
+    return block;
+}
+
+/**
+ * Drop the reference on the current block, freeing it with the last one
+ */
+void SharedPayload::release()
+{
+    if (_block != NULL && __sync_sub_and_fetch(&_block->refs, 1) == 0)
+        ::operator delete(_block);
+    _block = NULL;
+}
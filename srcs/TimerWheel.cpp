@@ -0,0 +1,190 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   TimerWheel.cpp                                     :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: raveriss <raveriss@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/11/23 15:41:07 by raveriss          #+#    #+#             */
+/*   Updated: 2024/11/23 15:41:07 by raveriss         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../incs/TimerWheel.hpp"
+
+/* For clock_gettime() */
+#include <ctime>
+
+/**
+ * Constructor
+ */
+TimerWheel::TimerWheel(uint64_t nowMs)
+: _now(nowMs / TIMER_TICK_MS), _count(0)
+{
+    for (int level = 0; level < TIMER_WHEEL_LEVELS; ++level)
+    {
+        for (size_t slot = 0; slot < TIMER_WHEEL_SLOTS; ++slot)
+        {
+            _slots[level][slot].prev = &_slots[level][slot];
+            _slots[level][slot].next = &_slots[level][slot];
+        }
+    }
+}
+
+/**
+ * @return the monotonic clock in milliseconds, unaffected by wall clock changes
+ */
+uint64_t TimerWheel::monotonicMs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+}
+
+/**
+ * Arm the timer for `expiresMs`, rounded up to a tick so it never fires early
+ */
+void TimerWheel::schedule(TimerNode *node, uint64_t expiresMs)
+{
+    cancel(node);
+
+    uint64_t expires = (expiresMs + TIMER_TICK_MS - 1) / TIMER_TICK_MS;
+    if (expires <= _now)
+        expires = _now + 1;
+
+    node->expires = expires;
+    place(node);
+    ++_count;
+}
+
+/**
+ * Disarm the timer if it is pending
+ */
+void TimerWheel::cancel(TimerNode *node)
+{
+    if (!node->armed())
+        return;
+    unlink(node);
+    --_count;
+}
+
+/**
+ * Move forward tick by tick up to `nowMs`, collecting expired timers.
+ * A level is cascaded into the one below each time the lower level wraps.
+ */
+void TimerWheel::advance(uint64_t nowMs, std::vector<TimerNode*> &expired)
+{
+    uint64_t target = nowMs / TIMER_TICK_MS;
+
+    while (_now < target)
+    {
+        /* Plus rien d'armé : inutile de parcourir les ticks un à un */
+        if (_count == 0)
+        {
+            _now = target;
+            break;
+        }
+
+        ++_now;
+        if ((_now & TIMER_WHEEL_MASK) == 0)
+        {
+            if (((_now >> TIMER_WHEEL_BITS) & TIMER_WHEEL_MASK) == 0)
+                cascade(2, (_now >> (2 * TIMER_WHEEL_BITS)) & TIMER_WHEEL_MASK);
+            cascade(1, (_now >> TIMER_WHEEL_BITS) & TIMER_WHEEL_MASK);
+        }
+
+        TimerNode *head = &_slots[0][_now & TIMER_WHEEL_MASK];
+        while (head->next != head)
+        {
+            TimerNode *node = head->next;
+            unlink(node);
+            --_count;
+            expired.push_back(node);
+        }
+    }
+}
+
+/**
+ * @return the delay in milliseconds until the next tick, `maxMs` when nothing is armed
+ */
+int TimerWheel::timeoutMs(uint64_t nowMs, int maxMs) const
+{
+    if (_count == 0)
+        return maxMs;
+
+    uint64_t nextTick = (_now + 1) * TIMER_TICK_MS;
+    if (nextTick <= nowMs)
+        return 0;
+    if (nextTick - nowMs < static_cast<uint64_t>(maxMs))
+        return static_cast<int>(nextTick - nowMs);
+    return maxMs;
+}
+
+/**
+ * @return the number of armed timers
+ */
+size_t TimerWheel::size() const
+{
+    return _count;
+}
+
+/**
+ * Link the timer into the slot of the lowest level that can hold its delay.
+ * Delays beyond the top level wait in its farthest slot and are placed again
+ * on each cascade until they come within range.
+ */
+void TimerWheel::place(TimerNode *node)
+{
+    uint64_t delta = node->expires - _now;
+    TimerNode *head;
+
+    if (delta < (static_cast<uint64_t>(1) << TIMER_WHEEL_BITS))
+        head = &_slots[0][node->expires & TIMER_WHEEL_MASK];
+    else if (delta < (static_cast<uint64_t>(1) << (2 * TIMER_WHEEL_BITS)))
+        head = &_slots[1][(node->expires >> TIMER_WHEEL_BITS) & TIMER_WHEEL_MASK];
+    else
+    {
+        uint64_t horizon = static_cast<uint64_t>(1) << (3 * TIMER_WHEEL_BITS);
+        uint64_t expires = (delta < horizon) ? node->expires : _now + horizon - 1;
+        head = &_slots[2][(expires >> (2 * TIMER_WHEEL_BITS)) & TIMER_WHEEL_MASK];
+    }
+
+    node->prev = head->prev;
+    node->next = head;
+    head->prev->next = node;
+    head->prev = node;
+}
+
+/**
+ * Empty a slot of an upper level and place its timers again from the current tick
+ */
+void TimerWheel::cascade(int level, size_t slot)
+{
+    TimerNode *head = &_slots[level][slot];
+    if (head->next == head)
+        return;
+
+    /* Détache la liste entière avant de la redistribuer */
+    TimerNode *node = head->next;
+    head->prev->next = NULL;
+    head->prev = head;
+    head->next = head;
+
+    while (node != NULL)
+    {
+        TimerNode *next = node->next;
+        place(node);
+        node = next;
+    }
+}
+
+/**
+ * Unlink the timer from its list and mark it as disarmed
+ */
+void TimerWheel::unlink(TimerNode *node)
+{
+    node->prev->next = node->next;
+    node->next->prev = node->prev;
+    node->prev = NULL;
+    node->next = NULL;
+}
@@ -0,0 +1,143 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   WelcomeCache.cpp                                   :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: raveriss <raveriss@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/11/25 14:18:21 by raveriss          #+#    #+#             */
+/*   Updated: 2024/11/25 14:18:21 by raveriss         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../incs/WelcomeCache.hpp"
+
+/* For open() */
+#include <fcntl.h>
+
+/* For fstat() */
+#include <sys/stat.h>
+
+/* For mmap(), munmap() */
+#include <sys/mman.h>
+
+/* For close() */
+#include <unistd.h>
+
+/* For strerror() */
+#include <cstring>
+
+/* For errno */
+#include <cerrno>
+
+/**
+ * Constructor
+ */
+WelcomeCache::WelcomeCache()
+{}
+
+/**
+ * Store a line rendered with an empty nickname, split where the nickname goes
+ */
+void WelcomeCache::add(const IrcReply &line, size_t headLength)
+{
+    Line entry;
+    entry.offset = _text.size();
+    entry.headLength = headLength;
+    entry.length = line.size() >= 2 ? line.size() - 2 : line.size();
+
+    _text.append(line.data(), entry.length);
+    _lines.push_back(entry);
+}
+
+/**
+ * @return the number of lines
+ */
+size_t WelcomeCache::size() const
+{
+    return _lines.size();
+}
+
+/**
+ * Splice `nickname` into line `index`; the reply enforces the line limit
+ */
+void WelcomeCache::write(size_t index, const std::string &nickname, IrcReply &reply) const
+{
+    const Line &line = _lines[index];
+    const char *text = _text.data() + line.offset;
+
+    reply.append(text, line.headLength);
+    reply << nickname;
+    reply.append(text + line.headLength, line.length - line.headLength);
+    reply.finish();
+}
+
+/**
+ * Exchange the contents with `other`
+ */
+void WelcomeCache::swap(WelcomeCache &other)
+{
+    _text.swap(other._text);
+    _lines.swap(other._lines);
+}
+
+/**
+ * Map the MOTD file and split it into lines, dropping CR and LF.
+ * The mapping only lives for the split: the lines are rendered into the cache.
+ * @return false if the file cannot be opened or mapped
+ */
+bool WelcomeCache::readMotd(const std::string &path, std::vector<std::string> &lines, std::string &error)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        error = path + ": " + strerror(errno);
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) < 0)
+    {
+        error = path + ": " + strerror(errno);
+        close(fd);
+        return false;
+    }
+
+    lines.clear();
+    size_t size = static_cast<size_t>(st.st_size);
+
+    /* Un fichier vide ne se projette pas : MOTD sans ligne */
+    if (size == 0)
+    {
+        close(fd);
+        return true;
+    }
+
+    void *mapped = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED)
+    {
+        error = path + ": " + strerror(errno);
+        return false;
+    }
+
+    const char *data = static_cast<const char *>(mapped);
+    size_t start = 0;
+    for (size_t i = 0; i <= size; ++i)
+    {
+        if (i < size && data[i] != '\n')
+            continue;
+
+        size_t end = i;
+        if (end > start && data[end - 1] == '\r')
+            --end;
+
+        /* Pas de ligne vide fantôme après le dernier saut de ligne */
+        if (i < size || end > start)
+            lines.push_back(std::string(data + start, end - start));
+        start = i + 1;
+    }
+
+    munmap(mapped, size);
+    return true;
+}
@@ -0,0 +1,199 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   WordMatcher.cpp                                    :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: raveriss <raveriss@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2024/11/24 11:06:38 by raveriss          #+#    #+#             */
+/*   Updated: 2024/11/24 11:06:38 by raveriss         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../incs/WordMatcher.hpp"
+
+/**
+ * Table des symboles : 1 à 26 pour les lettres, sans distinction de casse,
+ * 27 à 36 pour les chiffres, 0 (frontière) pour tout le reste.
+ * Lignes de 16 octets, de 0x00 à 0xff.
+ */
+const unsigned char WordMatcher::_symbols[256] =
+{
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    27, 28, 29, 30, 31, 32, 33, 34, 35, 36,  0,  0,  0,  0,  0,  0,
+     0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15,
+    16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26,  0,  0,  0,  0,  0,
+     0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15,
+    16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0
+};
+
+/**
+ * Constructor
+ */
+WordMatcher::WordMatcher()
+: _start(0)
+{
+    compile();
+}
+
+/**
+ * Add a word to the list; compile() must be called before matching again
+ */
+void WordMatcher::add(const std::string &word)
+{
+    _words.push_back(word);
+}
+
+/**
+ * Build the trie of the words, each surrounded by boundaries, then fold the
+ * failure links into a complete transition table with a breadth-first walk
+ */
+void WordMatcher::compile()
+{
+    _next.clear();
+    _accept.clear();
+    newState();
+
+    /* Trie des mots, les suites de séparateurs réduites à une seule frontière */
+    for (size_t w = 0; w < _words.size(); ++w)
+    {
+        const std::string &word = _words[w];
+        int state = 0;
+        bool hasSymbol = false;
+        unsigned char previous = WORD_MATCHER_BOUNDARY;
+
+        /* Frontière de début, les octets du mot, frontière de fin */
+        for (size_t i = 0; i <= word.size() + 1; ++i)
+        {
+            unsigned char symbol = WORD_MATCHER_BOUNDARY;
+            if (i > 0 && i <= word.size())
+                symbol = _symbols[static_cast<unsigned char>(word[i - 1])];
+
+            if (i > 0 && symbol == WORD_MATCHER_BOUNDARY && previous == WORD_MATCHER_BOUNDARY)
+                continue;
+            previous = symbol;
+            if (symbol != WORD_MATCHER_BOUNDARY)
+                hasSymbol = true;
+
+            int target = _next[state * WORD_MATCHER_SYMBOLS + symbol];
+            if (target < 0)
+            {
+                /* newState() agrandit _next : l'indice est recalculé après */
+                int created = newState();
+                _next[state * WORD_MATCHER_SYMBOLS + symbol] = created;
+                state = created;
+            }
+            else
+                state = target;
+        }
+
+        /* Un mot sans lettre ni chiffre reconnaîtrait n'importe quelle frontière */
+        if (hasSymbol)
+            _accept[state] = 1;
+    }
+
+    /* Liens d'échec, parcourus en largeur et fondus dans _next */
+    std::vector<int> fail(_accept.size(), 0);
+    std::vector<int> queue;
+    queue.reserve(_accept.size());
+
+    for (int symbol = 0; symbol < WORD_MATCHER_SYMBOLS; ++symbol)
+    {
+        int &target = _next[symbol];
+        if (target < 0)
+            target = 0;
+        else
+            queue.push_back(target);
+    }
+
+    for (size_t head = 0; head < queue.size(); ++head)
+    {
+        int state = queue[head];
+        for (int symbol = 0; symbol < WORD_MATCHER_SYMBOLS; ++symbol)
+        {
+            int fallback = _next[fail[state] * WORD_MATCHER_SYMBOLS + symbol];
+            int &target = _next[state * WORD_MATCHER_SYMBOLS + symbol];
+            if (target < 0)
+            {
+                target = fallback;
+                continue;
+            }
+            fail[target] = fallback;
+            _accept[target] |= _accept[fallback];
+            queue.push_back(target);
+        }
+    }
+
+    _start = _next[WORD_MATCHER_BOUNDARY];
+}
+
+/**
+ * Scan the bytes once, as if the text were surrounded by boundaries.
+ * Runs of separators count as a single boundary, as in the compiled words.
+ * @return true if one of the words occurs as a whole word
+ */
+bool WordMatcher::matches(const char *data, size_t length) const
+{
+    const int *next = &_next[0];
+    int state = _start;
+    bool boundary = true;
+
+    for (size_t i = 0; i < length; ++i)
+    {
+        unsigned char symbol = _symbols[static_cast<unsigned char>(data[i])];
+        if (symbol == WORD_MATCHER_BOUNDARY)
+        {
+            if (boundary)
+                continue;
+            boundary = true;
+        }
+        else
+            boundary = false;
+
+        state = next[state * WORD_MATCHER_SYMBOLS + symbol];
+        if (_accept[state])
+            return true;
+    }
+
+    if (!boundary)
+        state = next[state * WORD_MATCHER_SYMBOLS + WORD_MATCHER_BOUNDARY];
+    return _accept[state] != 0;
+}
+
+/**
+ * @return the number of words added
+ */
+size_t WordMatcher::size() const
+{
+    return _words.size();
+}
+
+/**
+ * Remove every word
+ */
+void WordMatcher::clear()
+{
+    _words.clear();
+    compile();
+}
+
+/**
+ * Append a state without transitions
+ * @return the number of the new state
+ */
+int WordMatcher::newState()
+{
+    _next.resize(_next.size() + WORD_MATCHER_SYMBOLS, -1);
+    _accept.push_back(0);
+    return static_cast<int>(_accept.size()) - 1;
+}
@@ -3,11 +3,26 @@
 #include <cstdlib>
 #include <cstring>
 #include <cerrno>
+#include <sstream>
 #include "../incs/Server.hpp"
 
 /* Déclaration de l'instance du serveur */
 Server* serverInstance = NULL;
 
+/**
+ * Décrit le placement d'une famille de threads : ses processeurs et les
+ * nœuds NUMA qu'ils couvrent, ou "-" sans option --*-cpus
+ */
+static std::string describePlacement(const CpuTopology &topology, const std::vector<int> &cpus)
+{
+    if (cpus.empty())
+        return "-";
+
+    std::ostringstream out;
+    out << "cpu " << CpuTopology::formatList(cpus) << " (nœud " << CpuTopology::formatList(topology.nodesOf(cpus)) << ")";
+    return out.str();
+}
+
 /* Gestionnaire de signaux */
 void handleSignal(int signal)
 {
@@ -35,12 +50,24 @@ void handleSignal(int signal)
 int main(int argc, char **argv)
 {
     /* Vérification des arguments */
-    if (argc != THREE_ARGMNTS)
+    if (argc < THREE_ARGMNTS)
     {
-        std::cerr << "Usage: ./micro_irc <port> <password>" << std::endl;
+        std::cerr << "Usage: ./ircserv <port> <password> [options]\n" << ServerConfig::usage();
         return EXIT_FAILURE;
     }
 
+    /* Options facultatives après le port et le mot de passe */
+    ServerConfig config;
+    for (int i = THREE_ARGMNTS; i < argc; ++i)
+    {
+        if (!config.parseArgument(argv[i]))
+        {
+            std::cerr << "Option invalide : " << argv[i] << "\n"
+                      << "Usage: ./ircserv <port> <password> [options]\n" << ServerConfig::usage();
+            return EXIT_FAILURE;
+        }
+    }
+
     /* Conversion du port en entier */
     char *endptr;
     long port = std::strtol(argv[PORT_ARG_INDEX], &endptr, 10);
@@ -99,10 +126,18 @@ int main(int argc, char **argv)
         std::cout << "\033[1;33m"; // Set text color to bright yellow
         std::cout << "🔌 Port     : \033[1;37m" << port << "\n";      // White color for values
         std::cout << "\033[1;33m" << "🔑 Password : \033[1;37m" << password << "\n";
+        std::cout << "\033[1;33m" << "🔁 Reactor  : \033[1;37m" << config.reactorBackend << " x " << config.reactors << "\n";
+        CpuTopology topology;
+        std::cout << "\033[1;33m" << "🧭 Topology : \033[1;37m" << topology.onlineCpus() << " CPU, "
+                  << topology.nodeCount() << " nœud(s) NUMA\n";
+        std::cout << "\033[1;33m" << "📌 Affinity : \033[1;37m"
+                  << "boucles: " << describePlacement(topology, config.reactorCpus)
+                  << " | " << (config.pipeline ? "fil d'état: " : "shards: ") << describePlacement(topology, config.shardCpus)
+                  << " | diffusion: " << describePlacement(topology, config.workerCpus) << "\n";
         std::cout << "\033[1;34m"; // Magenta color for separators
         std::cout << "====================================================================================\n";
         std::cout << "\033[0m"; // Reset text color
-        Server server(static_cast<unsigned short>(port), password);
+        Server server(static_cast<unsigned short>(port), password, config);
         serverInstance = &server;
         server.run();
     }